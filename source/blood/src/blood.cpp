@@ -68,6 +68,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "weapon.h"
 #include "gameconfigfile.h"
 #include "gamecontrol.h"
+#include "timedemo.h"
 #include "m_argv.h"
 #include "statistics.h"
 #include "menu/menu.h"
@@ -399,6 +400,9 @@ void PreloadCache(void)
                 gameHandleEvents();
         }
     }
+#ifdef USE_OPENGL
+    FinishHardwareTexturePrecache([](int, int) { gameHandleEvents(); });
+#endif
     memset(gotpic,0,sizeof(gotpic));
 }
 
@@ -1129,7 +1133,12 @@ RESTART:
         goto RESTART;
     }
     UpdateNetworkMenus();
-    if (!gDemo.at0 && gDemo.at59ef > 0 && gGameOptions.nGameType == 0 && !bNoDemo && demo_playloop)
+    if (TimeDemo_Active())
+    {
+        if (!gDemo.SetupPlayback(userConfig.CommandDemo))
+            ThrowError("Unable to play demo %s", userConfig.CommandDemo.GetChars());
+    }
+    else if (!gDemo.at0 && gDemo.at59ef > 0 && gGameOptions.nGameType == 0 && !bNoDemo && demo_playloop)
         gDemo.SetupPlayback(NULL);
     gQuitGame = 0;
     gRestartGame = 0;
@@ -1137,7 +1146,7 @@ RESTART:
     {
         inputState.ClearAllInput();
     }
-    else if (gDemo.at1 && !bAddUserMap && !bNoDemo && demo_playloop)
+    else if (gDemo.at1 && ((!bAddUserMap && !bNoDemo && demo_playloop) || TimeDemo_Active()))
         gDemo.Playback();
     if (gDemo.at59ef > 0)
         M_ClearMenus();
@@ -642,6 +642,8 @@ int dbLoadMap(const char *pPath, int *pX, int *pY, int *pZ, short *pAngle, short
     #ifdef NOONE_EXTENSIONS
     gModernMap = false;
     #endif
+    sectorGridClear();
+    canseeCacheClear();
 
 #ifdef USE_OPENGL
     Polymost_prepare_loadboard();
@@ -1206,6 +1208,8 @@ int dbLoadMap(const char *pPath, int *pX, int *pY, int *pZ, short *pAngle, short
     yax_update((header.version & 0xff00) > 0x700 ? 0 : 1);
 #endif
 
+    sectorGridBuild();
+    canseeCacheBuild();
     g_loadedMapVersion = 7;
 
     return 0;
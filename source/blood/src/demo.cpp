@@ -44,6 +44,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "screen.h"
 #include "view.h"
 #include "gamecontrol.h"
+#include "timedemo.h"
 #include "menu/menu.h"
 
 BEGIN_BLD_NS
@@ -318,6 +319,8 @@ _DEMOPLAYBACK:
     {
         handleevents();
         D_ProcessEvents();
+        if (TimeDemo_Active())
+            totalclock = gNetFifoClock;     // run exactly one tick per frame, regardless of the real time that has passed
         while (totalclock >= gNetFifoClock && !gQuitGame)
         {
             if (!v4)
@@ -364,6 +367,12 @@ _DEMOPLAYBACK:
                 if (v4 >= atf.nInputCount)
                 {
                     ready2send = 0;
+                    if (TimeDemo_Active())
+                    {
+                        TimeDemo_Report(userConfig.CommandDemo);
+                        gQuitGame = true;
+                        break;
+                    }
                     if (at59ef != 1)
                     {
                         v4 = 0;
@@ -382,10 +391,24 @@ _DEMOPLAYBACK:
             }
             gNetFifoClock += 4;
             if (!gQuitGame)
+            {
+                TimeDemo_TickBegin();
                 ProcessFrame();
+                TimeDemo_TickEnd();
+            }
             ready2send = 0;
         }
-        if (G_FPSLimit())
+        if (TimeDemo_Active())
+        {
+            if (TimeDemo_ShouldRender() && !gQuitGame)
+            {
+                TimeDemo_FrameBegin();
+                viewDrawScreen();
+                videoNextPage();
+                TimeDemo_FrameEnd();
+            }
+        }
+        else if (G_FPSLimit())
         {
             viewDrawScreen();
             videoNextPage();
@@ -39,6 +39,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "view.h"
 #include "nnexts.h"
 #include "secrets.h"
+#include "c_dispatch.h"
+#include "stats.h"
+#include "v_text.h"
 
 BEGIN_BLD_NS
 
@@ -67,13 +70,39 @@ public:
 };
 
 EventQueue eventQ;
+
+// Same object as eventQ.PQueue unless in vanilla mode. This is kept out of EventQueue because that gets saved as is.
+static EventPriorityQueue* pIndexedQueue;
+
+static void evCreateQueue(void)
+{
+    if (eventQ.PQueue)
+        delete eventQ.PQueue;
+    if (VanillaMode())
+    {
+        eventQ.PQueue = new VanillaPriorityQueue<EVENT>();
+        pIndexedQueue = nullptr;
+    }
+    else
+        eventQ.PQueue = pIndexedQueue = new EventPriorityQueue();
+    eventQ.PQueue->Clear();
+}
+
 void EventQueue::Kill(int a1, int a2)
 {
-    PQueue->Kill([=](EVENT nItem)->bool {return nItem.index == a1 && nItem.type == a2; });
+    if (pIndexedQueue)
+        pIndexedQueue->Kill(a1, a2);
+    else
+        PQueue->Kill([=](EVENT nItem)->bool {return nItem.index == a1 && nItem.type == a2; });
 }
 
 void EventQueue::Kill(int a1, int a2, CALLBACK_ID a3)
 {
+    if (pIndexedQueue)
+    {
+        pIndexedQueue->Kill(a1, a2, a3);
+        return;
+    }
     EVENT evn = { (unsigned int)a1, (unsigned int)a2, kCmdCallback, (unsigned int)a3 };
     PQueue->Kill([=](EVENT nItem)->bool {return !memcmp(&nItem, &evn, sizeof(EVENT)); });
 }
@@ -265,13 +294,7 @@ unsigned short bucketHead[1024+1];
 
 void evInit(void)
 {
-    if (eventQ.PQueue)
-        delete eventQ.PQueue;
-    if (VanillaMode())
-        eventQ.PQueue = new VanillaPriorityQueue<EVENT>();
-    else
-        eventQ.PQueue = new StdPriorityQueue<EVENT>();
-    eventQ.PQueue->Clear();
+    evCreateQueue();
     int nCount = 0;
     for (int i = 0; i < numsectors; i++)
     {
@@ -568,10 +591,8 @@ void EventQLoadSave::Load()
     if (eventQ.PQueue)
         delete eventQ.PQueue;
     Read(&eventQ, sizeof(eventQ));
-    if (VanillaMode())
-        eventQ.PQueue = new VanillaPriorityQueue<EVENT>();
-    else
-        eventQ.PQueue = new StdPriorityQueue<EVENT>();
+    eventQ.PQueue = nullptr;
+    evCreateQueue();
     int nEvents;
     Read(&nEvents, sizeof(nEvents));
     for (int i = 0; i < nEvents; i++)
@@ -611,6 +632,91 @@ void EventQLoadSave::Save()
 
 static EventQLoadSave *myLoadSave;
 
+//---------------------------------------------------------------------------
+//
+// Compares evKill through the hash index with the linear search
+// on a queue filled with random events.
+//
+//---------------------------------------------------------------------------
+
+CCMD(bench_eventqueue)
+{
+    int const nEvents = argv.argc() > 1 ? max(1, (int)strtol(argv[1], nullptr, 10)) : 4096;
+    int const nKills = argv.argc() > 2 ? max(1, (int)strtol(argv[2], nullptr, 10)) : 100000;
+
+    EventPriorityQueue indexed, linear;
+    indexed.Clear();
+    linear.Clear();
+
+    uint32_t seed = 1;
+    auto random = [&](int range) { seed = seed * 1664525 + 1013904223; return int((uint64_t)(seed >> 8) * range >> 24); };
+    auto randomEvent = [&]()
+    {
+        EVENT evn = {};
+        evn.index = random(512);
+        evn.type = random(4);
+        evn.cmd = random(4) ? random(kCmdCallback) : kCmdCallback;
+        evn.funcID = random(kCallbackMax);
+        return evn;
+    };
+
+    for (int i = 0; i < nEvents; i++)
+    {
+        EVENT evn = randomEvent();
+        uint32_t const nTime = random(1000);
+        indexed.Insert(nTime, evn);
+        linear.Insert(nTime, evn);
+    }
+
+    // Every kill gets followed by an insertion to keep the queue at its size.
+    TArray<EVENT> kills(nKills, true), refills(nKills, true);
+    TArray<uint32_t> times(nKills, true);
+    for (int i = 0; i < nKills; i++)
+    {
+        kills[i] = randomEvent();
+        refills[i] = randomEvent();
+        times[i] = random(1000);
+    }
+
+    cycle_t indexclock, linearclock;
+    indexclock.Reset();
+    indexclock.Clock();
+    for (int i = 0; i < nKills; i++)
+    {
+        if (kills[i].cmd == kCmdCallback) indexed.Kill(kills[i].index, kills[i].type, kills[i].funcID);
+        else indexed.Kill(kills[i].index, kills[i].type);
+        indexed.Insert(times[i], refills[i]);
+    }
+    indexclock.Unclock();
+
+    linearclock.Reset();
+    linearclock.Clock();
+    for (int i = 0; i < nKills; i++)
+    {
+        EVENT const evk = kills[i];
+        if (evk.cmd == kCmdCallback)
+            linear.Kill([=](EVENT nItem)->bool { return nItem.index == evk.index && nItem.type == evk.type && nItem.cmd == kCmdCallback && nItem.funcID == evk.funcID; });
+        else
+            linear.Kill([=](EVENT nItem)->bool { return nItem.index == evk.index && nItem.type == evk.type; });
+        linear.Insert(times[i], refills[i]);
+    }
+    linearclock.Unclock();
+
+    int nMismatches = indexed.Size() != linear.Size();
+    while (indexed.Size() > 0 && linear.Size() > 0)
+    {
+        uint32_t const nTime1 = indexed.LowestPriority(), nTime2 = linear.LowestPriority();
+        EVENT const evn1 = indexed.Remove(), evn2 = linear.Remove();
+        nMismatches += nTime1 != nTime2 || memcmp(&evn1, &evn2, sizeof(EVENT)) != 0;
+    }
+
+    double const indextime = max(indexclock.TimeMS(), 0.001), lineartime = max(linearclock.TimeMS(), 0.001);
+    Printf("%d events, %d kills\n", nEvents, nKills);
+    Printf("linear search: %.2f ms, %.0f kills/s\n", lineartime, nKills * 1000. / lineartime);
+    Printf("hash index: %.2f ms, %.0f kills/s\n", indextime, nKills * 1000. / indextime);
+    if (nMismatches) Printf(TEXTCOLOR_RED "%d events differ from the linear search!\n", nMismatches);
+}
+
 void EventQLoadSaveConstruct(void)
 {
     myLoadSave = new EventQLoadSave();
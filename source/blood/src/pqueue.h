@@ -21,9 +21,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 */
 //-------------------------------------------------------------------------
 #pragma once
-#include <set>
+#include <algorithm>
 #include <functional>
 #include "common_game.h"
+#include "eventq.h"
 
 BEGIN_BLD_NS
 
@@ -148,43 +149,216 @@ public:
     }
 };
 
-template<typename T> class StdPriorityQueue : public PriorityQueue<T>
+// Binary heap ordered by priority and then by insertion order, so items of
+// equal priority come out first in, first out. Every item is also linked
+// into a hash index by its (index, type) key and, for callbacks, by its
+// (index, type, callback) key, so evKill only visits the events it removes.
+class EventPriorityQueue : public PriorityQueue<EVENT>
 {
-public:
-    std::multiset<queueItem<T>> stdQueue;
-    ~StdPriorityQueue()
+    enum : uint32_t { kNone = ~0u };
+
+    struct HeapNode
+    {
+        uint32_t nPriority;
+        uint32_t nSequence;
+        uint32_t nSlot;
+
+        bool operator<(const HeapNode& other) const
+        {
+            return nPriority < other.nPriority || (nPriority == other.nPriority && nSequence < other.nSequence);
+        }
+    };
+
+    struct Slot
+    {
+        EVENT data;
+        uint32_t nHeapPos;
+        uint32_t nKey[2];
+        uint32_t nPrev[2];
+        uint32_t nNext[2];
+    };
+
+    TArray<HeapNode> heap;
+    TArray<Slot> slots;
+    TArray<uint32_t> freeSlots;
+    TMap<uint32_t, uint32_t> chainHeads[2]; // 0: (index, type), 1: (index, type, callback)
+    uint32_t nNextSequence = 0;
+
+    static uint32_t TypeKey(int nIndex, int nType)
+    {
+        return uint32_t(nIndex) | (uint32_t(nType) << 14);
+    }
+    static uint32_t CallbackKey(int nIndex, int nType, int nCallback)
+    {
+        return TypeKey(nIndex, nType) | (uint32_t(nCallback) << 17);
+    }
+
+    void Link(uint32_t nSlot, int nChain)
+    {
+        Slot& slot = slots[nSlot];
+        uint32_t* pHead = chainHeads[nChain].CheckKey(slot.nKey[nChain]);
+        slot.nPrev[nChain] = kNone;
+        slot.nNext[nChain] = pHead ? *pHead : kNone;
+        if (pHead)
+        {
+            slots[*pHead].nPrev[nChain] = nSlot;
+            *pHead = nSlot;
+        }
+        else
+            chainHeads[nChain].Insert(slot.nKey[nChain], nSlot);
+    }
+    void Unlink(uint32_t nSlot, int nChain)
+    {
+        Slot& slot = slots[nSlot];
+        if (slot.nNext[nChain] != kNone)
+            slots[slot.nNext[nChain]].nPrev[nChain] = slot.nPrev[nChain];
+        if (slot.nPrev[nChain] != kNone)
+            slots[slot.nPrev[nChain]].nNext[nChain] = slot.nNext[nChain];
+        else if (slot.nNext[nChain] != kNone)
+            chainHeads[nChain][slot.nKey[nChain]] = slot.nNext[nChain];
+        else
+            chainHeads[nChain].Remove(slot.nKey[nChain]);
+    }
+
+    void Place(uint32_t nPos, const HeapNode& node)
+    {
+        heap[nPos] = node;
+        slots[node.nSlot].nHeapPos = nPos;
+    }
+    void Upheap(uint32_t nPos)
+    {
+        HeapNode node = heap[nPos];
+        while (nPos > 0 && node < heap[(nPos - 1) >> 1])
+        {
+            Place(nPos, heap[(nPos - 1) >> 1]);
+            nPos = (nPos - 1) >> 1;
+        }
+        Place(nPos, node);
+    }
+    void Downheap(uint32_t nPos)
+    {
+        HeapNode node = heap[nPos];
+        uint32_t const nCount = heap.Size();
+        for (;;)
+        {
+            uint32_t t = nPos * 2 + 1;
+            if (t >= nCount)
+                break;
+            if (t + 1 < nCount && heap[t + 1] < heap[t])
+                t++;
+            if (!(heap[t] < node))
+                break;
+            Place(nPos, heap[t]);
+            nPos = t;
+        }
+        Place(nPos, node);
+    }
+    void Delete(uint32_t nPos)
+    {
+        uint32_t const nSlot = heap[nPos].nSlot;
+        Unlink(nSlot, 0);
+        if (slots[nSlot].nKey[1] != kNone)
+            Unlink(nSlot, 1);
+        freeSlots.Push(nSlot);
+
+        HeapNode last;
+        heap.Pop(last);
+        if (nPos < heap.Size())
+        {
+            Place(nPos, last);
+            if (nPos > 0 && last < heap[(nPos - 1) >> 1])
+                Upheap(nPos);
+            else
+                Downheap(nPos);
+        }
+    }
+    void KillChain(int nChain, uint32_t nKey)
+    {
+        uint32_t* pHead = chainHeads[nChain].CheckKey(nKey);
+        if (pHead == nullptr)
+            return;
+        for (uint32_t nSlot = *pHead; nSlot != kNone;)
+        {
+            uint32_t const nNext = slots[nSlot].nNext[nChain];
+            Delete(slots[nSlot].nHeapPos);
+            nSlot = nNext;
+        }
+    }
+    // Hands out fresh sequence numbers in heap order once the counter runs out.
+    // A sorted array is a valid heap, so nothing else needs to be rebuilt.
+    void Renumber(void)
     {
-        stdQueue.clear();
+        std::sort(heap.begin(), heap.end());
+        for (uint32_t i = 0; i < heap.Size(); i++)
+        {
+            heap[i].nSequence = i;
+            slots[heap[i].nSlot].nHeapPos = i;
+        }
+        nNextSequence = heap.Size();
     }
-    uint32_t Size(void) { return stdQueue.size(); };
+
+public:
+    uint32_t Size(void) { return heap.Size(); }
     void Clear(void)
     {
-        stdQueue.clear();
+        heap.Clear();
+        slots.Clear();
+        freeSlots.Clear();
+        chainHeads[0].Clear();
+        chainHeads[1].Clear();
+        nNextSequence = 0;
     }
-    void Insert(uint32_t nPriority, T data)
+    void Insert(uint32_t nPriority, EVENT data)
     {
-        stdQueue.insert({ nPriority, data });
+        if (nNextSequence == kNone)
+            Renumber();
+
+        uint32_t nSlot;
+        if (!freeSlots.Pop(nSlot))
+            nSlot = slots.Reserve(1);
+
+        Slot& slot = slots[nSlot];
+        slot.data = data;
+        slot.nKey[0] = TypeKey(data.index, data.type);
+        slot.nKey[1] = data.cmd == kCmdCallback ? CallbackKey(data.index, data.type, data.funcID) : kNone;
+        Link(nSlot, 0);
+        if (slot.nKey[1] != kNone)
+            Link(nSlot, 1);
+
+        heap.Push({ nPriority, nNextSequence++, nSlot });
+        Upheap(heap.Size() - 1);
     }
-    T Remove(void)
+    EVENT Remove(void)
     {
-        dassert(stdQueue.size() > 0);
-        T data = stdQueue.begin()->at4;
-        stdQueue.erase(stdQueue.begin());
+        dassert(heap.Size() > 0);
+        EVENT data = slots[heap[0].nSlot].data;
+        Delete(0);
         return data;
     }
     uint32_t LowestPriority(void)
     {
-        return stdQueue.begin()->at0;
+        dassert(heap.Size() > 0);
+        return heap[0].nPriority;
     }
-    void Kill(std::function<bool(T)> pMatch)
+    void Kill(std::function<bool(EVENT)> pMatch)
     {
-        for (auto i = stdQueue.begin(); i != stdQueue.end();)
+        // Deleting reorders the heap, so collect the matches before removing anything.
+        TArray<uint32_t> matches;
+        for (auto& node : heap)
         {
-            if (pMatch(i->at4))
-                i = stdQueue.erase(i);
-            else
-                i++;
+            if (pMatch(slots[node.nSlot].data))
+                matches.Push(node.nSlot);
         }
+        for (auto nSlot : matches)
+            Delete(slots[nSlot].nHeapPos);
+    }
+    void Kill(int nIndex, int nType)
+    {
+        KillChain(0, TypeKey(nIndex, nType));
+    }
+    void Kill(int nIndex, int nType, int nCallback)
+    {
+        KillChain(1, CallbackKey(nIndex, nType, nCallback));
     }
 };
 
@@ -832,6 +832,7 @@ void DragPoint(int nWall, int x, int y)
     viewInterpolateWall(nWall, &wall[nWall]);
     wall[nWall].x = x;
     wall[nWall].y = y;
+    sectorGridInvalidate(sectorofwall(nWall));
 
     int vsi = numwalls;
     int vb = nWall;
@@ -843,6 +844,7 @@ void DragPoint(int nWall, int x, int y)
             viewInterpolateWall(vb, &wall[vb]);
             wall[vb].x = x;
             wall[vb].y = y;
+            sectorGridInvalidate(sectorofwall(vb));
         }
         else
         {
@@ -855,6 +857,7 @@ void DragPoint(int nWall, int x, int y)
                     viewInterpolateWall(vb, &wall[vb]);
                     wall[vb].x = x;
                     wall[vb].y = y;
+                    sectorGridInvalidate(sectorofwall(vb));
                 }
                 else
                     break;
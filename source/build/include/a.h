@@ -11,6 +11,11 @@
 #define CLASSIC_SLICE_BY_4
 #define A_C_RESTRICT __restrict
 
+// Runtime selected AVX2 versions of some span functions, see a-c_avx2.cpp.
+#if defined __x86_64__ || defined _M_X64
+# define A_C_USE_AVX2
+#endif
+
 #define CLASSIC_NONPOW2_YSIZE_SPRITES
 #ifdef LUNATIC
 # define CLASSIC_NONPOW2_YSIZE_WALLS
@@ -53,6 +58,7 @@ void slopevlin(intptr_t p, int32_t i, intptr_t slopaloffs, bssize_t cnt, int32_t
 void setupvlineasm(int32_t neglogy);
 int32_t vlineasm1(int32_t vinc, intptr_t paloffs, bssize_t cnt, uint32_t vplc, intptr_t bufplc, intptr_t p);
 void vlineasm4(bssize_t cnt, char *p);
+void vlineasm4ex(bssize_t cnt, char *p, const intptr_t *paloffs, const intptr_t *bufplc, uint32_t *vplcio, const int32_t *vincin);
 
 void setupmvlineasm(int32_t neglogy, int32_t dosaturate);
 int32_t mvlineasm1(int32_t vinc, intptr_t paloffs, bssize_t cnt, uint32_t vplc, intptr_t bufplc, intptr_t p);
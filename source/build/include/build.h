@@ -849,6 +849,7 @@ inline void   renderFlushPerms(void) {}
 
 void   plotpixel(int32_t x, int32_t y, char col);
 void   renderSetTarget(int16_t tilenume, int32_t xsiz, int32_t ysiz);
+bool   renderSetCameraTarget(int16_t tilenume, int32_t xsiz, int32_t ysiz);
 void   renderRestoreTarget(void);
 void   renderPrepareMirror(int32_t dax, int32_t day, int32_t daz, fix16_t daang, fix16_t dahoriz, int16_t dawall,
                            int32_t *tposx, int32_t *tposy, fix16_t *tang);
@@ -925,6 +926,19 @@ void updatesectorz(int32_t const x, int32_t const y, int32_t const z, int16_t *
 void updatesectorneighbor(int32_t const x, int32_t const y, int16_t * const sectnum, int32_t initialMaxDistance = INITIALUPDATESECTORDIST, int32_t maxDistance = MAXUPDATESECTORDIST) ATTRIBUTE((nonnull(3)));
 void updatesectorneighborz(int32_t const x, int32_t const y, int32_t const z, int16_t * const sectnum, int32_t initialMaxDistance = INITIALUPDATESECTORDIST, int32_t maxDistance = MAXUPDATESECTORDIST) ATTRIBUTE((nonnull(4)));
 
+// Spatial index over the sector bounding boxes used by the functions above.
+// Code that moves walls without going through dragpoint must call sectorGridInvalidate for the affected sectors.
+void sectorGridBuild(void);
+void sectorGridClear(void);
+void sectorGridInvalidate(int sectnum);
+const TArray<int16_t> *sectorGridLookup(int32_t x, int32_t y);
+
+// Sector connectivity used by cansee to reject unconnected sectors. Needs to be rebuilt together with the sector grid.
+// Code that changes a wall's nextsector at runtime must call canseeCacheInvalidate.
+void canseeCacheBuild(void);
+void canseeCacheClear(void);
+void canseeCacheInvalidate(void);
+
 int findwallbetweensectors(int sect1, int sect2);
 static FORCE_INLINE int sectoradjacent(int sect1, int sect2) { return findwallbetweensectors(sect1, sect2) != -1; }
 int32_t getsectordist(vec2_t const in, int const sectnum, vec2_t * const out = nullptr);
@@ -1090,6 +1104,7 @@ void tileInvalidate(int16_t tilenume, int32_t pal, int32_t how);
 
 void polymost_glreset(void);
 void PrecacheHardwareTextures(int nTile);
+void FinishHardwareTexturePrecache(void (*progress)(int done, int total) = nullptr);
 void Polymost_Startup();
 
 typedef uint16_t polytintflags_t;
@@ -1120,6 +1135,7 @@ EXTERN_CVAR(Int, hw_texfilter)
 extern bool hw_int_useindexedcolortextures;
 EXTERN_CVAR(Bool, hw_useindexedcolortextures)
 EXTERN_CVAR(Bool, hw_parallaxskypanning)
+EXTERN_CVAR(Bool, hw_cameratextures)
 EXTERN_CVAR(Bool, r_voxels)
 
 extern int32_t r_downsize;
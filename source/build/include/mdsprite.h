@@ -131,6 +131,7 @@ typedef struct
     md3uv_t *uv;
     md3xyzn_t *xyzn;
     float *geometry;  // used by Polymer
+    uint32_t vbindex; // first frame in the static vertex buffer
 } md3surf_t;
 
 #define SIZEOF_MD3SURF_T (11*sizeof(int32_t) + 64*sizeof(char))
@@ -166,6 +167,7 @@ struct md3model_t : public idmodel_t
     uint16_t *vindexes;
 
     float *maxdepths;
+    uint32_t vbserial; // the frames are in the static vertex buffer if this matches its serial
     // polymer VBO names after that, allocated per surface
 	/*
     GLuint *indices;
@@ -194,6 +196,7 @@ struct voxmodel_t : public mdmodel_t
     vec3f_t piv;
     int32_t is8bit;
     TMap<int, FHardwareTexture*> *texIds;
+    uint32_t vbindex, vbserial;     // location of the vertices in the static part of the vertex buffer, if vbserial matches.
 };
 
 EXTERN mdmodel_t **models;
@@ -210,6 +213,7 @@ EXTERN voxmodel_t *voxmodels[MAXVOXELS];
 
 void voxfree(voxmodel_t *m);
 voxmodel_t *voxload(const char *filnam);
+void voxloadmultiple(const char *const *filenames, voxmodel_t **models, int32_t count);
 voxmodel_t *loadkvxfrombuf(const char *buffer, int32_t length);
 int32_t polymost_voxdraw(voxmodel_t *m, tspriteptr_t const tspr);
 
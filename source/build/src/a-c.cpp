@@ -12,6 +12,10 @@
 
 #include "a.h"
 #include "pragmas.h"
+#include "c_dispatch.h"
+#include "printf.h"
+#include "stats.h"
+#include "v_text.h"
 
 #ifdef ENGINE_USING_A_C
 
@@ -48,6 +52,16 @@ static int32_t gbxinc, gbyinc;
 static char *gpal, *ghlinepal, *gtrans;
 static char *gpal2;
 
+#ifdef A_C_USE_AVX2
+bool a_c_cpuhasavx2(void);
+bssize_t hlineasm4_avx2(bssize_t cnt, const char *buf, const char *pal, uint32_t *bx, uint32_t *by,
+                        int32_t incx, int32_t incy, int32_t logx, int32_t logy, char **p);
+int32_t mhline_avx2(int32_t cnt, const char *buf, const char *pal, uint32_t *bx, uint32_t *by,
+                    int32_t incx, int32_t incy, int32_t logx, int32_t logy, char **p);
+
+static bool a_c_useavx2 = a_c_cpuhasavx2();
+#endif
+
 //Global variable functions
 void setvlinebpl(int32_t dabpl) { A64_ASSIGN(a64_bpl, dabpl); bpl = dabpl;}
 void fixtransluscence(intptr_t datransoff)
@@ -78,6 +92,12 @@ void hlineasm4(bssize_t cnt, int32_t skiploadincs, int32_t paloffs, uint32_t by,
     const vec2_t log32 = { 32-log.x, 32-log.y };
     char *pp = (char *)p;
 
+#ifdef A_C_USE_AVX2
+    // A shift by 32 is undefined for the C version, so leave these to it.
+    if (a_c_useavx2 && log.x && log.y)
+        cnt = hlineasm4_avx2(cnt, buf, palptr, &bx, &by, inc.x, inc.y, log.x, log.y, &pp);
+#endif
+
 #ifdef CLASSIC_SLICE_BY_4
     for (; cnt>=4; cnt-=4, pp-=4)
     {
@@ -232,9 +252,9 @@ typedef uint32_t uint32_vec4 __attribute__ ((vector_size (16)));
 // cnt >= 1
 static void vlineasm4nlogy(bssize_t cnt, char *p, char *const A_C_RESTRICT * pal, char *const A_C_RESTRICT * buf,
 # ifdef USE_VECTOR_EXT
-    uint32_vec4 vplc, const uint32_vec4 vinc)
+    uint32_vec4 vplc, const uint32_vec4 vinc, uint32_t *vplcout)
 # else
-    uint32_t * vplc, const int32_t *vinc)
+    uint32_t * vplc, const int32_t *vinc, uint32_t *vplcout)
 # endif
 {
     const int32_t ourbpl = bpl;
@@ -257,21 +277,23 @@ static void vlineasm4nlogy(bssize_t cnt, char *p, char *const A_C_RESTRICT * pal
         p += ourbpl;
     } while (--cnt);
 
-    Bmemcpy(&vplce[0], &vplc[0], sizeof(uint32_t) * 4);
+    Bmemcpy(&vplcout[0], &vplc[0], sizeof(uint32_t) * 4);
 }
 #endif
 
 // cnt >= 1
-void vlineasm4(bssize_t cnt, char *p)
+// Same as vlineasm4 but with the column state passed in instead of using the
+// global arrays so that multiple threads can draw at the same time.
+void vlineasm4ex(bssize_t cnt, char *p, const intptr_t *paloffs, const intptr_t *bufplc, uint32_t *vplcio, const int32_t *vincin)
 {
-    char * const A_C_RESTRICT pal[4] = {(char *)palookupoffse[0], (char *)palookupoffse[1], (char *)palookupoffse[2], (char *)palookupoffse[3]};
-    char * const A_C_RESTRICT buf[4] = {(char *)bufplce[0], (char *)bufplce[1], (char *)bufplce[2], (char *)bufplce[3]};
+    char * const A_C_RESTRICT pal[4] = {(char *)paloffs[0], (char *)paloffs[1], (char *)paloffs[2], (char *)paloffs[3]};
+    char * const A_C_RESTRICT buf[4] = {(char *)bufplc[0], (char *)bufplc[1], (char *)bufplc[2], (char *)bufplc[3]};
 #ifdef USE_VECTOR_EXT
-    uint32_vec4 vinc = {(uint32_t)vince[0], (uint32_t)vince[1], (uint32_t)vince[2], (uint32_t)vince[3]};
-    uint32_vec4 vplc = {vplce[0], vplce[1], vplce[2], vplce[3]};
+    uint32_vec4 vinc = {(uint32_t)vincin[0], (uint32_t)vincin[1], (uint32_t)vincin[2], (uint32_t)vincin[3]};
+    uint32_vec4 vplc = {vplcio[0], vplcio[1], vplcio[2], vplcio[3]};
 #else
-    const int32_t vinc[4] = {vince[0], vince[1], vince[2], vince[3]};
-    uint32_t vplc[4] = {vplce[0], vplce[1], vplce[2], vplce[3]};
+    const int32_t vinc[4] = {vincin[0], vincin[1], vincin[2], vincin[3]};
+    uint32_t vplc[4] = {vplcio[0], vplcio[1], vplcio[2], vplcio[3]};
 #endif
     const int32_t logy = glogy, ourbpl = bpl;
 
@@ -279,7 +301,7 @@ void vlineasm4(bssize_t cnt, char *p)
     if (EDUKE32_PREDICT_FALSE(!logy))
     {
         // This should only happen when 'globalshiftval = 0' has been set in engine.c.
-        vlineasm4nlogy(cnt, p, pal, buf, vplc, vinc);
+        vlineasm4nlogy(cnt, p, pal, buf, vplc, vinc, vplcio);
         return;
     }
 #else
@@ -337,7 +359,12 @@ void vlineasm4(bssize_t cnt, char *p)
         p += ourbpl;
     }
 
-    Bmemcpy(&vplce[0], &vplc[0], sizeof(uint32_t) * 4);
+    Bmemcpy(&vplcio[0], &vplc[0], sizeof(uint32_t) * 4);
+}
+
+void vlineasm4(bssize_t cnt, char *p)
+{
+    vlineasm4ex(cnt, p, palookupoffse, bufplce, vplce, vince);
 }
 
 #ifdef USE_SATURATE_VPLC
@@ -580,6 +607,17 @@ void mhline(intptr_t bufplc, uint32_t bx, int32_t cntup16, int32_t junk, uint32_
 
     cntup16>>=16;
     cntup16++;
+
+#ifdef A_C_USE_AVX2
+    if (a_c_useavx2 && glogx && glogy)
+    {
+        char *pp = (char *)p;
+        cntup16 = mhline_avx2(cntup16, gbuf, gpal, &bx, &by, xinc, yinc, glogx, glogy, &pp);
+        p = (intptr_t)pp;
+        if (cntup16 == 0) return;
+    }
+#endif
+
     do
     {
         ch = gbuf[((bx>>(32-glogx))<<glogy)+(by>>(32-glogy))];
@@ -708,6 +746,94 @@ void drawslab(int32_t dx, int32_t v, int32_t dy, int32_t vi, intptr_t vptr, intp
     while (--dy);
 }
 
+#ifdef A_C_USE_AVX2
+//
+// Checks that the AVX2 span functions produce the same output as the C
+// versions and compares their speed.
+//
+CCMD(test_drawkernels)
+{
+    if (!a_c_cpuhasavx2())
+    {
+        Printf("This CPU does not support AVX2\n");
+        return;
+    }
+
+    int const count = argv.argc() > 1 ? max(1, (int)strtol(argv[1], nullptr, 10)) : 20000;
+
+    // The palookup tables have a spare shade at the end, so does this one.
+    TArray<char> pal(512, true), tex(256 * 256, true);
+    TArray<char> scalardest(1024, true), simddest(1024, true);
+
+    uint32_t seed = 1;
+    auto rnd = [&]() { seed = seed * 1664525 + 1013904223; return seed; };
+
+    for (auto &c : pal) c = (char)(rnd() >> 24);
+    for (auto &c : tex) c = (char)(rnd() >> 24);
+    for (int i = 0; i < 256 * 256; i += 7) tex[i] = (char)255;  // some transparent pixels for mhline
+
+    bool const saveuseavx2 = a_c_useavx2;
+    intptr_t const saveasm[3] = { asm1, asm2, asm3 };
+    cycle_t clocks[2][2];
+    int mismatches[2] = {};
+
+    for (auto &c : clocks) c[0].Reset(), c[1].Reset();
+
+    for (int n = 0; n < count; n++)
+    {
+        int32_t const logx = 1 + rnd() % 8, logy = 1 + rnd() % 8;
+        int32_t const len = rnd() % 1000;
+        uint32_t const bx = rnd(), by = rnd();
+        int32_t const incx = rnd() >> (rnd() % 32), incy = rnd() >> (rnd() % 32);
+        uint32_t const destseed = rnd();
+
+        for (int kernel = 0; kernel < 2; kernel++)
+        {
+            for (int simd = 0; simd < 2; simd++)
+            {
+                auto &dest = simd ? simddest : scalardest;
+                seed = destseed;
+                for (auto &c : dest) c = (char)(rnd() >> 24);
+                a_c_useavx2 = !!simd;
+
+                clocks[kernel][simd].Clock();
+                if (kernel == 0)
+                {
+                    // hlineasm4 draws from right to left.
+                    sethlinesizes(logx, logy, (intptr_t)tex.Data());
+                    setpalookupaddress(pal.Data());
+                    setuphlineasm4(incx, incy);
+                    hlineasm4(len, 1, 0, by, bx, (intptr_t)&dest[len + 8]);
+                }
+                else
+                {
+                    msethlineshift(logx, logy);
+                    asm1 = incx;
+                    asm2 = incy;
+                    asm3 = (intptr_t)pal.Data();
+                    mhline((intptr_t)tex.Data(), bx, len << 16, 0, by, (intptr_t)&dest[8]);
+                }
+                clocks[kernel][simd].Unclock();
+            }
+            mismatches[kernel] += memcmp(scalardest.Data(), simddest.Data(), scalardest.Size()) != 0;
+        }
+    }
+
+    a_c_useavx2 = saveuseavx2;
+    asm1 = saveasm[0];
+    asm2 = saveasm[1];
+    asm3 = saveasm[2];
+
+    static const char *const names[] = { "hlineasm4", "mhline" };
+    for (int i = 0; i < 2; i++)
+    {
+        Printf("%s: C %.2f ms, AVX2 %.2f ms", names[i], clocks[i][0].TimeMS(), clocks[i][1].TimeMS());
+        if (mismatches[i]) Printf(TEXTCOLOR_RED " - %d of %d spans differ!\n", mismatches[i], count);
+        else Printf(" - all %d spans identical\n", count);
+    }
+}
+#endif
+
 #if 0
 void stretchhline(intptr_t p0, int32_t u, bssize_t cnt, int32_t uinc, intptr_t rptr, intptr_t p)
 {
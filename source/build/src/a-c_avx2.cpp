@@ -0,0 +1,153 @@
+// AVX2 versions of some of the span functions in a-c.cpp.
+//
+// These are selected at startup if the CPU supports them and must produce
+// exactly the same output as the C versions, otherwise demos would render
+// differently. Use the 'test_drawkernels' console command after changing
+// anything here.
+//
+// Only the palookup lookups use hardware gathers, see palookup8 for how
+// they stay inside the shade row. No such trick works for the tile data,
+// so texels are still fetched one by one.
+
+#include "a.h"
+
+#ifdef A_C_USE_AVX2
+
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+# include <intrin.h>
+# define A_C_TARGET_AVX2
+#else
+# define A_C_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+bool a_c_cpuhasavx2(void)
+{
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7) return false;
+
+    __cpuid(regs, 1);
+    // The OS must save the YMM registers on context switches.
+    if (!(regs[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6) return false;
+
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+// Computes ((x>>(32-logx))<<logy)+(y>>(32-logy)) for 8 texture coordinates.
+static A_C_TARGET_AVX2 inline __m256i texindex8(__m256i x, __m256i y, __m128i shx, __m128i shxy, __m128i shy)
+{
+    return _mm256_add_epi32(_mm256_sll_epi32(_mm256_srl_epi32(x, shx), shxy), _mm256_srl_epi32(y, shy));
+}
+
+static A_C_TARGET_AVX2 inline __m256i fetchtexels8(const char *buf, __m256i index)
+{
+    alignas(32) uint32_t idx[8];
+    _mm256_store_si256((__m256i *)idx, index);
+
+    auto const ubuf = (const uint8_t *)buf;
+    return _mm256_setr_epi32(ubuf[idx[0]], ubuf[idx[1]], ubuf[idx[2]], ubuf[idx[3]],
+                             ubuf[idx[4]], ubuf[idx[5]], ubuf[idx[6]], ubuf[idx[7]]);
+}
+
+// pal is the start of a 256 byte shade row and texels are 0-255. Each dword is gathered
+// from the 4 byte aligned offset containing the texel, so the gather never reads past the
+// end of the row. This must not rely on any padding after the table, because Blood points
+// palookup directly at its PLU lumps, which may end at the last page of a mapped file.
+static A_C_TARGET_AVX2 inline __m256i palookup8(const char *pal, __m256i texels)
+{
+    __m256i const aligned = _mm256_andnot_si256(_mm256_set1_epi32(3), texels);
+    __m256i const shift = _mm256_slli_epi32(_mm256_and_si256(texels, _mm256_set1_epi32(3)), 3);
+    __m256i const dwords = _mm256_i32gather_epi32((const int *)pal, aligned, 1);
+    return _mm256_and_si256(_mm256_srlv_epi32(dwords, shift), _mm256_set1_epi32(0xff));
+}
+
+// Stores the low byte of each lane as 8 consecutive pixels.
+static A_C_TARGET_AVX2 inline void store8(char *p, __m256i pixels)
+{
+    __m256i const packed = _mm256_packus_epi16(_mm256_packus_epi32(pixels, pixels), _mm256_setzero_si256());
+    uint32_t const lo = (uint32_t)_mm256_extract_epi32(packed, 0), hi = (uint32_t)_mm256_extract_epi32(packed, 4);
+    memcpy(p, &lo, 4);
+    memcpy(p + 4, &hi, 4);
+}
+
+//
+// hlineasm4: draws pixels from p leftwards. Returns the number of pixels
+// that are left for the C version.
+//
+A_C_TARGET_AVX2 bssize_t hlineasm4_avx2(bssize_t cnt, const char *buf, const char *pal, uint32_t *bx, uint32_t *by,
+                                        int32_t incx, int32_t incy, int32_t logx, int32_t logy, char **p)
+{
+    __m128i const shx = _mm_cvtsi32_si128(32-logx), shxy = _mm_cvtsi32_si128(logy), shy = _mm_cvtsi32_si128(32-logy);
+
+    // Lane j is the pixel 7-j positions to the left of the current one.
+    __m256i const steps = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    __m256i const offx = _mm256_mullo_epi32(steps, _mm256_set1_epi32(incx));
+    __m256i const offy = _mm256_mullo_epi32(steps, _mm256_set1_epi32(incy));
+
+    uint32_t x = *bx, y = *by;
+    char *pp = *p;
+
+    for (; cnt >= 8; cnt -= 8, pp -= 8)
+    {
+        __m256i const vx = _mm256_sub_epi32(_mm256_set1_epi32(x), offx);
+        __m256i const vy = _mm256_sub_epi32(_mm256_set1_epi32(y), offy);
+
+        store8(pp - 7, palookup8(pal, fetchtexels8(buf, texindex8(vx, vy, shx, shxy, shy))));
+
+        x -= (uint32_t)incx << 3;
+        y -= (uint32_t)incy << 3;
+    }
+
+    *bx = x; *by = y; *p = pp;
+    return cnt;
+}
+
+//
+// mhline: draws pixels from p rightwards, skipping the transparent color 255.
+// Returns the number of pixels that are left for the C version.
+//
+A_C_TARGET_AVX2 int32_t mhline_avx2(int32_t cnt, const char *buf, const char *pal, uint32_t *bx, uint32_t *by,
+                                    int32_t incx, int32_t incy, int32_t logx, int32_t logy, char **p)
+{
+    __m128i const shx = _mm_cvtsi32_si128(32-logx), shxy = _mm_cvtsi32_si128(logy), shy = _mm_cvtsi32_si128(32-logy);
+
+    __m256i const steps = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i const offx = _mm256_mullo_epi32(steps, _mm256_set1_epi32(incx));
+    __m256i const offy = _mm256_mullo_epi32(steps, _mm256_set1_epi32(incy));
+    __m256i const transparent = _mm256_set1_epi32(255);
+
+    uint32_t x = *bx, y = *by;
+    char *pp = *p;
+
+    for (; cnt >= 8; cnt -= 8, pp += 8)
+    {
+        __m256i const vx = _mm256_add_epi32(_mm256_set1_epi32(x), offx);
+        __m256i const vy = _mm256_add_epi32(_mm256_set1_epi32(y), offy);
+
+        __m256i const texels = fetchtexels8(buf, texindex8(vx, vy, shx, shxy, shy));
+        __m256i const mask = _mm256_cmpeq_epi32(texels, transparent);
+
+        if (_mm256_movemask_epi8(mask) != -1)
+        {
+            __m256i const dest = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)pp));
+            // Not _mm256_blendv_epi8: some GCC versions miscompile it with -funsigned-char.
+            store8(pp, _mm256_or_si256(_mm256_and_si256(mask, dest), _mm256_andnot_si256(mask, palookup8(pal, texels))));
+        }
+
+        x += (uint32_t)incx << 3;
+        y += (uint32_t)incy << 3;
+    }
+
+    *bx = x; *by = y; *p = pp;
+    return cnt;
+}
+
+#endif
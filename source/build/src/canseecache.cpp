@@ -0,0 +1,204 @@
+//-------------------------------------------------------------------------
+/*
+** canseecache.cpp
+**
+** Early rejection for cansee. Sectors that are not connected through any
+** red wall or TROR bunch can never see each other, so AI sight checks
+** between separate parts of a map are answered without walking the
+** sectors. The component index is built at map load and rebuilt lazily
+** after code changes a wall's nextsector.
+**
+*/
+//-------------------------------------------------------------------------
+
+#include "build.h"
+#include "compat.h"
+#include "baselayer.h"
+#include "engine_priv.h"
+#include "c_dispatch.h"
+#include "printf.h"
+#include "v_text.h"
+#include "stats.h"
+
+struct CanSeeCache
+{
+	int32_t numsectors = -1;	// number of sectors the components were built for, -1 if the cache is disabled.
+	bool dirty = false;			// a nextsector has changed, the components must be rebuilt before the next lookup.
+	TArray<int16_t> components;
+};
+
+static CanSeeCache cache;
+
+//==========================================================================
+//
+// Groups the sectors into sets connected through red walls or TROR
+// bunches. Must be called after loading a map or a savegame.
+//
+//==========================================================================
+
+void canseeCacheBuild(void)
+{
+	canseeCacheClear();
+
+	if (numsectors <= 0)
+		return;
+
+	// union-find over the sectors, followed by one node per bunch.
+	TArray<int32_t> parent(numsectors + numyaxbunches, true);
+	for (unsigned i = 0; i < parent.Size(); i++) parent[i] = i;
+
+	auto find = [&](int32_t i)
+	{
+		while (parent[i] != i) i = parent[i] = parent[parent[i]];
+		return i;
+	};
+	auto unite = [&](int32_t a, int32_t b)
+	{
+		a = find(a);
+		b = find(b);
+		if (a != b) parent[max(a, b)] = min(a, b);
+	};
+
+	for (int i = 0; i < numsectors; i++)
+	{
+		auto const sec = &sector[i];
+		for (int w = sec->wallptr; w < sec->wallptr + sec->wallnum; w++)
+		{
+			if ((unsigned)wall[w].nextsector < (unsigned)numsectors)
+				unite(i, wall[w].nextsector);
+		}
+
+		int16_t bunch[2];
+		yax_getbunches(i, &bunch[0], &bunch[1]);
+		for (auto b : bunch)
+		{
+			if ((unsigned)b < (unsigned)numyaxbunches)
+				unite(i, numsectors + b);
+		}
+	}
+
+	cache.components.Resize(numsectors);
+	for (int i = 0; i < numsectors; i++)
+		cache.components[i] = (int16_t)find(i);
+
+	cache.numsectors = numsectors;
+}
+
+void canseeCacheClear(void)
+{
+	cache.numsectors = -1;
+	cache.dirty = false;
+	cache.components.Reset();
+}
+
+//==========================================================================
+//
+// Must be called after changing a wall's nextsector at runtime, since that
+// can join or split the groups.
+//
+//==========================================================================
+
+void canseeCacheInvalidate(void)
+{
+	if (cache.numsectors >= 0)
+		cache.dirty = true;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+int32_t cansee(int32_t x1, int32_t y1, int32_t z1, int16_t sect1, int32_t x2, int32_t y2, int32_t z2, int16_t sect2)
+{
+	if (enginecompatibility_mode == ENGINECOMPATIBILITY_19950829)
+		return cansee_old(x1, y1, z1, sect1, x2, y2, z2, sect2);
+
+	if (cache.dirty)
+		canseeCacheBuild();
+
+	// Anything unusual is left to the full check.
+	if (cache.numsectors != numsectors || (unsigned)sect1 >= (unsigned)numsectors || (unsigned)sect2 >= (unsigned)numsectors)
+		return cansee_internal(x1, y1, z1, sect1, x2, y2, z2, sect2);
+
+	if (cache.components[sect1] != cache.components[sect2])
+		return 0;
+
+	return cansee_internal(x1, y1, z1, sect1, x2, y2, z2, sect2);
+}
+
+//==========================================================================
+//
+// Measures the early rejection against the plain function, using the line
+// of sight between every pair of sprites on the current map.
+//
+//==========================================================================
+
+CCMD(bench_cansee)
+{
+	if (cache.dirty)
+		canseeCacheBuild();
+
+	if (numsectors <= 0 || cache.numsectors != numsectors)
+	{
+		Printf("No map loaded\n");
+		return;
+	}
+
+	int const maxsprites = argv.argc() > 1 ? clamp((int)strtol(argv[1], nullptr, 10), 2, MAXSPRITES) : 128;
+	int const passes = 4;
+
+	TArray<int16_t> sprites;
+	for (int i = 0; i < MAXSPRITES && (int)sprites.Size() < maxsprites; i++)
+	{
+		if (sprite[i].statnum < MAXSTATUS && (unsigned)sprite[i].sectnum < (unsigned)numsectors)
+			sprites.Push(i);
+	}
+
+	int const count = sprites.Size() * sprites.Size();
+	TArray<uint8_t> results(count, true);
+	cycle_t fullclock, rejectclock;
+	int visible = 0, mismatches = 0;
+
+	fullclock.Reset();
+	fullclock.Clock();
+	for (int pass = 0; pass < passes; pass++)
+	{
+		int n = 0;
+		for (auto i : sprites)
+		{
+			for (auto j : sprites)
+			{
+				auto const s1 = &sprite[i], s2 = &sprite[j];
+				results[n++] = cansee_internal(s1->x, s1->y, s1->z, s1->sectnum, s2->x, s2->y, s2->z, s2->sectnum);
+			}
+		}
+	}
+	fullclock.Unclock();
+
+	rejectclock.Reset();
+	rejectclock.Clock();
+	for (int pass = 0; pass < passes; pass++)
+	{
+		int n = 0;
+		for (auto i : sprites)
+		{
+			for (auto j : sprites)
+			{
+				auto const s1 = &sprite[i], s2 = &sprite[j];
+				int const result = cansee(s1->x, s1->y, s1->z, s1->sectnum, s2->x, s2->y, s2->z, s2->sectnum);
+				mismatches += result != results[n++];
+				visible += pass == 0 && result;
+			}
+		}
+	}
+	rejectclock.Unclock();
+
+	double const fulltime = max(fullclock.TimeMS(), 0.001), rejecttime = max(rejectclock.TimeMS(), 0.001);
+
+	Printf("%d sprites, %d queries per pass, %d passes, %d visible\n", sprites.Size(), count, passes, visible);
+	Printf("full: %.2f ms, %.0f queries/s\n", fulltime, count * passes * 1000. / fulltime);
+	Printf("rejecting: %.2f ms, %.0f queries/s\n", rejecttime, count * passes * 1000. / rejecttime);
+	if (mismatches) Printf(TEXTCOLOR_RED "%d results differ from the full check!\n", mismatches);
+}
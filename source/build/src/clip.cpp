@@ -1504,7 +1504,15 @@ int32_t clipmove(vec3_t * const pos, int16_t * const sectnum, int32_t xvect, int
 
         int32_t tempint2, tempint1 = INT32_MAX;
         *sectnum = -1;
-        for (native_t j=numsectors-1; j>=0; j--)
+
+        // the sector grid returns its candidates in the same descending order as the full search
+        auto const candidates = sectorGridLookup(pos->x, pos->y);
+        native_t const numcandidates = candidates ? candidates->Size() : numsectors;
+
+        for (native_t n=0; n<numcandidates; n++)
+        {
+            native_t const j = candidates ? (*candidates)[n] : numsectors-1-n;
+
             if (inside(pos->x, pos->y, j) == 1)
             {
                 if (enginecompatibility_mode != ENGINECOMPATIBILITY_19950829 && (sector[j].ceilingstat&2))
@@ -1537,6 +1545,7 @@ int32_t clipmove(vec3_t * const pos, int16_t * const sectnum, int32_t xvect, int
                     }
                 }
             }
+        }
     }
 
     return clipReturn;
@@ -26,6 +26,8 @@
 #include "v_draw.h"
 #include "imgui.h"
 #include "stats.h"
+#include "workerpool.h"
+#include "tracing.h"
 #include "menu.h"
 #include "version.h"
 
@@ -153,6 +155,12 @@ CVAR(Bool, r_usenewaspect, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 int32_t newaspect_enable=0;
 
 int32_t r_fpgrouscan = 1;
+
+// Threads for drawing wall columns in the classic renderer.
+CVARD(Int, r_drawthreads, 1, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "number of threads used to draw walls in the software renderer (0 = one per core)");
+static FWorkerPool drawpool;
+
+enum { WALLSCAN_MINSTRIP = 64 };    // don't split walls into strips narrower than this
 int32_t globalflags;
 
 //Textured Map variables
@@ -1328,7 +1336,8 @@ static intptr_t bakframeplace[MAXSETVIEW];
 static int32_t bakxsiz[MAXSETVIEW], bakysiz[MAXSETVIEW];
 static vec2_t bakwindowxy1[MAXSETVIEW], bakwindowxy2[MAXSETVIEW];
 #ifdef USE_OPENGL
-static int32_t bakrendmode;
+static int32_t bakrendmode[MAXSETVIEW];
+static bool bakhwtarget[MAXSETVIEW];
 #endif
 static int32_t baktile;
 
@@ -2753,54 +2762,26 @@ static void florscan(int32_t x1, int32_t x2, int32_t sectnum)
 
 
 //
-// wallscan (internal)
+// wallscan_columns (internal)
 //
-static void wallscan(int32_t x1, int32_t x2,
-                     const int16_t *uwal, const int16_t *dwal,
-                     const int32_t *swal, const int32_t *lwal)
+// Works on local copies of the vlineasm4 column state so that separate
+// strips of the same wall can be drawn on multiple threads.
+//
+static void wallscan_columns(int32_t x, int32_t x2,
+                             const int16_t *uwal, const int16_t *dwal,
+                             const int32_t *swal, const int32_t *lwal,
+                             intptr_t fpalookup, vec2_16_t tsiz)
 {
-    int32_t x;
-    intptr_t fpalookup;
     int32_t y1ve[4], y2ve[4];
-    vec2_16_t tsiz;
+    intptr_t palookupoffse[4], bufplce[4];
+    uint32_t vplce[4];
+    int32_t vince[4];
 #ifdef MULTI_COLUMN_VLINE
     char bad;
     int32_t u4, d4, z;
     uintptr_t p;
 #endif
 
-#ifdef YAX_ENABLE
-    if (g_nodraw)
-        return;
-#endif
-    setgotpic(globalpicnum);
-    if (globalshiftval < 0)
-        return;
-
-    if (x2 >= xdim)
-        x2 = xdim-1;
-    assert((unsigned)x1 < (unsigned)xdim);
-
-    tsiz = tilesiz[globalpicnum];
-
-    if ((tsiz.x <= 0) || (tsiz.y <= 0)) return;
-    if ((uwal[x1] > ydimen) && (uwal[x2] > ydimen)) return;
-    if ((dwal[x1] < 0) && (dwal[x2] < 0)) return;
-
-        tileLoad(globalpicnum);
-
-
-    tweak_tsizes(&tsiz);
-
-    fpalookup = FP_OFF(palookup[globalpal]);
-
-    setupvlineasm(globalshiftval);
-
-
-    x = x1;
-    while ((x <= x2) && (umost[x] > dmost[x]))
-        x++;
-
 #ifdef NONPOW2_YSIZE_ASM
     if (globalshiftval==0)
         goto do_vlineasm1;
@@ -2865,7 +2846,7 @@ static void wallscan(int32_t x1, int32_t x2,
         if (u4 > y1ve[2]) vplce[2] = prevlineasm1(vince[2],palookupoffse[2],u4-y1ve[2]-1,vplce[2],bufplce[2],ylookup[y1ve[2]]+x+frameoffset+2);
         if (u4 > y1ve[3]) vplce[3] = prevlineasm1(vince[3],palookupoffse[3],u4-y1ve[3]-1,vplce[3],bufplce[3],ylookup[y1ve[3]]+x+frameoffset+3);
 
-        if (d4 >= u4) vlineasm4(d4-u4+1, (char *)(ylookup[u4]+x+frameoffset));
+        if (d4 >= u4) vlineasm4ex(d4-u4+1, (char *)(ylookup[u4]+x+frameoffset), palookupoffse, bufplce, vplce, vince);
 
         p = x+frameoffset+ylookup[d4+1];
         if (y2ve[0] > d4) prevlineasm1(vince[0],palookupoffse[0],y2ve[0]-d4-1,vplce[0],bufplce[0],p+0);
@@ -2896,6 +2877,71 @@ do_vlineasm1:
 #endif
         vlineasm1(vince[0],palookupoffse[0],y2ve[0]-y1ve[0]-1,vplce[0],bufplce[0],x+frameoffset+ylookup[y1ve[0]]);
     }
+}
+
+//
+// wallscan (internal)
+//
+static void wallscan(int32_t x1, int32_t x2,
+                     const int16_t *uwal, const int16_t *dwal,
+                     const int32_t *swal, const int32_t *lwal)
+{
+    int32_t x;
+    intptr_t fpalookup;
+    vec2_16_t tsiz;
+
+#ifdef YAX_ENABLE
+    if (g_nodraw)
+        return;
+#endif
+    setgotpic(globalpicnum);
+    if (globalshiftval < 0)
+        return;
+
+    if (x2 >= xdim)
+        x2 = xdim-1;
+    assert((unsigned)x1 < (unsigned)xdim);
+
+    tsiz = tilesiz[globalpicnum];
+
+    if ((tsiz.x <= 0) || (tsiz.y <= 0)) return;
+    if ((uwal[x1] > ydimen) && (uwal[x2] > ydimen)) return;
+    if ((dwal[x1] < 0) && (dwal[x2] < 0)) return;
+
+        tileLoad(globalpicnum);
+
+
+    tweak_tsizes(&tsiz);
+
+    fpalookup = FP_OFF(palookup[globalpal]);
+
+    setupvlineasm(globalshiftval);
+
+
+    x = x1;
+    while ((x <= x2) && (umost[x] > dmost[x]))
+        x++;
+
+    // Everything the columns depend on is set up now and nothing writes to it
+    // until the wall is done, so wide walls can be split into strips.
+    int const numstrips = min(drawpool.NumThreads(), (x2-x+1) / WALLSCAN_MINSTRIP);
+
+    if (numstrips > 1)
+    {
+        int32_t const stripwidth = ((x2-x+1) / numstrips + 3) & ~3;
+        int32_t const xstart = x;
+
+        drawpool.Run(numstrips, [=](int strip)
+        {
+            int32_t const sx1 = xstart + strip*stripwidth;
+            int32_t const sx2 = (strip == numstrips-1) ? x2 : min(x2, sx1+stripwidth-1);
+
+            if (sx1 <= sx2)
+                wallscan_columns(sx1, sx2, uwal, dwal, swal, lwal, fpalookup, tsiz);
+        });
+    }
+    else
+        wallscan_columns(x, x2, uwal, dwal, swal, lwal, fpalookup, tsiz);
 
     faketimerhandler();
 }
@@ -7011,6 +7057,7 @@ void set_globalang(fix16_t const ang)
 int32_t renderDrawRoomsQ16(int32_t daposx, int32_t daposy, int32_t daposz,
                            fix16_t daang, fix16_t dahoriz, int16_t dacursectnum)
 {
+    TRACE_ZONE("renderDrawRoomsQ16");
     int32_t i, j, /*cz, fz,*/ closest;
     int16_t *shortptr1, *shortptr2;
 
@@ -7056,6 +7103,9 @@ int32_t renderDrawRoomsQ16(int32_t daposx, int32_t daposy, int32_t daposz,
     globalcursectnum = dacursectnum;
     totalclocklock = totalclock;
 
+    if (videoGetRenderMode() == REND_CLASSIC)
+        drawpool.SetNumThreads(I_GetWorkerThreadCount(r_drawthreads));
+
     if ((xyaspect != oxyaspect) || (xdimen != oxdimen) || (viewingrange != oviewingrange))
         dosetaspect();
 
@@ -7467,6 +7517,7 @@ static void sortsprites(int const start, int const end)
 //
 void renderDrawMasks(void)
 {
+    TRACE_ZONE("renderDrawMasks");
 #ifdef DEBUG_MASK_DRAWING
         static struct {
             int16_t di;  // &32768: &32767 is tspriteptr[], else thewall[] index
@@ -8092,6 +8143,8 @@ static FORCE_INLINE int32_t have_maptext(void)
 static void enginePrepareLoadBoard(FileReader & fr, vec3_t *dapos, int16_t *daang, int16_t *dacursectnum)
 {
     initspritelists();
+    sectorGridClear();
+    canseeCacheClear();
 
     show2dsector.Zero();
     Bmemset(show2dsprite, 0, sizeof(show2dsprite));
@@ -8171,6 +8224,8 @@ static int32_t engineFinishLoadBoard(const vec3_t *dapos, int16_t *dacursectnum,
     Bassert(numsprites == Numsprites);
 
     //Must be after loading sectors, etc!
+    sectorGridBuild();
+    canseeCacheBuild();
     updatesector(dapos->x, dapos->y, dacursectnum);
 
 #ifdef HAVE_CLIPSHAPE_FEATURE
@@ -9175,10 +9230,9 @@ int32_t cansee_old(int32_t xs, int32_t ys, int32_t zs, int16_t sectnums, int32_t
     return 0;
 }
 
-int32_t cansee(int32_t x1, int32_t y1, int32_t z1, int16_t sect1, int32_t x2, int32_t y2, int32_t z2, int16_t sect2)
+// The public cansee in canseecache.cpp calls this for sectors that are connected.
+int32_t cansee_internal(int32_t x1, int32_t y1, int32_t z1, int16_t sect1, int32_t x2, int32_t y2, int32_t z2, int16_t sect2)
 {
-    if (enginecompatibility_mode == ENGINECOMPATIBILITY_19950829)
-        return cansee_old(x1, y1, z1, sect1, x2, y2, z2, sect2);
     int32_t dacnt, danum;
     const int32_t x21 = x2-x1, y21 = y2-y1, z21 = z2-z1;
 
@@ -9487,6 +9541,7 @@ void dragpoint(int16_t pointhighlight, int32_t dax, int32_t day, uint8_t flags)
             wall[w].x = dax;
             wall[w].y = day;
             walbitmap[w>>3] |= pow2char[w&7];
+            sectorGridInvalidate(sectorofwall(w));
 
             for (YAX_ITER_WALLS(w, j, tmpcf))
             {
@@ -9663,6 +9718,27 @@ int findwallbetweensectors(int sect1, int sect2)
     return -1;
 }
 
+// Returns the highest numbered sector matching the predicate. The sector grid is used to
+// skip all sectors whose bounding box does not contain the point.
+template <typename Predicate>
+static inline int findsectorexhaustive(int32_t const x, int32_t const y, Predicate const &p)
+{
+    if (auto const candidates = sectorGridLookup(x, y))
+    {
+        for (auto const sectnum : *candidates)
+            if (p(sectnum))
+                return sectnum;
+
+        return -1;
+    }
+
+    for (int i = numsectors - 1; i >= 0; --i)
+        if (p(i))
+            return i;
+
+    return -1;
+}
+
 //
 // updatesector[z]
 //
@@ -9698,11 +9774,7 @@ void updatesector(int32_t const x, int32_t const y, int16_t * const sectnum)
 
     // we need to support passing in a sectnum of -1, unfortunately
 
-    for (int i = numsectors - 1; i >= 0; --i)
-        if (inside_p(x, y, i))
-            SET_AND_RETURN(*sectnum, i);
-
-    *sectnum = -1;
+    *sectnum = findsectorexhaustive(x, y, [=](int i) { return inside_p(x, y, i); });
 }
 
 void updatesectorexclude(int32_t const x, int32_t const y, int16_t * const sectnum, const uint8_t * const excludesectbitmap)
@@ -9725,11 +9797,7 @@ void updatesectorexclude(int32_t const x, int32_t const y, int16_t * const sectn
         while (--wallsleft);
     }
 
-    for (bssize_t i=numsectors-1; i>=0; --i)
-        if (inside_exclude_p(x, y, i, excludesectbitmap))
-            SET_AND_RETURN(*sectnum, i);
-
-    *sectnum = -1;
+    *sectnum = findsectorexhaustive(x, y, [=](int i) { return inside_exclude_p(x, y, i, excludesectbitmap); });
 }
 
 // new: if *sectnum >= MAXSECTORS, *sectnum-=MAXSECTORS is considered instead
@@ -9796,11 +9864,7 @@ void updatesectorz(int32_t const x, int32_t const y, int32_t const z, int16_t *
     }
 
     // we need to support passing in a sectnum of -1, unfortunately
-    for (int i = numsectors - 1; i >= 0; --i)
-        if (inside_z_p(x, y, z, i))
-            SET_AND_RETURN(*sectnum, i);
-
-    *sectnum = -1;
+    *sectnum = findsectorexhaustive(x, y, [=](int i) { return inside_z_p(x, y, z, i); });
 }
 
 void updatesectorneighbor(int32_t const x, int32_t const y, int16_t * const sectnum, int32_t initialMaxDistance /*= INITIALUPDATESECTORDIST*/, int32_t maxDistance /*= MAXUPDATESECTORDIST*/)
@@ -10090,14 +10154,8 @@ void videoClearScreen(int32_t dacol)
 //
 // setviewtotile
 //
-void renderSetTarget(int16_t tilenume, int32_t xsiz, int32_t ysiz)
+static void renderBeginTarget(int16_t tilenume, int32_t xsiz, int32_t ysiz, bool hwtarget)
 {
-    if (setviewcnt >= MAXSETVIEW-1)
-        return;
-    if (xsiz <= 0 ||
-        ysiz <= 0)
-        return;
-
     //DRAWROOMS TO TILE BACKUP&SET CODE
 	TileFiles.tileCreate(tilenume, xsiz, ysiz);
     bakxsiz[setviewcnt] = xdim; bakysiz[setviewcnt] = ydim;
@@ -10107,14 +10165,13 @@ void renderSetTarget(int16_t tilenume, int32_t xsiz, int32_t ysiz)
 
     if (setviewcnt == 0)
     {
-#ifdef USE_OPENGL
-        bakrendmode = rendmode;
-#endif
         baktile = tilenume;
     }
 
 #ifdef USE_OPENGL
-    rendmode = REND_CLASSIC;
+    bakrendmode[setviewcnt] = rendmode;
+    bakhwtarget[setviewcnt] = hwtarget;
+    if (!hwtarget) rendmode = REND_CLASSIC;
 #endif
 
     copybufbyte(&startumost[windowxy1.x],&bakumost[windowxy1.x],(windowxy2.x-windowxy1.x+1)*sizeof(bakumost[0]));
@@ -10130,6 +10187,43 @@ void renderSetTarget(int16_t tilenume, int32_t xsiz, int32_t ysiz)
     calc_ylookup(ysiz, xsiz);
 }
 
+void renderSetTarget(int16_t tilenume, int32_t xsiz, int32_t ysiz)
+{
+    if (setviewcnt >= MAXSETVIEW-1)
+        return;
+    if (xsiz <= 0 ||
+        ysiz <= 0)
+        return;
+
+    renderBeginTarget(tilenume, xsiz, ysiz, false);
+}
+
+//
+// Variant of renderSetTarget for camera tiles whose image gets transposed
+// with squarerotatetile afterward. The hardware renderer can draw these
+// directly into the tile's texture. Returns true in that case, and the
+// tile's pixel data must then be left alone.
+//
+bool renderSetCameraTarget(int16_t tilenume, int32_t xsiz, int32_t ysiz)
+{
+#ifdef USE_OPENGL
+    // squarerotatetile only works on square tiles, so only these have an upright image the texture can reproduce.
+    if (hw_cameratextures && videoGetRenderMode() >= REND_POLYMOST && setviewcnt == 0 && xsiz > 0 && xsiz == ysiz &&
+        TileFiles.tileCreate(tilenume, xsiz, ysiz) != nullptr)
+    {
+        auto hwtex = GLInterface.GetRenderTarget(TileFiles.tiles[tilenume]);
+        renderBeginTarget(tilenume, xsiz, ysiz, true);
+
+        screen->BeginScene();
+        GLInterface.SetRenderTarget(hwtex);
+        screen->FinishScene();
+        return true;
+    }
+#endif
+    renderSetTarget(tilenume, xsiz, ysiz);
+    return false;
+}
+
 
 //
 // setviewback
@@ -10141,9 +10235,15 @@ void renderRestoreTarget(void)
 
     offscreenrendering = (setviewcnt>0);
 #ifdef USE_OPENGL
-    if (setviewcnt == 0)
+    rendmode = bakrendmode[setviewcnt];
+    if (bakhwtarget[setviewcnt])
+    {
+        screen->BeginScene();
+        GLInterface.SetRenderTarget(nullptr);
+        screen->FinishScene();
+    }
+    else if (setviewcnt == 0)
     {
-        rendmode = bakrendmode;
         tileInvalidate(baktile,-1,-1);
     }
 #endif
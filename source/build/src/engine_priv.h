@@ -295,4 +295,7 @@ static inline void get_floorspr_points(T const * const spr, int32_t px, int32_t
     *y3 = *y2 + ofs.y, *y4 = *y1 + ofs.y;
 }
 
+int32_t cansee_old(int32_t xs, int32_t ys, int32_t zs, int16_t sectnums, int32_t xe, int32_t ye, int32_t ze, int16_t sectnume);
+int32_t cansee_internal(int32_t x1, int32_t y1, int32_t z1, int16_t sect1, int32_t x2, int32_t y2, int32_t z2, int16_t sect2);
+
 #endif	/* ENGINE_PRIV_H */
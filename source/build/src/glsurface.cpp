@@ -29,6 +29,7 @@ bool glsurface_initialize(vec2_t bufferResolution)
 
 	bufferTexture = GLInterface.NewTexture();
 	bufferTexture->CreateTexture(bufferRes.x, bufferRes.y, FHardwareTexture::Indexed, false);
+	bufferTexture->CreateUploadBuffer();
 
     glsurface_setPalette(curpalettefaded);
 	GLInterface.SetSurfaceShader();
@@ -74,7 +75,15 @@ void glsurface_blitBuffer()
 	if (!buffer.Size())
 		return;
 
-	bufferTexture->LoadTexture(buffer.Data());
+	// Stream the frame through the upload buffer if there is one, so that the driver does not need to
+	// copy it synchronously. The renderer keeps drawing into system memory because it also reads from it.
+	auto map = bufferTexture->MapUploadBuffer();
+	if (map != nullptr)
+	{
+		memcpy(map, buffer.Data(), buffer.Size());
+		bufferTexture->LoadTextureFromUploadBuffer();
+	}
+	else bufferTexture->LoadTexture(buffer.Data());
 	GLInterface.BindTexture(0, bufferTexture, SamplerNoFilterClampXY);
 	GLInterface.Draw(DT_TRIANGLE_STRIP, FFlatVertexBuffer::PRESENT_INDEX, 4);
 }
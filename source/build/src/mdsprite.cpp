@@ -1075,6 +1075,14 @@ static md3model_t *md3load(FileReader & fil)
             }
         }
 #endif
+        // The triangles index into the vertex buffer directly, so they must not reference anything outside the surface.
+        if (s->numverts <= 0) s->numtris = 0;
+        for (i=s->numtris-1; i>=0; i--)
+        {
+            for (int j=2; j>=0; j--)
+                if ((unsigned)s->tris[i].i[j] >= (unsigned)s->numverts) s->tris[i].i[j] = 0;
+        }
+
         maxmodelverts = max(maxmodelverts, s->numverts);
         maxmodeltris = max(maxmodeltris, s->numtris);
         maxtrispersurf = max(maxtrispersurf, s->numtris);
@@ -1453,6 +1461,49 @@ void md3_vox_calcmat_common(tspriteptr_t tspr, const vec3f_t *a0, float f, float
     mat[14] = (mat[14] + a0->y*mat[2]) + (a0->z*mat[6] + a0->x*mat[10]);
 }
 
+//------------------------------------------------------------------------------------
+// The frames are stored untransformed, only with the axes swapped to match the
+// model matrix, which takes care of scaling, rotating and positioning the model.
+//------------------------------------------------------------------------------------
+
+static void md3framevertices(const md3surf_t *s, int32_t frame, FFlatVertex *vt)
+{
+    const md3xyzn_t *const v = &s->xyzn[frame*s->numverts];
+
+    for (int32_t i=0; i<s->numverts; i++, vt++)
+    {
+        vt->SetTexCoord(s->uv[i].u, s->uv[i].v);
+        vt->SetVertex(v[i].y, v[i].z, v[i].x);
+    }
+}
+
+// All frames of all surfaces get uploaded once, drawing only needs to select two of them.
+static bool md3uploadframes(md3model_t *m)
+{
+    auto vertexdata = screen->mVertexData;
+    if (m->vbserial == vertexdata->StaticSerial()) return true;
+
+    unsigned int count = 0;
+    for (int32_t surfi=0; surfi<m->head.numsurfs; surfi++)
+        count += m->head.surfs[surfi].numverts * m->numframes;
+
+    auto data = vertexdata->AllocStaticVertices(count);
+    if (!data.first) return false;
+
+    auto vt = data.first;
+    unsigned int vbindex = data.second;
+    for (int32_t surfi=0; surfi<m->head.numsurfs; surfi++)
+    {
+        md3surf_t *const s = &m->head.surfs[surfi];
+        s->vbindex = vbindex;
+        for (int32_t framei=0; framei<m->numframes; framei++, vt += s->numverts)
+            md3framevertices(s, framei, vt);
+        vbindex += s->numverts * m->numframes;
+    }
+    m->vbserial = vertexdata->StaticSerial();
+    return true;
+}
+
 static void md3draw_handle_triangles(const md3surf_t *s, uint16_t *indexhandle,
                                             int32_t texunits, const md3model_t *M)
 {
@@ -1472,7 +1523,7 @@ static void md3draw_handle_triangles(const md3surf_t *s, uint16_t *indexhandle,
 
             vt->SetTexCoord(s->uv[k].u, s->uv[k].v);
 
-            vt->SetVertex(vertlist[k].x, vertlist[k].y);
+            vt->SetVertex(vertlist[k].x, vertlist[k].y, vertlist[k].z);
         }
     }
 	GLInterface.Draw(DT_TRIANGLES, data.second, s->numtris *3);
@@ -1501,10 +1552,6 @@ static int32_t polymost_md3draw(md3model_t *m, tspriteptr_t tspr)
 
     updateanimation((md2model_t *)m, tspr, lpal);
 
-    //create current&next frame's vertex list from whole list
-
-    f = m->interpol; g = 1.f - f;
-
     if (m->interpol < 0.f || m->interpol > 1.f ||
         (unsigned)m->cframe >= (unsigned)m->numframes ||
             (unsigned)m->nframe >= (unsigned)m->numframes)
@@ -1519,6 +1566,8 @@ static int32_t polymost_md3draw(md3model_t *m, tspriteptr_t tspr)
         m->nframe = clamp(m->nframe, 0, m->numframes-1);
     }
 
+    f = m->interpol; g = 1.f - f;
+
     m0.z = m0.y = m0.x = g *= m->scale * (1.f/64.f);
     m1.z = m1.y = m1.x = f *= m->scale * (1.f/64.f);
 
@@ -1643,65 +1692,47 @@ static int32_t polymost_md3draw(md3model_t *m, tspriteptr_t tspr)
         k3 = (float)sintable[sext->roll&2047] * (1.f/16384.f);
     }
 
-    int prevClamp = GLInterface.GetClamp();
-	GLInterface.SetClamp(0);
-    auto matrixindex = GLInterface.SetIdentityMatrix(Matrix_Model);
+    // The frames get interpolated without any further transformation, everything else goes into the model matrix.
+    // m0 and m1 only differ by the interpolation weights, so their sum is the model's scale.
+    float const scale[3] = { m0.y+m1.y, m0.z+m1.z, m0.x+m1.x };
+    float xform[16] = { scale[0], 0.f, 0.f, 0.f,  0.f, scale[1], 0.f, 0.f,  0.f, 0.f, scale[2], 0.f,  0.f, 0.f, 0.f, 1.f };
 
-    for (surfi=0; surfi<m->head.numsurfs; surfi++)
+    if (sext->pitch || sext->roll)
     {
-        //PLAG : sorting stuff
-        uint16_t           *indexhandle;
-        vec3f_t fp;
-
-        const md3surf_t *const s = &m->head.surfs[surfi];
+        // Rotation around the pivot, in the vertices' axis order.
+        float const rot[3][3] = { { k2, k3, 0.f }, { -k0*k3, k0*k2, -k1 }, { -k1*k3, k1*k2, k0 } };
+        float const pivot[3] = { a0.y, a0.z, a0.x };
 
-        v0 = &s->xyzn[m->cframe*s->numverts];
-        v1 = &s->xyzn[m->nframe*s->numverts];
-
-        if (sext->pitch || sext->roll)
+        for (int r=0; r<3; r++)
         {
-            vec3f_t fp1, fp2;
-
-            for (i=s->numverts-1; i>=0; i--)
+            float t = -pivot[r];
+            for (int c=0; c<3; c++)
             {
-                fp.z = v0[i].x + a0.x;
-                fp.x = v0[i].y + a0.y;
-                fp.y = v0[i].z + a0.z;
-
-                fp1.x = fp.x*k2 +       fp.y*k3;
-                fp1.y = fp.x*k0*(-k3) + fp.y*k0*k2 + fp.z*(-k1);
-                fp1.z = fp.x*k1*(-k3) + fp.y*k1*k2 + fp.z*k0;
-
-                fp.z = v1[i].x + a0.x;
-                fp.x = v1[i].y + a0.y;
-                fp.y = v1[i].z + a0.z;
-
-                fp2.x = fp.x*k2 +       fp.y*k3;
-                fp2.y = fp.x*k0*(-k3) + fp.y*k0*k2 + fp.z*(-k1);
-                fp2.z = fp.x*k1*(-k3) + fp.y*k1*k2 + fp.z*k0;
-                fp.z = (fp1.z - a0.x)*m0.x + (fp2.z - a0.x)*m1.x;
-                fp.x = (fp1.x - a0.y)*m0.y + (fp2.x - a0.y)*m1.y;
-                fp.y = (fp1.y - a0.z)*m0.z + (fp2.y - a0.z)*m1.z;
-
-                vertlist[i] = fp;
+                xform[c*4+r] = scale[r]*rot[r][c];
+                t += rot[r][c]*pivot[c];
             }
+            xform[12+r] = scale[r]*t;
         }
-        else
-        {
-            for (i=s->numverts-1; i>=0; i--)
-            {
-                fp.z = v0[i].x*m0.x + v1[i].x*m1.x;
-                fp.y = v0[i].z*m0.z + v1[i].z*m1.z;
-                fp.x = v0[i].y*m0.y + v1[i].y*m1.y;
+    }
 
-                vertlist[i] = fp;
-            }
-        }
+    //Let OpenGL (and perhaps hardware :) handle the matrix rotation
+    mat[3] = mat[7] = mat[11] = 0.f; mat[15] = 1.f;
+    VSMatrix modelmat;
+    modelmat.loadMatrix(mat);
+    modelmat.multMatrix(xform);
+    const float *const cm = modelmat.get();
 
-        //Let OpenGL (and perhaps hardware :) handle the matrix rotation
-        mat[3] = mat[7] = mat[11] = 0.f; mat[15] = 1.f;
-		GLInterface.SetMatrix(Matrix_Model, mat);
-        // PLAG: End
+    // Translucent surfaces need their triangles sorted, which requires the interpolated vertices on the CPU.
+    bool const sorted = (tspr->clipdist & TSPR_FLAGS_MDHACK) && m->usesalpha;
+    bool const uploaded = !sorted && md3uploadframes(m);
+
+    int prevClamp = GLInterface.GetClamp();
+	GLInterface.SetClamp(0);
+    auto matrixindex = GLInterface.SetMatrix(Matrix_Model, &modelmat);
+
+    for (surfi=0; surfi<m->head.numsurfs; surfi++)
+    {
+        const md3surf_t *const s = &m->head.surfs[surfi];
 
 		bool exact = false;
         auto tex = mdloadskin((md2model_t *)m,tile2model[Ptile2tile(tspr->picnum,lpal)].skinnum,globalpal,surfi, &exact);
@@ -1725,39 +1756,50 @@ static int32_t polymost_md3draw(md3model_t *m, tspriteptr_t tspr)
 		}
 		GLInterface.SetModelTexture(tex, globalpal, det, detscale, glow);
 
-        if (tspr->clipdist & TSPR_FLAGS_MDHACK)
+        if (uploaded)
         {
-            //POGOTODO: if we add support for palette indexing on model skins, the texture for the palswap could be setup here
+            GLInterface.DrawModelFrames(s->vbindex + m->cframe*s->numverts, s->vbindex + m->nframe*s->numverts, m->interpol,
+                                        (const uint32_t *)s->tris, s->numtris*3);
+        }
+        else
+        {
+            //create current&next frame's vertex list from whole list
+            v0 = &s->xyzn[m->cframe*s->numverts];
+            v1 = &s->xyzn[m->nframe*s->numverts];
+            f = m->interpol; g = 1.f - f;
 
-            indexhandle = m->vindexes;
+            for (i=s->numverts-1; i>=0; i--)
+            {
+                vertlist[i].x = v0[i].y*g + v1[i].y*f;
+                vertlist[i].y = v0[i].z*g + v1[i].z*f;
+                vertlist[i].z = v0[i].x*g + v1[i].x*f;
+            }
 
             //PLAG: delayed polygon-level sorted rendering
-
-            if (m->usesalpha)
+            if (sorted)
             {
                 for (i=0; i<=s->numtris-1; ++i)
                 {
                     vec3f_t const vlt[3] = { vertlist[s->tris[i].i[0]], vertlist[s->tris[i].i[1]], vertlist[s->tris[i].i[2]] };
 
                     // Matrix multiplication - ugly but clear
-                    vec3f_t const fp[3] = { { (vlt[0].x * mat[0]) + (vlt[0].y * mat[4]) + (vlt[0].z * mat[8]) + mat[12],
-                                              (vlt[0].x * mat[1]) + (vlt[0].y * mat[5]) + (vlt[0].z * mat[9]) + mat[13],
-                                              (vlt[0].x * mat[2]) + (vlt[0].y * mat[6]) + (vlt[0].z * mat[10]) + mat[14] },
+                    vec3f_t const fp[3] = { { (vlt[0].x * cm[0]) + (vlt[0].y * cm[4]) + (vlt[0].z * cm[8]) + cm[12],
+                                              (vlt[0].x * cm[1]) + (vlt[0].y * cm[5]) + (vlt[0].z * cm[9]) + cm[13],
+                                              (vlt[0].x * cm[2]) + (vlt[0].y * cm[6]) + (vlt[0].z * cm[10]) + cm[14] },
 
-                                            { (vlt[1].x * mat[0]) + (vlt[1].y * mat[4]) + (vlt[1].z * mat[8]) + mat[12],
-                                              (vlt[1].x * mat[1]) + (vlt[1].y * mat[5]) + (vlt[1].z * mat[9]) + mat[13],
-                                              (vlt[1].x * mat[2]) + (vlt[1].y * mat[6]) + (vlt[1].z * mat[10]) + mat[14] },
+                                            { (vlt[1].x * cm[0]) + (vlt[1].y * cm[4]) + (vlt[1].z * cm[8]) + cm[12],
+                                              (vlt[1].x * cm[1]) + (vlt[1].y * cm[5]) + (vlt[1].z * cm[9]) + cm[13],
+                                              (vlt[1].x * cm[2]) + (vlt[1].y * cm[6]) + (vlt[1].z * cm[10]) + cm[14] },
 
-                                            { (vlt[2].x * mat[0]) + (vlt[2].y * mat[4]) + (vlt[2].z * mat[8]) + mat[12],
-                                              (vlt[2].x * mat[1]) + (vlt[2].y * mat[5]) + (vlt[2].z * mat[9]) + mat[13],
-                                              (vlt[2].x * mat[2]) + (vlt[2].y * mat[6]) + (vlt[2].z * mat[10]) + mat[14] } };
+                                            { (vlt[2].x * cm[0]) + (vlt[2].y * cm[4]) + (vlt[2].z * cm[8]) + cm[12],
+                                              (vlt[2].x * cm[1]) + (vlt[2].y * cm[5]) + (vlt[2].z * cm[9]) + cm[13],
+                                              (vlt[2].x * cm[2]) + (vlt[2].y * cm[6]) + (vlt[2].z * cm[10]) + cm[14] } };
 
                     f = (fp[0].x * fp[0].x) + (fp[0].y * fp[0].y) + (fp[0].z * fp[0].z);
                     g = (fp[1].x * fp[1].x) + (fp[1].y * fp[1].y) + (fp[1].z * fp[1].z);
 
                     if (f > g)
                         f = g;
-
                     g = (fp[2].x * fp[2].x) + (fp[2].y * fp[2].y) + (fp[2].z * fp[2].z);
 
                     if (f > g)
@@ -1771,13 +1813,7 @@ static int32_t polymost_md3draw(md3model_t *m, tspriteptr_t tspr)
                 quicksort(m->indexes, m->maxdepths, 0, s->numtris - 1);
             }
 
-            md3draw_handle_triangles(s, indexhandle, 1, m->usesalpha ? m : NULL);
-        }
-        else
-        {
-            indexhandle = m->vindexes;
-
-            md3draw_handle_triangles(s, indexhandle, 1, NULL);
+            md3draw_handle_triangles(s, m->vindexes, 1, sorted ? m : NULL);
         }
 
 		GLInterface.UseDetailMapping(false);
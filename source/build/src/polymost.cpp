@@ -18,6 +18,7 @@ Ken Silverman's official web site: http://www.advsys.net/ken
 #include "gamecvars.h"
 #include "v_video.h"
 #include "flatvertices.h"
+#include "tracing.h"
 
 CVAR(Bool, hw_detailmapping, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 CVAR(Bool, hw_glowmapping, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
@@ -28,6 +29,7 @@ CVARD(Bool, hw_models, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "enable/disable m
 CVARD(Bool, hw_parallaxskypanning, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "enable/disable parallaxed floor/ceiling panning when drawing a parallaxing sky")
 CVARD(Bool, hw_shadeinterpolate, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "enable/disable shade interpolation")
 CVARD(Float, hw_shadescale, 1.0f, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "multiplier for shading")
+CVARD(Bool, hw_cameratextures, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "enable/disable rendering camera tiles directly into a texture")
 bool hw_int_useindexedcolortextures;
 CUSTOM_CVARD(Bool, hw_useindexedcolortextures, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "enable/disable indexed color texture rendering")
 {
@@ -211,6 +213,10 @@ void polymost_glreset()
 		TileFiles.ClearTextureCache();
     }
 
+    // Voxel models upload their vertices again when they get drawn next.
+    if (screen && screen->mVertexData)
+        screen->mVertexData->ResetStatic();
+
 	if (polymosttext)
 		delete polymosttext;
     polymosttext=nullptr;
@@ -3155,6 +3161,8 @@ void polymost_drawrooms()
 {
     if (videoGetRenderMode() == REND_CLASSIC) return;
 
+    TRACE_ZONE("polymost_drawrooms");
+
     polymost_outputGLDebugMessage(3, "polymost_drawrooms()");
 
     videoBeginDrawing();
@@ -4623,11 +4631,63 @@ static void polymost_precache(int32_t dapicnum, int32_t dapalnum, int32_t datype
 	}
 }
 
+static TArray<int> precacheTiles;
+static FixedBitArray<MAXTILES> precacheQueued;
+
 void PrecacheHardwareTextures(int nTile)
 {
 	// PRECACHE
 	// This really *really* needs improvement on the game side - the entire precaching logic has no clue about the different needs of a hardware renderer.
-	polymost_precache(nTile, 0, 1);
+	if ((unsigned)nTile >= MAXTILES || precacheQueued[nTile]) return;
+	precacheQueued.Set(nTile);
+	precacheTiles.Push(nTile);
+}
+
+static void polymost_addprecachereplacement(TArray<FTexture*>& list, TMap<FTexture*, bool>& found, HightileReplacement* rep)
+{
+	if (rep == nullptr) return;
+	auto tex = rep->faces[0];
+	if (tex == nullptr || tex->GetImage() == nullptr || tex->GetHardwareTexture(0) || found.CheckKey(tex)) return;
+	found.Insert(tex, true);
+	list.Push(tex);
+}
+
+//
+// Creates the textures for everything PrecacheHardwareTextures collected.
+// The hightile replacements are done first, all at once, so that their
+// image files can be decoded in parallel.
+//
+void FinishHardwareTexturePrecache(void (*progress)(int done, int total))
+{
+	TArray<FTexture*> replacements;
+
+	if (videoGetRenderMode() >= REND_POLYMOST && hw_hightile && !(hictinting[0].f & HICTINT_ALWAYSUSEART))
+	{
+		TMap<FTexture*, bool> found;
+		for (auto tile : precacheTiles)
+		{
+			auto rep = TileFiles.tiles[tile]->FindReplacement(0);
+			if (rep == nullptr) continue;
+			polymost_addprecachereplacement(replacements, found, rep);
+
+			// The same layers SetTextureInternal looks up for the replacement.
+			auto tex = rep->faces[0];
+			if (hw_detailmapping) polymost_addprecachereplacement(replacements, found, tex->FindReplacement(DETAILPAL));
+			if (hw_glowmapping) polymost_addprecachereplacement(replacements, found, tex->FindReplacement(GLOWPAL));
+			polymost_addprecachereplacement(replacements, found, tex->FindReplacement(BRIGHTPAL));
+		}
+	}
+
+	int const total = replacements.Size() + precacheTiles.Size();
+	GLInterface.PrecacheHightiles(replacements, [=](int done) { if (progress) progress(done, total); });
+
+	for (unsigned i = 0; i < precacheTiles.Size(); i++)
+	{
+		polymost_precache(precacheTiles[i], 0, 1);
+		precacheQueued.Clear(precacheTiles[i]);
+		if (progress && (i & 7) == 7) progress(replacements.Size() + i + 1, total);
+	}
+	precacheTiles.Clear();
 }
 
 extern char* voxfilenames[MAXVOXELS];
@@ -4645,12 +4705,14 @@ static void PolymostProcessVoxels(void)
     OSD_Printf("Generating voxel models for Polymost. This may take a while...\n");
     //videoNextPage();
 
+    voxloadmultiple(voxfilenames, voxmodels, MAXVOXELS);
+
     for (bssize_t i = 0; i < MAXVOXELS; i++)
     {
         if (voxfilenames[i])
         {
-            voxmodels[i] = voxload(voxfilenames[i]);
-            voxmodels[i]->scale = voxscale[i] * (1.f / 65536.f);
+            if (voxmodels[i])
+                voxmodels[i]->scale = voxscale[i] * (1.f / 65536.f);
             DO_FREE_AND_NULL(voxfilenames[i]);
         }
     }
@@ -0,0 +1,319 @@
+//-------------------------------------------------------------------------
+/*
+** sectorgrid.cpp
+**
+** Uniform grid over the sector bounding boxes. This is used to narrow down
+** the set of sectors the updatesector family of functions needs to check
+** when the search through the neighboring sectors fails.
+**
+** Each cell keeps the sectors overlapping it in descending order so that
+** the result is identical to the original brute force search which checks
+** all sectors from the highest index down.
+**
+*/
+//-------------------------------------------------------------------------
+
+#include "build.h"
+#include "compat.h"
+#include "baselayer.h"
+#include "c_dispatch.h"
+#include "printf.h"
+#include "v_text.h"
+#include "stats.h"
+
+enum
+{
+	GRID_MAXCELLS = 128,	// maximum number of cells along each axis
+	GRID_MINSHIFT = 8,		// don't make cells smaller than 256 map units.
+};
+
+struct SectorGrid
+{
+	int32_t minx, miny;
+	int32_t shift;
+	int32_t sizex, sizey;
+	int32_t numsectors = -1;	// number of sectors the grid was built for, -1 if it's invalid.
+	TArray<TArray<int16_t>> cells;
+	TArray<int16_t> dirty;
+};
+
+struct SectorCellRange
+{
+	int16_t x1, y1, x2, y2;
+
+	bool operator==(const SectorCellRange &other) const
+	{
+		return x1 == other.x1 && y1 == other.y1 && x2 == other.x2 && y2 == other.y2;
+	}
+};
+
+static SectorGrid grid;
+static SectorCellRange sectorcells[MAXSECTORS];
+static uint8_t sectordirty[(MAXSECTORS + 7) >> 3];
+
+//==========================================================================
+//
+// Computes the range of cells a sector's bounding box overlaps.
+// The box is padded by one unit because inside() treats points on the
+// boundary differently depending on the direction of the wall.
+//
+//==========================================================================
+
+static SectorCellRange sectorGridGetRange(int sectnum)
+{
+	auto const sec = &sector[sectnum];
+	int32_t x1 = INT32_MAX, y1 = INT32_MAX, x2 = INT32_MIN, y2 = INT32_MIN;
+
+	for (int i = sec->wallptr; i < sec->wallptr + sec->wallnum; i++)
+	{
+		x1 = min<int32_t>(x1, wall[i].x);
+		y1 = min<int32_t>(y1, wall[i].y);
+		x2 = max<int32_t>(x2, wall[i].x);
+		y2 = max<int32_t>(y2, wall[i].y);
+	}
+
+	if (x1 > x2)
+		return { 0, 0, -1, -1 };	// sector without walls, never matches anything.
+
+	auto clampcell = [](int64_t v, int32_t origin, int32_t shift, int32_t size)
+	{
+		return (int16_t)clamp<int64_t>((v - origin) >> shift, 0, size - 1);
+	};
+
+	return { clampcell(x1 - 1LL, grid.minx, grid.shift, grid.sizex), clampcell(y1 - 1LL, grid.miny, grid.shift, grid.sizey),
+			 clampcell(x2 + 1LL, grid.minx, grid.shift, grid.sizex), clampcell(y2 + 1LL, grid.miny, grid.shift, grid.sizey) };
+}
+
+//==========================================================================
+//
+// Adds or removes a sector from all cells in the given range.
+// The cell lists are kept sorted in descending order.
+//
+//==========================================================================
+
+static void sectorGridLink(int sectnum, const SectorCellRange &range)
+{
+	for (int y = range.y1; y <= range.y2; y++)
+	{
+		for (int x = range.x1; x <= range.x2; x++)
+		{
+			auto &cell = grid.cells[y * grid.sizex + x];
+			unsigned i = 0;
+			while (i < cell.Size() && cell[i] > sectnum) i++;
+			cell.Insert(i, (int16_t)sectnum);
+		}
+	}
+}
+
+static void sectorGridUnlink(int sectnum, const SectorCellRange &range)
+{
+	for (int y = range.y1; y <= range.y2; y++)
+	{
+		for (int x = range.x1; x <= range.x2; x++)
+		{
+			auto &cell = grid.cells[y * grid.sizex + x];
+			unsigned i = cell.Find((int16_t)sectnum);
+			if (i < cell.Size()) cell.Delete(i);
+		}
+	}
+}
+
+//==========================================================================
+//
+// Rebuilds the grid for the current map. Must be called after loading
+// a map or a savegame. sectorGridClear disables the grid while the map
+// data is in an inconsistent state.
+//
+//==========================================================================
+
+void sectorGridBuild(void)
+{
+	sectorGridClear();
+
+	if (numsectors <= 0 || numwalls <= 0)
+		return;
+
+	int32_t x1 = INT32_MAX, y1 = INT32_MAX, x2 = INT32_MIN, y2 = INT32_MIN;
+
+	for (int i = 0; i < numwalls; i++)
+	{
+		x1 = min<int32_t>(x1, wall[i].x);
+		y1 = min<int32_t>(y1, wall[i].y);
+		x2 = max<int32_t>(x2, wall[i].x);
+		y2 = max<int32_t>(y2, wall[i].y);
+	}
+
+	grid.minx = x1 - 1;
+	grid.miny = y1 - 1;
+
+	int64_t const extent = max<int64_t>((int64_t)x2 - x1, (int64_t)y2 - y1) + 3;
+
+	grid.shift = GRID_MINSHIFT;
+	while ((extent >> grid.shift) >= GRID_MAXCELLS) grid.shift++;
+
+	grid.sizex = (int32_t)((((int64_t)x2 + 1 - grid.minx) >> grid.shift) + 1);
+	grid.sizey = (int32_t)((((int64_t)y2 + 1 - grid.miny) >> grid.shift) + 1);
+	grid.cells.Alloc(grid.sizex * grid.sizey);
+
+	// Link in ascending order with each new sector going to the front. This avoids all list searching during the initial setup.
+	for (int i = 0; i < numsectors; i++)
+	{
+		auto const range = sectorGridGetRange(i);
+		sectorcells[i] = range;
+		for (int y = range.y1; y <= range.y2; y++)
+			for (int x = range.x1; x <= range.x2; x++)
+				grid.cells[y * grid.sizex + x].Push((int16_t)i);
+	}
+
+	for (auto &cell : grid.cells)
+	{
+		std::reverse(cell.begin(), cell.end());
+		cell.ShrinkToFit();
+	}
+
+	grid.numsectors = numsectors;
+}
+
+void sectorGridClear(void)
+{
+	grid.numsectors = -1;
+	grid.cells.Reset();
+	grid.dirty.Clear();
+	memset(sectordirty, 0, sizeof(sectordirty));
+}
+
+//==========================================================================
+//
+// Marks a sector whose walls have moved. The grid gets updated lazily
+// on the next lookup.
+//
+//==========================================================================
+
+void sectorGridInvalidate(int sectnum)
+{
+	if (grid.numsectors < 0 || (unsigned)sectnum >= (unsigned)grid.numsectors || bitmap_test(sectordirty, sectnum))
+		return;
+
+	bitmap_set(sectordirty, sectnum);
+	grid.dirty.Push((int16_t)sectnum);
+}
+
+static void sectorGridUpdate(void)
+{
+	for (auto sectnum : grid.dirty)
+	{
+		bitmap_clear(sectordirty, sectnum);
+
+		auto const range = sectorGridGetRange(sectnum);
+		if (range == sectorcells[sectnum])
+			continue;
+
+		sectorGridUnlink(sectnum, sectorcells[sectnum]);
+		sectorGridLink(sectnum, range);
+		sectorcells[sectnum] = range;
+	}
+	grid.dirty.Clear();
+}
+
+//==========================================================================
+//
+// Returns the list of sectors whose bounding box contains the given point,
+// highest index first, or nullptr if the grid cannot answer the query and
+// all sectors need to be checked.
+//
+//==========================================================================
+
+const TArray<int16_t> *sectorGridLookup(int32_t x, int32_t y)
+{
+	if (grid.numsectors != numsectors)
+		return nullptr;
+
+	int64_t const cx = ((int64_t)x - grid.minx) >> grid.shift;
+	int64_t const cy = ((int64_t)y - grid.miny) >> grid.shift;
+
+	// Sectors may have been moved outside the area covered by the grid.
+	if ((uint64_t)cx >= (uint64_t)grid.sizex || (uint64_t)cy >= (uint64_t)grid.sizey)
+		return nullptr;
+
+	if (grid.dirty.Size())
+		sectorGridUpdate();
+
+	return &grid.cells[(int)cy * grid.sizex + (int)cx];
+}
+
+//==========================================================================
+//
+// Measures lookup performance of the grid against the brute force search
+// on the current map.
+//
+//==========================================================================
+
+CCMD(bench_updatesector)
+{
+	if (numsectors <= 0)
+	{
+		Printf("No map loaded\n");
+		return;
+	}
+
+	int const count = argv.argc() > 1 ? max(1, (int)strtol(argv[1], nullptr, 10)) : 1000000;
+
+	int32_t x1 = INT32_MAX, y1 = INT32_MAX, x2 = INT32_MIN, y2 = INT32_MIN;
+	for (int i = 0; i < numwalls; i++)
+	{
+		x1 = min<int32_t>(x1, wall[i].x);
+		y1 = min<int32_t>(y1, wall[i].y);
+		x2 = max<int32_t>(x2, wall[i].x);
+		y2 = max<int32_t>(y2, wall[i].y);
+	}
+
+	TArray<vec2_t> points(count, true);
+	uint32_t seed = 1;
+	for (auto &p : points)
+	{
+		seed = seed * 1664525 + 1013904223;
+		p.x = x1 + (int32_t)((uint64_t)(seed >> 8) * ((int64_t)x2 - x1 + 1) >> 24);
+		seed = seed * 1664525 + 1013904223;
+		p.y = y1 + (int32_t)((uint64_t)(seed >> 8) * ((int64_t)y2 - y1 + 1) >> 24);
+	}
+
+	cycle_t bruteclock, gridclock;
+	int brutehits = 0, gridhits = 0, mismatches = 0;
+	TArray<int16_t> bruteresults(count, true);
+
+	bruteclock.Reset();
+	bruteclock.Clock();
+	for (int n = 0; n < count; n++)
+	{
+		int found = -1;
+		for (int i = numsectors - 1; i >= 0; --i)
+		{
+			if (inside_p(points[n].x, points[n].y, i))
+			{
+				found = i;
+				break;
+			}
+		}
+		bruteresults[n] = found;
+		brutehits += found >= 0;
+	}
+	bruteclock.Unclock();
+
+	gridclock.Reset();
+	gridclock.Clock();
+	for (int n = 0; n < count; n++)
+	{
+		int16_t sect = -1;
+		updatesector(points[n].x, points[n].y, &sect);
+		gridhits += sect >= 0;
+		mismatches += sect != bruteresults[n];
+	}
+	gridclock.Unclock();
+
+	double const brutetime = max(bruteclock.TimeMS(), 0.001), gridtime = max(gridclock.TimeMS(), 0.001);
+
+	Printf("%d sectors, %d lookups, grid %dx%d cells of %d units\n", numsectors, count, grid.sizex, grid.sizey, 1 << grid.shift);
+	Printf("brute force: %.2f ms, %.0f lookups/s, %d hits\n", brutetime, count * 1000. / brutetime, brutehits);
+	Printf("updatesector: %.2f ms, %.0f lookups/s, %d hits\n", gridtime, count * 1000. / gridtime, gridhits);
+	if (mismatches) Printf(TEXTCOLOR_RED "%d results differ from the brute force search!\n", mismatches);
+}
@@ -15,23 +15,44 @@
 
 #include "palette.h"
 #include "../../glbackend/glbackend.h"
+#include "workerpool.h"
+#include "cmdlib.h"
+#include "i_specialpaths.h"
+#include <zlib.h>
+#include <atomic>
+
+CVARD(Bool, hw_voxelcache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "keep converted voxel models in a cache to speed up loading")
+EXTERN_CVAR(Int, r_precachethreads)
+
+static FWorkerPool voxelpool;
 
 
 //For loading/conversion only
-static vec3_t voxsiz;
-static int32_t yzsiz, *vbit = 0; //vbit: 1 bit per voxel: 0=air,1=solid
-static vec3f_t voxpiv;
+// This state is per thread so that several models can be converted at once.
+static thread_local vec3_t voxsiz;
+static thread_local int32_t yzsiz, *vbit = 0; //vbit: 1 bit per voxel: 0=air,1=solid
+static thread_local vec3f_t voxpiv;
 
-static int32_t *vcolhashead = 0, vcolhashsizm1;
+static thread_local int32_t *vcolhashead = 0, vcolhashsizm1;
 typedef struct { int32_t p, c, n; } voxcol_t;
-static voxcol_t *vcol = 0; int32_t vnum = 0, vmax = 0;
+static thread_local voxcol_t *vcol = 0;
+static thread_local int32_t vnum = 0, vmax = 0;
 
 typedef struct { int16_t x, y; } spoint2d;
-static spoint2d *shp;
-static int32_t *shcntmal, *shcnt = 0, shcntp;
+static thread_local spoint2d *shp;
+static thread_local int32_t *shcntmal, *shcnt = 0, shcntp;
+
+static thread_local int32_t mytexo5, *zbit, gmaxx, gmaxy, garea, pow2m1[33];
+static thread_local voxmodel_t *gvox;
+static thread_local uint32_t voxrandseed;
 
-static int32_t mytexo5, *zbit, gmaxx, gmaxy, garea, pow2m1[33];
-static voxmodel_t *gvox;
+// Replaces rand() for placing the skin rectangles, which is neither thread safe nor
+// repeatable. The result must only depend on the model so that it can be cached.
+static int32_t voxrand(void)
+{
+    voxrandseed = voxrandseed * 1103515245 + 12345;
+    return (voxrandseed >> 16) & 32767;
+}
 
 
 //pitch must equal xsiz*4
@@ -390,6 +411,7 @@ static voxmodel_t *vox2poly()
     shcnt = &shcntmal[-shcntp-1];
 
     gmaxx = gmaxy = garea = 0;
+    voxrandseed = 1;
 
     if (pow2m1[32] != -1)
     {
@@ -517,11 +539,11 @@ skindidntfit:
                 do
                 {
 #if (VOXUSECHAR != 0)
-                    x0 = ((rand()&32767)*(min(gvox->mytexx, 255)-dx))>>15;
-                    y0 = ((rand()&32767)*(min(gvox->mytexy, 255)-dy))>>15;
+                    x0 = (voxrand()*(min(gvox->mytexx, 255)-dx))>>15;
+                    y0 = (voxrand()*(min(gvox->mytexy, 255)-dy))>>15;
 #else
-                    x0 = ((rand()&32767)*(gvox->mytexx+1-dx))>>15;
-                    y0 = ((rand()&32767)*(gvox->mytexy+1-dy))>>15;
+                    x0 = (voxrand()*(gvox->mytexx+1-dx))>>15;
+                    y0 = (voxrand()*(gvox->mytexy+1-dy))>>15;
 #endif
                     i--;
                     if (i < 0) //Time-out! Very slow if this happens... but at least it still works :P
@@ -604,12 +626,8 @@ static void read_pal(FileReader &fil, int32_t pal[256])
     }
 }
 
-static int32_t loadvox(const char *filnam)
+static int32_t loadvox(FileReader &fil)
 {
-	auto fil = fileSystem.OpenFileReader(filnam, 0);
-	if (!fil.isOpen())
-		return -1;
-
     fil.Read(&voxsiz, sizeof(vec3_t));
 #if B_BIG_ENDIAN != 0
     voxsiz.x = B_LITTLE32(voxsiz.x);
@@ -678,14 +696,10 @@ static int32_t loadvox(const char *filnam)
     return 0;
 }
 
-static int32_t loadkvx(const char *filnam)
+static int32_t loadkvx(FileReader &fil)
 {
     int32_t i, mip1leng;
 
-	auto fil = fileSystem.OpenFileReader(filnam, 0);
-	if (!fil.isOpen())
-		return -1;
-
     fil.Read(&mip1leng, 4); mip1leng = B_LITTLE32(mip1leng);
     fil.Read(&voxsiz, sizeof(vec3_t));
 #if B_BIG_ENDIAN != 0
@@ -762,14 +776,10 @@ static int32_t loadkvx(const char *filnam)
     return 0;
 }
 
-static int32_t loadkv6(const char *filnam)
+static int32_t loadkv6(FileReader &fil)
 {
     int32_t i;
 
-    auto fil = fileSystem.OpenFileReader(filnam, 0);
-    if (!fil.isOpen())
-        return -1;
-
     fil.Read(&i, 4);
     if (B_LITTLE32(i) != 0x6c78764b)
     {
@@ -834,6 +844,161 @@ static int32_t loadkv6(const char *filnam)
     return 0;
 }
 
+//---------------------------------------- VOXEL MESH CACHE ----------------------------------------
+
+// The quads and the skin of converted models are stored on disk, keyed on
+// the contents of the voxel file, so that they only need to be generated once.
+
+enum
+{
+    VOXCACHE_VERSION = 1,
+    VOXCACHE_MAXTEXSIZE = 8192,
+};
+
+typedef struct
+{
+    uint32_t crc, size;
+    int32_t format;
+} voxcachekey_t;
+
+#pragma pack(push, 1)
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t crc, size;
+    int32_t format;
+    int32_t qcnt, qfacind[7];
+    int32_t mytexx, mytexy;
+    vec3_t siz;
+    vec3f_t piv;
+    int32_t is8bit;
+    uint32_t datasize;  // compressed size of the quads followed by the skin
+} voxcacheheader_t;
+#pragma pack(pop)
+
+static const FString &voxcache_directory(void)
+{
+    // Thread safe initialization, the first call may come from a worker.
+    static const FString dir = []()
+    {
+        FString path = M_GetAppDataPath(true);
+        path << "voxcache/";
+        CreatePath(path);
+        return path;
+    }();
+    return dir;
+}
+
+static FString voxcache_filename(const voxcachekey_t &key)
+{
+    FString name = voxcache_directory();
+    name.AppendFormat("%08x%08x_%d.vxc", key.crc, key.size, key.format);
+    return name;
+}
+
+static voxmodel_t *voxcache_load(const voxcachekey_t &key)
+{
+    if (!hw_voxelcache)
+        return NULL;
+
+    FileReader fil;
+    if (!fil.OpenFile(voxcache_filename(key)))
+        return NULL;
+
+    voxcacheheader_t header;
+    if (fil.Read(&header, sizeof(header)) != sizeof(header) || memcmp(header.magic, "RVXC", 4) || header.version != VOXCACHE_VERSION)
+        return NULL;
+
+    if (header.crc != key.crc || header.size != key.size || header.format != key.format)
+        return NULL;
+
+    if (header.qcnt < 0 || header.qcnt > (1 << 24) || header.mytexx <= 0 || header.mytexx > VOXCACHE_MAXTEXSIZE ||
+        header.mytexy <= 0 || header.mytexy > VOXCACHE_MAXTEXSIZE)
+        return NULL;
+
+    TArray<uint8_t> compressed = fil.Read(header.datasize);
+    if (compressed.Size() != header.datasize)
+        return NULL;
+
+    const size_t quadsize = header.qcnt*sizeof(voxrect_t);
+    const size_t texsize = header.mytexx*header.mytexy*sizeof(int32_t);
+    TArray<uint8_t> data(quadsize + texsize, true);
+
+    uLongf destlen = data.Size();
+    if (uncompress(data.Data(), &destlen, compressed.Data(), compressed.Size()) != Z_OK || destlen != data.Size())
+        return NULL;
+
+    voxmodel_t *vm = (voxmodel_t *)Xmalloc(sizeof(voxmodel_t));
+    memset(vm, 0, sizeof(voxmodel_t));
+
+    vm->mdnum = 1; //VOXel model id
+    vm->scale = vm->bscale = 1.f;
+    vm->qcnt = header.qcnt;
+    memcpy(vm->qfacind, header.qfacind, sizeof(vm->qfacind));
+    vm->mytexx = header.mytexx;
+    vm->mytexy = header.mytexy;
+    vm->siz = header.siz;
+    vm->piv = header.piv;
+    vm->is8bit = header.is8bit;
+
+    vm->quad = (voxrect_t *)Xmalloc(max<size_t>(quadsize, 1));
+    memcpy(vm->quad, data.Data(), quadsize);
+    vm->mytex = (int32_t *)Xmalloc(texsize);
+    memcpy(vm->mytex, data.Data() + quadsize, texsize);
+
+    return vm;
+}
+
+static void voxcache_store(const voxcachekey_t &key, const voxmodel_t *vm)
+{
+    static std::atomic<int> tempcount;
+
+    if (!hw_voxelcache)
+        return;
+
+    const size_t quadsize = vm->qcnt*sizeof(voxrect_t);
+    const size_t texsize = vm->mytexx*vm->mytexy*sizeof(int32_t);
+    TArray<uint8_t> data(quadsize + texsize, true);
+    memcpy(data.Data(), vm->quad, quadsize);
+    memcpy(data.Data() + quadsize, vm->mytex, texsize);
+
+    uLongf destlen = compressBound(data.Size());
+    TArray<uint8_t> compressed(destlen, true);
+    if (compress2(compressed.Data(), &destlen, data.Data(), data.Size(), 1) != Z_OK)
+        return;
+
+    voxcacheheader_t header;
+    memcpy(header.magic, "RVXC", 4);
+    header.version = VOXCACHE_VERSION;
+    header.crc = key.crc;
+    header.size = key.size;
+    header.format = key.format;
+    header.qcnt = vm->qcnt;
+    memcpy(header.qfacind, vm->qfacind, sizeof(header.qfacind));
+    header.mytexx = vm->mytexx;
+    header.mytexy = vm->mytexy;
+    header.siz = vm->siz;
+    header.piv = vm->piv;
+    header.is8bit = vm->is8bit;
+    header.datasize = (uint32_t)destlen;
+
+    // Identical files may get converted at the same time, so every write needs its own temporary file.
+    FString filename = voxcache_filename(key);
+    FString tempname = filename;
+    tempname.AppendFormat(".%d.tmp", tempcount++);
+
+    FileWriter *fw = FileWriter::Open(tempname);
+    if (!fw)
+        return;
+
+    bool ok = fw->Write(&header, sizeof(header)) == sizeof(header) && fw->Write(compressed.Data(), destlen) == destlen;
+    delete fw;
+
+    if (!ok || rename(tempname, filename) != 0)
+        remove(tempname);
+}
+
 void voxfree(voxmodel_t *m)
 {
     if (!m)
@@ -856,19 +1021,38 @@ void voxfree(voxmodel_t *m)
     Xfree(m);
 }
 
-voxmodel_t *voxload(const char *filnam)
+enum
 {
-    int32_t is8bit, ret;
+    VOXFMT_VOX,
+    VOXFMT_KVX,
+    VOXFMT_KV6,
+};
 
+static int32_t voxformat(const char *filnam)
+{
     const int32_t i = Bstrlen(filnam)-4;
     if (i < 0)
-        return NULL;
+        return -1;
+
+    if (!Bstrcasecmp(&filnam[i], ".vox")) return VOXFMT_VOX;
+    if (!Bstrcasecmp(&filnam[i], ".kvx")) return VOXFMT_KVX;
+    if (!Bstrcasecmp(&filnam[i], ".kv6")) return VOXFMT_KV6;
+    //if (!Bstrcasecmp(&filnam[i],".vxl")) return VOXFMT_VXL;
+    return -1;
+}
 
-    if (!Bstrcasecmp(&filnam[i], ".vox")) { ret = loadvox(filnam); is8bit = 1; }
-    else if (!Bstrcasecmp(&filnam[i], ".kvx")) { ret = loadkvx(filnam); is8bit = 1; }
-    else if (!Bstrcasecmp(&filnam[i], ".kv6")) { ret = loadkv6(filnam); is8bit = 0; }
-    //else if (!Bstrcasecmp(&filnam[i],".vxl")) { ret = loadvxl(filnam); is8bit = 0; }
-    else return NULL;
+// Does not touch the file system so this can run on worker threads.
+static voxmodel_t *voxconvert(FileReader &fil, int32_t format)
+{
+    int32_t is8bit, ret;
+
+    switch (format)
+    {
+    case VOXFMT_VOX: ret = loadvox(fil); is8bit = 1; break;
+    case VOXFMT_KVX: ret = loadkvx(fil); is8bit = 1; break;
+    case VOXFMT_KV6: ret = loadkv6(fil); is8bit = 0; break;
+    default: return NULL;
+    }
 
     voxmodel_t *const vm = (ret >= 0) ? vox2poly() : NULL;
 
@@ -891,6 +1075,71 @@ voxmodel_t *voxload(const char *filnam)
     return vm;
 }
 
+static voxmodel_t *voxloadfromdata(const TArray<uint8_t> &data, int32_t format)
+{
+    voxcachekey_t key = { (uint32_t)crc32(0, data.Data(), data.Size()), data.Size(), format };
+
+    voxmodel_t *vm = voxcache_load(key);
+    if (vm)
+        return vm;
+
+    FileReader fil;
+    fil.OpenMemory(data.Data(), data.Size());
+    vm = voxconvert(fil, format);
+
+    if (vm)
+        voxcache_store(key, vm);
+
+    return vm;
+}
+
+voxmodel_t *voxload(const char *filnam)
+{
+    const int32_t format = voxformat(filnam);
+    if (format < 0)
+        return NULL;
+
+    auto fil = fileSystem.OpenFileReader(filnam, 0);
+    if (!fil.isOpen())
+        return NULL;
+
+    return voxloadfromdata(fil.Read(), format);
+}
+
+// Loads a list of voxel models, converting them on worker threads. Only the
+// file system access happens on the calling thread.
+void voxloadmultiple(const char *const *filenames, voxmodel_t **models, int32_t count)
+{
+    TArray<TArray<uint8_t>> data;
+    TArray<int32_t> formats, indices;
+
+    for (bssize_t i=0; i<count; i++)
+    {
+        if (!filenames[i])
+            continue;
+
+        models[i] = NULL;
+
+        const int32_t format = voxformat(filenames[i]);
+        if (format < 0)
+            continue;
+
+        auto fil = fileSystem.OpenFileReader(filenames[i], 0);
+        if (!fil.isOpen())
+            continue;
+
+        data.Push(fil.Read());
+        formats.Push(format);
+        indices.Push(i);
+    }
+
+    voxelpool.SetNumThreads(I_GetWorkerThreadCount(r_precachethreads));
+    voxelpool.Run(indices.Size(), [&](int j)
+    {
+        models[indices[j]] = voxloadfromdata(data[j], formats[j]);
+    });
+}
+
 voxmodel_t *loadkvxfrombuf(const char *kvxbuffer, int32_t length)
 {
     int32_t i, mip1leng;
@@ -1003,8 +1252,44 @@ voxmodel_t *loadkvxfrombuf(const char *kvxbuffer, int32_t length)
     return vm;
 }
 
+static void voxvertices(const voxmodel_t *m, FFlatVertex *vt)
+{
+    const float ru = 1.f/((float)m->mytexx);
+    const float rv = 1.f/((float)m->mytexy);
+#if (VOXBORDWIDTH == 0)
+    float uhack[2], vhack[2];
+    uhack[0] = ru*.125; uhack[1] = -uhack[0];
+    vhack[0] = rv*.125; vhack[1] = -vhack[0];
+#endif
+    const float phack[2] = { 0, 1.f/256.f };
+
+    for (bssize_t i=0; i<m->qcnt; i++)
+    {
+        const vert_t *const vptr = &m->quad[i].v[0];
+
+        const int32_t xx = vptr[0].x + vptr[2].x;
+        const int32_t yy = vptr[0].y + vptr[2].y;
+        const int32_t zz = vptr[0].z + vptr[2].z;
+
+        for (bssize_t jj=0; jj<6; jj++, vt++)
+        {
+            static const uint8_t trix[] = { 0, 1, 2, 0, 2, 3 };
+            int j = trix[jj];
+#if (VOXBORDWIDTH == 0)
+			vt->SetTexCoord(((float)vptr[j].u)*ru + uhack[vptr[j].u!=vptr[0].u],
+                          ((float)vptr[j].v)*rv + vhack[vptr[j].v!=vptr[0].v]);
+#else
+            vt->SetTexCoord(((float)vptr[j].u)*ru, ((float)vptr[j].v)*rv);
+#endif
+            vt->SetVertex(
+                ((float)vptr[j].x) - phack[xx > vptr[j].x * 2] + phack[xx < vptr[j].x * 2],
+                ((float)vptr[j].y) - phack[yy > vptr[j].y * 2] + phack[yy < vptr[j].y * 2],
+                ((float)vptr[j].z) - phack[zz > vptr[j].z * 2] + phack[zz < vptr[j].z * 2]);
+        }
+    }
+}
+
 //Draw voxel model as perfect cubes
-// Note: This is a hopeless mess that totally forfeits any chance of using a vertex buffer with its messy coordinate adjustments. :(
 int32_t polymost_voxdraw(voxmodel_t *m, tspriteptr_t const tspr)
 {
     // float clut[6] = {1.02,1.02,0.94,1.06,0.98,0.98};
@@ -1125,14 +1410,6 @@ int32_t polymost_voxdraw(voxmodel_t *m, tspriteptr_t const tspr)
 
 	int matrixindex = GLInterface.SetMatrix(Matrix_Model, mat);
 
-    const float ru = 1.f/((float)m->mytexx);
-    const float rv = 1.f/((float)m->mytexy);
-#if (VOXBORDWIDTH == 0)
-    uhack[0] = ru*.125; uhack[1] = -uhack[0];
-    vhack[0] = rv*.125; vhack[1] = -vhack[0];
-#endif
-    const float phack[2] = { 0, 1.f/256.f };
-
     int prevClamp = GLInterface.GetClamp();
 	GLInterface.SetClamp(0);
 #if 1
@@ -1158,50 +1435,30 @@ int32_t polymost_voxdraw(voxmodel_t *m, tspriteptr_t const tspr)
 	GLInterface.UseDetailMapping(false);
 #endif
 
-	auto data = screen->mVertexData->AllocVertices(m->qcnt * 6);
-	auto vt = data.first;
-
-	int qstart = data.second;
-	int qdone = 0;
-    for (bssize_t i=0, fi=0; i<m->qcnt; i++)
+    // The vertices only depend on the model, so they are kept in the static part of the vertex buffer.
+    auto vertexdata = screen->mVertexData;
+    if (m->vbserial != vertexdata->StaticSerial())
     {
-        if (i == m->qfacind[fi])
+        auto data = vertexdata->AllocStaticVertices(m->qcnt * 6);
+        if (data.first)
         {
-            f = 1 /*clut[fi++]*/;
-			if (qdone > 0)
-			{
-				GLInterface.Draw(DT_TRIANGLES, qstart, qdone * 6);
-				qstart += qdone * 6;
-				qdone = 0;
-			}
-            GLInterface.SetColor(pc[0]*f, pc[1]*f, pc[2]*f, pc[3]*f);
+            voxvertices(m, data.first);
+            m->vbindex = data.second;
+            m->vbserial = vertexdata->StaticSerial();
         }
+    }
 
-        const vert_t *const vptr = &m->quad[i].v[0];
-
-        const int32_t xx = vptr[0].x + vptr[2].x;
-        const int32_t yy = vptr[0].y + vptr[2].y;
-        const int32_t zz = vptr[0].z + vptr[2].z;
-
-        for (bssize_t jj=0; jj<6; jj++, vt++)
-        {
-            static uint8_t trix[] = { 0, 1, 2, 0, 2, 3 };
-            int j = trix[jj];
-#if (VOXBORDWIDTH == 0)
-			vt->SetTexCoord(((float)vptr[j].u)*ru + uhack[vptr[j].u!=vptr[0].u],
-                          ((float)vptr[j].v)*rv + vhack[vptr[j].v!=vptr[0].v]);
-#else
-            vt->SetTexCoord(((float)vptr[j].u)*ru, ((float)vptr[j].v)*rv);
-#endif
-            vt->SetVertex(
-                ((float)vptr[j].x) - phack[xx > vptr[j].x * 2] + phack[xx < vptr[j].x * 2],
-                ((float)vptr[j].y) - phack[yy > vptr[j].y * 2] + phack[yy < vptr[j].y * 2],
-                ((float)vptr[j].z) - phack[zz > vptr[j].z * 2] + phack[zz < vptr[j].z * 2]);
-        }
-		qdone++;
+    unsigned int vbindex = m->vbindex;
+    if (m->vbserial != vertexdata->StaticSerial())
+    {
+        // Out of static space, so this needs to be streamed every frame.
+        auto data = vertexdata->AllocVertices(m->qcnt * 6);
+        voxvertices(m, data.first);
+        vbindex = data.second;
     }
 
-	GLInterface.Draw(DT_TRIANGLES, qstart, qdone * 6);
+    GLInterface.SetColor(pc[0], pc[1], pc[2], pc[3]);
+	GLInterface.Draw(DT_TRIANGLES, vbindex, m->qcnt * 6);
 	GLInterface.SetClamp(prevClamp);
     //------------
 	GLInterface.SetCull(Cull_None);
@@ -8,11 +8,21 @@
 
 class CompositeSavegameWriter
 {
+	// Raw image data that only gets PNG encoded by WriteToFile.
+	struct PendingImage
+	{
+		unsigned index;
+		TArray<uint8_t> pixels;	// bottom-up RGB
+		int width, height;
+		float gamma;
+	};
+
 	FString filename;
 	TDeletingArray<BufferWriter*> subfiles;
 	TArray<FCompressedBuffer> subbuffers;
 	TArray<FString> subfilenames;
 	TArray<bool> isCompressed;
+	TArray<PendingImage> images;
 
 	FCompressedBuffer CompressElement(BufferWriter* element, bool compress);
 public:
@@ -23,8 +33,18 @@ public:
 		subfilenames.Clear();
 		subfiles.DeleteAndClear();
 		subbuffers.Clear();
+		images.Clear();
 		filename = "";
 	}
+	void Swap(CompositeSavegameWriter &other)
+	{
+		filename.Swap(other.filename);
+		subfiles.Swap(other.subfiles);
+		subbuffers.Swap(other.subbuffers);
+		subfilenames.Swap(other.subfilenames);
+		isCompressed.Swap(other.isCompressed);
+		images.Swap(other.images);
+	}
 	void SetFileName(const char* fn)
 	{
 		filename = fn;
@@ -33,12 +53,17 @@ public:
 	{
 		filename = fn;
 	}
+	const FString &GetFileName() const
+	{
+		return filename;
+	}
 	~CompositeSavegameWriter()
 	{
 		assert(subfiles.Size() == 0);	// must be written out.
 	}
 	FileWriter& NewElement(const char* filename, bool compress = true);
 	void AddCompressedElement(const char* filename, FCompressedBuffer& buffer);
+	void AddImageElement(const char* filename, TArray<uint8_t>& pixels, int width, int height, float gamma);
 	bool WriteToFile();
 };
 
@@ -64,6 +64,18 @@ void CompositeSavegameWriter::AddCompressedElement(const char* filename, FCompre
 	isCompressed.Push(true);
 }
 
+void CompositeSavegameWriter::AddImageElement(const char* filename, TArray<uint8_t>& pixels, int width, int height, float gamma)
+{
+	// The PNG is already compressed, so don't do it a second time.
+	NewElement(filename, false);
+	auto &image = images[images.Reserve(1)];
+	image.index = subfiles.Size() - 1;
+	image.pixels = std::move(pixels);
+	image.width = width;
+	image.height = height;
+	image.gamma = gamma;
+}
+
 FCompressedBuffer CompositeSavegameWriter::CompressElement(BufferWriter *bw, bool compress)
 {
 	FCompressedBuffer buff;
@@ -125,6 +137,14 @@ error:
 bool CompositeSavegameWriter::WriteToFile()
 {
 	if (subfiles.Size() == 0) return false;
+
+	for (auto &image : images)
+	{
+		auto file = subfiles[image.index];
+		M_CreatePNG(file, &image.pixels[(image.height - 1) * image.width * 3], nullptr, SS_RGB, image.width, image.height, -image.width * 3, image.gamma);
+		M_FinishPNG(file);
+	}
+
 	TArray<FCompressedBuffer> compressed(subfiles.Size(), 1);
 	for (unsigned i = 0; i < subfiles.Size(); i++)
 	{
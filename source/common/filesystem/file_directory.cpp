@@ -58,6 +58,7 @@ struct FDirectoryLump : public FResourceLump
 {
 	virtual FileReader NewReader() override;
 	int ValidateCache() override;
+	const char *GetDiskFileName() override { return mFullPath; }
 
 	FString mFullPath;
 };
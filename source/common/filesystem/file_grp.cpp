@@ -34,6 +34,7 @@
 */
 
 #include "resourcefile.h"
+#include "file_index.h"
 #include "printf.h"
 
 //==========================================================================
@@ -73,6 +74,7 @@ class FGrpFile : public FUncompressedFile
 public:
 	FGrpFile(const char * filename, FileReader &file);
 	bool Open(bool quiet);
+	bool GetIndexedLump(uint32_t no, FIndexedLump &entry) override;
 };
 
 
@@ -96,6 +98,20 @@ FGrpFile::FGrpFile(const char *filename, FileReader &file)
 bool FGrpFile::Open(bool quiet)
 {
 	GrpInfo header;
+	FArchiveIndex index;
+
+	if (index.Open(FileName, Reader))
+	{
+		NumLumps = index.LumpCount();
+		Lumps.Resize(NumLumps);
+		for (uint32_t i = 0; i < NumLumps; i++)
+		{
+			Lumps[i].Position = index.SetupLump(i, &Lumps[i], this).Position;
+		}
+		Indexed = true;
+		if (!quiet) Printf(", %d lumps\n", NumLumps);
+		return true;
+	}
 
 	Reader.Read(&header, sizeof(header));
 	NumLumps = LittleLong(header.NumLumps);
@@ -122,6 +138,18 @@ bool FGrpFile::Open(bool quiet)
 	return true;
 }
 
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+bool FGrpFile::GetIndexedLump(uint32_t no, FIndexedLump &entry)
+{
+	entry.Position = Lumps[no].Position;
+	return true;
+}
+
 
 //==========================================================================
 //
@@ -0,0 +1,259 @@
+/*
+** file_index.cpp
+**
+** Caches the lump tables of resource archives
+**
+**---------------------------------------------------------------------------
+**
+** The index files are stored in the appdata directory, one per archive,
+** and contain the lump table as the archive's Open function leaves it,
+** i.e. sorted and with the lump filter applied. Loading one only needs the
+** lump names to be converted to FNames again.
+**
+*/
+
+#include <time.h>
+#include "file_index.h"
+#include "cmdlib.h"
+#include "printf.h"
+#include "c_cvars.h"
+#include "c_dispatch.h"
+#include "m_crc32.h"
+#include "i_specialpaths.h"
+#include "i_system.h"
+#include "gamecontrol.h"
+
+CVARD(Bool, fs_index, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "cache the lump tables of resource archives to speed up startup")
+
+enum
+{
+	INDEX_VERSION = 1,
+};
+
+struct FIndexHeader
+{
+	char Magic[4];
+	uint32_t Version;
+	uint64_t FileSize;
+	int64_t FileTime;
+	uint32_t NumLumps;
+	uint32_t NamesSize;		// the name block follows the lump table.
+	uint32_t PathLength;	// the archive's path and the lump filter are the first two strings in the name block.
+	uint32_t FilterLength;
+};
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static const FString &Index_Directory()
+{
+	static const FString dir = []()
+	{
+		FString path = M_GetAppDataPath(true);
+		path << "fileindex/";
+		CreatePath(path);
+		return path;
+	}();
+	return dir;
+}
+
+static FString Index_FileName(const char *archivename)
+{
+	FString name = Index_Directory();
+	name.AppendFormat("%08x.idx", (unsigned)crc32(0, (const uint8_t *)archivename, (unsigned)strlen(archivename)));
+	return name;
+}
+
+//==========================================================================
+//
+// Only plain files are indexed. Archives inside other archives or readers
+// that only cover a part of a file have nothing to validate the index with.
+//
+//==========================================================================
+
+static bool Index_GetFileInfo(const char *archivename, FileReader &archive, size_t &size, time_t &time)
+{
+	if (!GetFileInfo(archivename, &size, &time)) return false;
+	return archive.isOpen() && (size_t)archive.GetLength() == size;
+}
+
+//==========================================================================
+//
+// Maps the index file and checks that it belongs to this archive.
+//
+//==========================================================================
+
+bool FArchiveIndex::Open(const char *archivename, FileReader &archive)
+{
+	size_t filesize;
+	time_t filetime;
+
+	if (!fs_index || !Index_GetFileInfo(archivename, archive, filesize, filetime)) return false;
+
+	FString filename = Index_FileName(archivename);
+	const uint8_t *data;
+	size_t length;
+
+	if (Reader.OpenMappedFile(filename))
+	{
+		data = (const uint8_t *)Reader.GetBuffer();
+		length = Reader.GetLength();
+	}
+	else if (Reader.OpenFile(filename))
+	{
+		Buffer = Reader.Read();
+		data = Buffer.Data();
+		length = Buffer.Size();
+	}
+	else return false;
+
+	if (length < sizeof(FIndexHeader)) return false;
+
+	auto header = (const FIndexHeader *)data;
+	if (memcmp(header->Magic, "RIDX", 4) || header->Version != INDEX_VERSION) return false;
+	if (header->FileSize != filesize || header->FileTime != (int64_t)filetime) return false;
+
+	uint64_t tablesize = (uint64_t)header->NumLumps * sizeof(FIndexedLump);
+	if (sizeof(FIndexHeader) + tablesize + header->NamesSize != length) return false;
+	if (header->NamesSize == 0 || (uint64_t)header->PathLength + header->FilterLength + 2 > header->NamesSize) return false;
+
+	auto names = (const char *)data + sizeof(FIndexHeader) + tablesize;
+	if (names[header->NamesSize - 1] != 0) return false;	// makes sure that every name is terminated.
+
+	// The path is checked to rule out crc collisions, the filter decides which lumps are in the table.
+	const char *path = names;
+	const char *filter = names + header->PathLength + 1;
+	if (strlen(path) != header->PathLength || strcmp(path, archivename)) return false;
+	if (strlen(filter) != header->FilterLength || LumpFilter.Compare(filter)) return false;
+
+	auto entries = (const FIndexedLump *)(data + sizeof(FIndexHeader));
+	for (uint32_t i = 0; i < header->NumLumps; i++)
+	{
+		if (entries[i].NameOffset != FIndexedLump::NO_NAME && entries[i].NameOffset >= header->NamesSize) return false;
+	}
+
+	Entries = entries;
+	Names = names;
+	NumLumps = header->NumLumps;
+	return true;
+}
+
+//==========================================================================
+//
+// Sets up the fields all lump types share and returns the entry so that
+// the archive can set up the rest.
+//
+//==========================================================================
+
+const FIndexedLump &FArchiveIndex::SetupLump(uint32_t no, FResourceLump *lump, FResourceFile *owner) const
+{
+	auto &entry = Entries[no];
+	lump->Owner = owner;
+	lump->LumpSize = entry.LumpSize;
+	lump->Flags = entry.Flags;
+	lump->ResourceId = entry.ResourceId;
+	if (entry.NameOffset != FIndexedLump::NO_NAME) lump->LumpNameSetup(Names + entry.NameOffset);
+	return entry;
+}
+
+//==========================================================================
+//
+// Writes the index for an archive that just got opened. This must be
+// done before anything accesses the lumps, because some archive types
+// update their lumps on first access.
+//
+//==========================================================================
+
+void FArchiveIndex::Write(FResourceFile *resfile)
+{
+	size_t filesize;
+	time_t filetime;
+
+	if (!fs_index || resfile->IsIndexed() || !Index_GetFileInfo(resfile->FileName, resfile->Reader, filesize, filetime)) return;
+
+	TArray<FIndexedLump> entries(resfile->LumpCount(), true);
+	TArray<char> names;
+
+	auto addstring = [&](const char *str)
+	{
+		unsigned len = (unsigned)strlen(str) + 1;
+		unsigned ofs = names.Reserve(len);
+		memcpy(&names[ofs], str, len);
+		return ofs;
+	};
+	addstring(resfile->FileName);
+	addstring(LumpFilter);
+
+	for (uint32_t i = 0; i < resfile->LumpCount(); i++)
+	{
+		auto lump = resfile->GetLump(i);
+		auto &entry = entries[i];
+
+		memset(&entry, 0, sizeof(entry));
+		if (!resfile->GetIndexedLump(i, entry)) return;	// this archive type cannot be indexed.
+
+		entry.LumpSize = lump->LumpSize;
+		entry.Flags = lump->Flags;
+		entry.ResourceId = lump->ResourceId;
+		entry.NameOffset = lump->LumpName[FResourceLump::FullNameType] == NAME_None ? (uint32_t)FIndexedLump::NO_NAME : addstring(lump->FullName());
+	}
+
+	FIndexHeader header;
+	memcpy(header.Magic, "RIDX", 4);
+	header.Version = INDEX_VERSION;
+	header.FileSize = filesize;
+	header.FileTime = filetime;
+	header.NumLumps = entries.Size();
+	header.NamesSize = names.Size();
+	header.PathLength = (uint32_t)resfile->FileName.Len();
+	header.FilterLength = (uint32_t)LumpFilter.Len();
+
+	// Write under a temporary name so that an interrupted write never leaves a file with the right name behind.
+	FString filename = Index_FileName(resfile->FileName);
+	FString tempname = filename + ".tmp";
+	FileWriter *fw = FileWriter::Open(tempname);
+	if (fw == nullptr) return;
+
+	size_t tablesize = entries.Size() * sizeof(FIndexedLump);
+	bool ok = fw->Write(&header, sizeof(header)) == sizeof(header) &&
+		fw->Write(entries.Data(), tablesize) == tablesize &&
+		fw->Write(names.Data(), names.Size()) == names.Size();
+	delete fw;
+
+	remove(filename);	// rename does not replace existing files on Windows.
+	if (!ok || rename(tempname, filename) != 0)
+	{
+		remove(tempname);
+	}
+}
+
+//==========================================================================
+//
+// Deletes all index files.
+//
+//==========================================================================
+
+CCMD(fs_clearindex)
+{
+	FString pattern = Index_Directory() + "*.idx";
+	findstate_t findstate;
+	void *handle = I_FindFirst(pattern, &findstate);
+	int count = 0;
+
+	if (handle != (void *)-1)
+	{
+		do
+		{
+			if (!(I_FindAttr(&findstate) & FA_DIREC))
+			{
+				FString filename = Index_Directory() + I_FindName(&findstate);
+				if (remove(filename) == 0) count++;
+			}
+		} while (I_FindNext(handle, &findstate) == 0);
+		I_FindClose(handle);
+	}
+	Printf("%d archive index files deleted\n", count);
+}
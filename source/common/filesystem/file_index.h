@@ -0,0 +1,51 @@
+#ifndef __FILE_INDEX_H
+#define __FILE_INDEX_H
+
+#include "resourcefile.h"
+
+//==========================================================================
+//
+// Serialized lump table of an archive
+//
+// Archives opened by the file system get their lump table written to a
+// file of its own, so that the next start can set up the lumps without
+// reading and parsing the archive's directory again. The index is only
+// used if the archive still has the same path, size and modification time
+// and the lump filter is the same.
+//
+//==========================================================================
+
+struct FIndexedLump
+{
+	uint32_t	NameOffset;		// into the name block, NO_NAME for lumps that were filtered out.
+	uint32_t	LumpSize;
+	int32_t		Flags;
+	int32_t		ResourceId;
+	int32_t		Position;
+	// Only used by Zips
+	int32_t		CompressedSize;
+	uint32_t	CRC32;
+	uint16_t	GPFlags;
+	uint8_t		Method;
+	uint8_t		Padding;
+
+	enum { NO_NAME = 0xffffffff };
+};
+
+class FArchiveIndex
+{
+	FileReader Reader;
+	TArray<uint8_t> Buffer;		// only used if the index could not be mapped.
+	const FIndexedLump *Entries = nullptr;
+	const char *Names = nullptr;
+	uint32_t NumLumps = 0;
+
+public:
+	bool Open(const char *archivename, FileReader &archive);
+	uint32_t LumpCount() const { return NumLumps; }
+	const FIndexedLump &SetupLump(uint32_t no, FResourceLump *lump, FResourceFile *owner) const;
+
+	static void Write(FResourceFile *resfile);
+};
+
+#endif
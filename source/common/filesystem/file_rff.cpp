@@ -34,6 +34,7 @@
 */
 #include <algorithm>
 #include "resourcefile.h"
+#include "file_index.h"
 #include "printf.h"
 
 //==========================================================================
@@ -74,6 +75,7 @@ struct FRFFLump : public FUncompressedLump
 {
 	virtual FileReader *GetReader() override;
 	int ValidateCache() override;
+	void *GetMappedData() override;
 
 	uint32_t		IndexNum;
 };
@@ -109,6 +111,7 @@ public:
 	FRFFFile(const char * filename, FileReader &file);
 	virtual bool Open(bool quiet);
 	virtual FResourceLump *GetLump(int no) { return ((unsigned)no < NumLumps)? &Lumps[no] : NULL; }
+	bool GetIndexedLump(uint32_t no, FIndexedLump &entry) override;
 };
 
 
@@ -133,6 +136,20 @@ bool FRFFFile::Open(bool quiet)
 {
 	RFFLump *lumps;
 	RFFInfo header;
+	FArchiveIndex index;
+
+	if (index.Open(FileName, Reader))
+	{
+		NumLumps = index.LumpCount();
+		Lumps.Resize(NumLumps);
+		for (uint32_t i = 0; i < NumLumps; i++)
+		{
+			Lumps[i].Position = index.SetupLump(i, &Lumps[i], this).Position;
+		}
+		Indexed = true;
+		if (!quiet) Printf(", %d lumps\n", NumLumps);
+		return true;
+	}
 
 	Reader.Read(&header, sizeof(header));
 
@@ -176,6 +193,18 @@ bool FRFFFile::Open(bool quiet)
 	return true;
 }
 
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+bool FRFFFile::GetIndexedLump(uint32_t no, FIndexedLump &entry)
+{
+	entry.Position = Lumps[no].Position;
+	return true;
+}
+
 
 //==========================================================================
 //
@@ -221,6 +250,18 @@ int FRFFLump::ValidateCache()
 }
 
 
+//==========================================================================
+//
+// Encrypted lumps must be decrypted into the cache
+//
+//==========================================================================
+
+void *FRFFLump::GetMappedData()
+{
+	if (Flags & LUMPF_BLOODCRYPT) return nullptr;
+	return FUncompressedLump::GetMappedData();
+}
+
 //==========================================================================
 //
 // File open
@@ -37,6 +37,7 @@
 #include <algorithm>
 #include "printf.h"
 #include "file_zip.h"
+#include "file_index.h"
 #include "ancientzip.h"
 #include "templates.h"
 //#include "v_text.h"
@@ -176,9 +177,29 @@ bool FZipFile::Open(bool quiet)
 	uint32_t centraldir = Zip_FindCentralDir(Reader);
 	FZipEndOfCentralDirectory info;
 	int skipped = 0;
+	FArchiveIndex index;
 
 	Lumps = NULL;
 
+	// The index contains the lumps already sorted and filtered, so PostProcessArchive must not run again.
+	if (index.Open(FileName, Reader))
+	{
+		NumLumps = index.LumpCount();
+		Lumps = new FZipLump[NumLumps];
+		for (uint32_t i = 0; i < NumLumps; i++)
+		{
+			auto &entry = index.SetupLump(i, &Lumps[i], this);
+			Lumps[i].Method = entry.Method;
+			Lumps[i].GPFlags = entry.GPFlags;
+			Lumps[i].CRC32 = entry.CRC32;
+			Lumps[i].CompressedSize = entry.CompressedSize;
+			Lumps[i].Position = entry.Position;
+		}
+		Indexed = true;
+		if (!quiet) Printf(", %d lumps\n", NumLumps);
+		return true;
+	}
+
 	if (centraldir == 0)
 	{
 		if (!quiet) Printf("\n%s: ZIP file corrupt!\n", FileName.GetChars());
@@ -296,6 +317,25 @@ FZipFile::~FZipFile()
 	if (Lumps != NULL) delete [] Lumps;
 }
 
+//==========================================================================
+//
+// Lumps that have been accessed already have their position moved past
+// the local file header, so this must be called before any access.
+//
+//==========================================================================
+
+bool FZipFile::GetIndexedLump(uint32_t no, FIndexedLump &entry)
+{
+	auto &lump = Lumps[no];
+	if (!(lump.Flags & LUMPFZIP_NEEDFILESTART)) return false;
+	entry.Method = lump.Method;
+	entry.GPFlags = lump.GPFlags;
+	entry.CRC32 = lump.CRC32;
+	entry.CompressedSize = lump.CompressedSize;
+	entry.Position = lump.Position;
+	return true;
+}
+
 //==========================================================================
 //
 //
@@ -367,6 +407,21 @@ int FZipLump::ValidateCache()
 	return 1;
 }
 
+//==========================================================================
+//
+// Stored lumps in a memory mapped archive can be used without copying
+//
+//==========================================================================
+
+void *FZipLump::GetMappedData()
+{
+	auto &reader = Owner->Reader;
+	if (Method != METHOD_STORED || !reader.isOpen() || !reader.IsMapped()) return nullptr;
+	if (Flags & LUMPFZIP_NEEDFILESTART) SetLumpAddress();
+	if (Position < 0 || (int64_t)Position + LumpSize > (int64_t)reader.GetLength()) return nullptr;
+	return (void*)(reader.GetBuffer() + Position);
+}
+
 //==========================================================================
 //
 //
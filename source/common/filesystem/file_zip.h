@@ -24,6 +24,7 @@ struct FZipLump : public FResourceLump
 
 	virtual FileReader *GetReader() override;
 	virtual int ValidateCache() override;
+	virtual void *GetMappedData() override;
 
 private:
 	void SetLumpAddress();
@@ -47,6 +48,7 @@ public:
 	virtual ~FZipFile();
 	bool Open(bool quiet);
 	virtual FResourceLump *GetLump(int no) { return ((unsigned)no < NumLumps)? &Lumps[no] : NULL; }
+	bool GetIndexedLump(uint32_t no, FIndexedLump &entry) override;
 };
 
 
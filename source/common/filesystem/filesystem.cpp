@@ -47,8 +47,10 @@
 //#include "c_dispatch.h"
 #include "filesystem.h"
 #include "resourcefile.h"
+#include "file_index.h"
 #include "v_text.h"
 #include "c_dispatch.h"
+#include "c_cvars.h"
 //#include "md5.h"
 //#include "doomstat.h"
 
@@ -64,6 +66,8 @@ static void PrintLastError ();
 
 FileSystem fileSystem;
 
+CVARD(Bool, fs_mmap, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "map resource archives into memory so that uncompressed files can be used without copying them. Takes effect on restart")
+
 // CODE --------------------------------------------------------------------
 
 
@@ -205,7 +209,8 @@ void FileSystem::AddFile (const char *filename, FileReader *filer, bool nosubdir
 
 		if (!isdir)
 		{
-			if (!fr.OpenFile(filename))
+			// Mapping can fail for reasons like lack of address space, so fall back to regular file access if it does.
+			if (!(fs_mmap && fr.OpenMappedFile(filename)) && !fr.OpenFile(filename))
 			{ // Didn't find file
 				Printf ("%s: File not found\n", filename);
 				PrintLastError ();
@@ -229,6 +234,9 @@ void FileSystem::AddFile (const char *filename, FileReader *filer, bool nosubdir
 	{
 		uint32_t lumpstart = FileInfo.Size();
 
+		// Only files on disk get indexed, and this must happen before any lump is accessed.
+		if (!isdir && filer == nullptr) FArchiveIndex::Write(resfile);
+
 		resfile->SetFirstLump(lumpstart);
 		for (uint32_t i=0; i < resfile->LumpCount(); i++)
 		{
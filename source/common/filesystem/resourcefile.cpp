@@ -154,6 +154,13 @@ void *FResourceLump::Lock()
 	}
 	else if (LumpSize > 0)
 	{
+		// Lumps inside a mapped archive never get cached, they are used right where they are.
+		auto mapped = GetMappedData();
+		if (mapped != nullptr)
+		{
+			RefCount++;
+			return mapped;
+		}
 		ValidateCache();
 		// NBlood has some endian conversion right in here which is extremely dangerous and needs to be handled differently.
 		// Fortunately Big Endian platforms are mostly irrelevant so this is something to be sorted out later (if ever)
@@ -172,6 +179,8 @@ void *FResourceLump::Get()
 {
 	if (Cache.Size() == 0)
 	{
+		auto mapped = LumpSize > 0 ? GetMappedData() : nullptr;
+		if (mapped != nullptr) return mapped;
 		ValidateCache();
 	}
 	return Cache.Data();
@@ -521,6 +530,21 @@ int FUncompressedLump::ValidateCache()
 	return 1;
 }
 
+//==========================================================================
+//
+// Returns a pointer to the lump's data if the archive is memory mapped
+//
+//==========================================================================
+
+void *FUncompressedLump::GetMappedData()
+{
+	auto &reader = Owner->Reader;
+	if (!reader.isOpen() || !reader.IsMapped()) return nullptr;
+	// Truncated archives need to go through the regular path, which reads what's there.
+	if (Position < 0 || (int64_t)Position + LumpSize > (int64_t)reader.GetLength()) return nullptr;
+	return (void*)(reader.GetBuffer() + Position);
+}
+
 //==========================================================================
 //
 // Base class for uncompressed resource files
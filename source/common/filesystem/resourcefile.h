@@ -10,6 +10,7 @@
 
 class FResourceFile;
 class FTexture;
+struct FIndexedLump;
 
 enum ELumpFlags
 {
@@ -73,6 +74,7 @@ struct FResourceLump
 	virtual FileReader *GetReader();
 	virtual FileReader NewReader();
 	virtual int GetFileOffset() { return -1; }
+	virtual const char *GetDiskFileName() { return nullptr; }	// returns the path of the lump's own file if it is not inside an archive.
 	void LumpNameSetup(FString iname);
 	virtual FCompressedBuffer GetRawData();
 
@@ -89,6 +91,7 @@ struct FResourceLump
 
 protected:
 	virtual int ValidateCache() { return -1; }
+	virtual void *GetMappedData() { return nullptr; }	// returns the lump's data inside a memory mapped archive, if possible.
 
 };
 
@@ -102,6 +105,7 @@ public:
 	FString FileName;
 protected:
 	uint32_t NumLumps;
+	bool Indexed = false;	// the lump table was read from the archive index.
 
 	FResourceFile(const char *filename);
 	FResourceFile(const char *filename, FileReader &r);
@@ -127,7 +131,9 @@ public:
 	uint32_t LumpCount() const { return NumLumps; }
 	uint32_t GetFirstLump() const { return FirstLump; }
 	void SetFirstLump(uint32_t f) { FirstLump = f; }
-
+	bool IsIndexed() const { return Indexed; }
+	// Fills in the archive specific parts of an index entry. Archives that cannot be indexed return false.
+	virtual bool GetIndexedLump(uint32_t no, FIndexedLump &entry) { return false; }
 
 
 	virtual bool Open(bool quiet) = 0;
@@ -141,6 +147,7 @@ struct FUncompressedLump : public FResourceLump
 
 	FileReader *GetReader() override;
 	int ValidateCache() override;
+	void *GetMappedData() override;
 	virtual int GetFileOffset() override { return Position; }
 
 };
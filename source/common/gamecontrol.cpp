@@ -41,6 +41,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "i_specialpaths.h"
 #include "z_music.h"
 #include "statistics.h"
+#include "timedemo.h"
 #include "menu.h"
 #include "gstrings.h"
 #include "quotemgr.h"
@@ -214,6 +215,18 @@ void UserConfig::ProcessOptions()
 	Args->CollectFiles("-demo", demos, ".dmo");
 	CommandDemo = Args->CheckValue("-demo");
 
+	if ((v = Args->CheckValue("-timedemo")))
+	{
+		CommandDemo = v;
+		timedemo = TIMEDEMO_RENDER;
+	}
+	else if ((v = Args->CheckValue("-benchdemo")))
+	{
+		CommandDemo = v;
+		timedemo = TIMEDEMO_NORENDER;
+	}
+	if (timedemo != TIMEDEMO_OFF) nologo = true;
+
 	static const char* names[] = { "-pname", "-name", nullptr };
 	Args->CollectFiles("-name", names, ".---");	// this shouldn't collect any file names at all so use a nonsense extension
 	CommandName = Args->CheckValue("-name");
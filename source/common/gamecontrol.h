@@ -70,6 +70,7 @@ struct UserConfig
 	bool nomusic = false;
 	bool nologo = false;
 	int setupstate = -1;
+	int timedemo = 0;			// see ETimeDemo
 
 	int netPort = 0;			// g_netPort = Batoi(argv[i + 1]);
 	int netServerMode = -1;		// g_networkMode = NET_SERVER;	g_noSetup = g_noLogo = TRUE;
@@ -35,6 +35,7 @@
 #include "v_draw.h"
 #include "build.h"
 #include "gamecvars.h"
+#include "savegamehelp.h"
 
 int GUICapture = false;
 
@@ -148,6 +149,7 @@ int32_t handleevents(void)
 	}
 
 	timerUpdateClock();
+	CheckSavegameWrite();
 
 	// The mouse wheel is not a real key so in order to be "pressed" it may only be cleared at the end of the tic (or the start of the next.)
 	if (inputState.GetKeyStatus(KEY_MWHEELUP))
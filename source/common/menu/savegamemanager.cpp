@@ -115,6 +115,7 @@ int FSavegameManager::RemoveSaveSlot(int index)
 	int listindex = SaveGames[0]->bNoDelete ? index - 1 : index;
 	if (listindex < 0) return index;
 
+	WaitForSavegameWrite();
 	remove(SaveGames[index]->Filename.GetChars());
 	UnloadSaveData();
 
@@ -182,6 +183,7 @@ void FSavegameManager::ReadSaveStrings()
 {
 	if (SaveGames.Size() == 0)
 	{
+		WaitForSavegameWrite();
 		void *filefirst;
 		findstate_t c_file;
 		FString filter;
@@ -365,6 +367,7 @@ unsigned FSavegameManager::ExtractSaveData(int index)
 	}
 
 	UnloadSaveData();
+	WaitForSavegameWrite();
 
 	if ((unsigned)index < SaveGames.Size() &&
 		(node = SaveGames[index]) &&
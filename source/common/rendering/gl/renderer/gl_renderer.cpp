@@ -189,6 +189,23 @@ void FGLRenderer::BindToFrameBuffer(FTexture *mat)
 //===========================================================================
 
 void FGLRenderer::WriteSavePic ( FileWriter *file, int width, int height)
+{
+	TArray<uint8_t> pixels;
+	if (CaptureSavePic(pixels, width, height))
+	{
+		M_CreatePNG(file, &pixels[(height - 1) * width * 3], nullptr, SS_RGB, width, height, -width * 3, vid_gamma);
+		M_FinishPNG(file);
+	}
+}
+
+//===========================================================================
+//
+// Renders the savegame picture and returns it as bottom-up RGB data
+// so that it can be encoded elsewhere.
+//
+//===========================================================================
+
+bool FGLRenderer::CaptureSavePic(TArray<uint8_t> &pixels, int width, int height)
 {
     IntRect bounds;
     bounds.left = 0;
@@ -233,12 +250,8 @@ void FGLRenderer::WriteSavePic ( FileWriter *file, int width, int height)
     
 	if (didit)
 	{
-		int numpixels = width * height;
-		uint8_t* scr = (uint8_t*)Xmalloc(numpixels * 3);
-		glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, scr);
-		M_CreatePNG(file, scr + ((height - 1) * width * 3), nullptr, SS_RGB, width, height, -width * 3, vid_gamma);
-        M_FinishPNG(file);
-		Xfree(scr);
+		pixels.Resize(width * height * 3);
+		glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.Data());
 	}
     
     // Switch back the screen render buffers
@@ -246,6 +259,7 @@ void FGLRenderer::WriteSavePic ( FileWriter *file, int width, int height)
     mBuffers = mScreenBuffers;
 	bool useSSAO = (gl_ssao != 0);
 	mBuffers->BindSceneFB(useSSAO);
+	return didit;
 }
 
 
@@ -82,6 +82,7 @@ public:
 	void Flush();
 	//void Draw2D(F2DDrawer *data);
 	void WriteSavePic(FileWriter *file, int width, int height);
+	bool CaptureSavePic(TArray<uint8_t> &pixels, int width, int height);
 	void BeginFrame();
     
 
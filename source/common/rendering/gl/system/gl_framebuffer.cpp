@@ -222,6 +222,11 @@ void OpenGLFrameBuffer::WriteSavePic(FileWriter *file, int width, int height)
 	GLRenderer->WriteSavePic(file, width, height);
 }
 
+bool OpenGLFrameBuffer::CaptureSavePic(TArray<uint8_t> &pixels, int width, int height)
+{
+	return GLRenderer->CaptureSavePic(pixels, width, height);
+}
+
 
 const char* OpenGLFrameBuffer::DeviceName() const 
 {
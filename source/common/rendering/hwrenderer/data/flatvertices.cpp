@@ -39,6 +39,8 @@
 #include "printf.h"
 #include "hwrenderer/data/buffers.h"
 
+static unsigned int staticserial;	// so that static vertices from a previous buffer are never mistaken as valid.
+
 //==========================================================================
 //
 //
@@ -86,12 +88,15 @@ FFlatVertexBuffer::FFlatVertexBuffer(int width, int height)
 
 	static const FVertexBufferAttribute format[] = {
 		{ 0, VATTR_VERTEX, VFmt_Float3, (int)myoffsetof(FFlatVertex, x) },
-		{ 0, VATTR_TEXCOORD, VFmt_Float2, (int)myoffsetof(FFlatVertex, u) }
+		{ 0, VATTR_TEXCOORD, VFmt_Float2, (int)myoffsetof(FFlatVertex, u) },
+		{ 1, VATTR_VERTEX2, VFmt_Float3, (int)myoffsetof(FFlatVertex, x) }	// second model frame for interpolation
 	};
-	mVertexBuffer->SetFormat(1, 2, sizeof(FFlatVertex), format);
+	mVertexBuffer->SetFormat(2, 3, sizeof(FFlatVertex), format);
 
 	mIndex = mCurIndex = NUM_RESERVED;
 	mNumReserved = NUM_RESERVED;
+	mStaticIndex = BUFFER_SIZE;
+	mStaticSerial = ++staticserial;
 	Copy(0, NUM_RESERVED);
 }
 
@@ -135,7 +140,7 @@ std::pair<FFlatVertex *, unsigned int> FFlatVertexBuffer::AllocVertices(unsigned
 	FFlatVertex *p = GetBuffer();
 	auto index = mCurIndex.fetch_add(count);
 	auto offset = index;
-	if (index + count >= BUFFER_SIZE_TO_USE)
+	if (index + count >= BUFFER_SIZE_TO_USE - STATIC_SIZE)
 	{
 		// If a single scene needs 2'000'000 vertices there must be something very wrong. 
 		I_FatalError("Out of vertex memory. Tried to allocate more than %u vertices for a single frame", index + count);
@@ -143,6 +148,26 @@ std::pair<FFlatVertex *, unsigned int> FFlatVertexBuffer::AllocVertices(unsigned
 	return std::make_pair(p, index);
 }
 
+//==========================================================================
+//
+// Static vertices are written once and then used for many frames. If the
+// space for them runs out the caller needs to fall back to AllocVertices.
+//
+//==========================================================================
+
+std::pair<FFlatVertex *, unsigned int> FFlatVertexBuffer::AllocStaticVertices(unsigned int count)
+{
+	if (count > mStaticIndex - (BUFFER_SIZE - STATIC_SIZE)) return std::make_pair(nullptr, 0u);
+	mStaticIndex -= count;
+	return std::make_pair(GetBuffer(mStaticIndex), mStaticIndex);
+}
+
+void FFlatVertexBuffer::ResetStatic()
+{
+	mStaticIndex = BUFFER_SIZE;
+	mStaticSerial = ++staticserial;
+}
+
 //==========================================================================
 //
 //
@@ -51,10 +51,13 @@ class FFlatVertexBuffer
 	unsigned int mIndex;
 	std::atomic<unsigned int> mCurIndex;
 	unsigned int mNumReserved;
+	unsigned int mStaticIndex;	// static vertices are taken from the end of the buffer.
+	unsigned int mStaticSerial;
 
 
 	static const unsigned int BUFFER_SIZE = 4000000;	// Was upped from 2000000 to account for voxels not being implemented with a separate vertex buffer.
 	static const unsigned int BUFFER_SIZE_TO_USE = BUFFER_SIZE-500;
+	static const unsigned int STATIC_SIZE = BUFFER_SIZE / 4;
 
 public:
 	enum
@@ -92,6 +95,11 @@ public:
 
 	std::pair<FFlatVertex *, unsigned int> AllocVertices(unsigned int count);
 
+	// For data that does not change between frames. It remains valid as long as StaticSerial() returns the same value.
+	std::pair<FFlatVertex *, unsigned int> AllocStaticVertices(unsigned int count);
+	unsigned int StaticSerial() const { return mStaticSerial; }
+	void ResetStatic();
+
 	void Reset()
 	{
 		mCurIndex = mIndex;
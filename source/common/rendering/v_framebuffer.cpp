@@ -244,6 +244,11 @@ void DFrameBuffer::WriteSavePic(FileWriter *file, int width, int height)
 {
 }
 
+bool DFrameBuffer::CaptureSavePic(TArray<uint8_t> &pixels, int width, int height)
+{
+	return false;
+}
+
 
 //==========================================================================
 //
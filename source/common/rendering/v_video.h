@@ -340,6 +340,7 @@ public:
 	virtual const char* DeviceName() const { return "Unknown"; }
 	virtual void Draw2D() {}
 	virtual void WriteSavePic(FileWriter *file, int width, int height);
+	virtual bool CaptureSavePic(TArray<uint8_t> &pixels, int width, int height);
 
 	// Screen wiping
 	virtual FTexture *WipeStartScreen();
@@ -51,9 +51,68 @@
 #include "version.h"
 #include "z_music.h"
 #include "s_soundinternal.h"
+#include "c_dispatch.h"
+#include "stats.h"
+#include "v_text.h"
+#include "m_crc32.h"
+#include "gamecvars.h"
+#include <thread>
+#include <atomic>
 
 static CompositeSavegameWriter savewriter;
 static FResourceFile *savereader;
+
+CVARD(Bool, save_async, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG, "compress and write savegames on a background thread")
+
+//=============================================================================
+//
+// Background savegame writing. The game state has already been copied into
+// memory when the job starts, so the thread only needs to encode the save
+// picture, compress the chunks and write the file.
+//
+//=============================================================================
+
+struct FSaveThread
+{
+	std::thread Thread;
+	std::atomic<bool> Done{ false };
+	bool Result = false;
+	FString Filename;
+
+	~FSaveThread()
+	{
+		if (Thread.joinable()) Thread.join();
+	}
+};
+
+static FSaveThread savethread;
+
+static void FinishSaveThread()
+{
+	savethread.Thread.join();
+	if (!savethread.Result)
+	{
+		Printf(TEXTCOLOR_RED "Failed to write savegame %s\n", savethread.Filename.GetChars());
+	}
+}
+
+// Reports the outcome of a finished background save without blocking.
+void CheckSavegameWrite()
+{
+	if (savethread.Thread.joinable() && savethread.Done.load(std::memory_order_acquire))
+	{
+		FinishSaveThread();
+	}
+}
+
+// Blocks until the savegame being written in the background is on disk.
+void WaitForSavegameWrite()
+{
+	if (savethread.Thread.joinable())
+	{
+		FinishSaveThread();
+	}
+}
 void LoadEngineState();
 void SaveEngineState();
 
@@ -90,6 +149,7 @@ static void SerializeSession(FSerializer& arc)
 
 bool OpenSaveGameForRead(const char *name)
 {
+	WaitForSavegameWrite();
 	if (savereader) delete savereader;
 	savereader = FResourceFile::OpenResourceFile(name, true, true);
 
@@ -149,7 +209,24 @@ FileReader ReadSavegameChunk(const char *name)
 
 bool FinishSavegameWrite()
 {
-	return savewriter.WriteToFile();
+	WaitForSavegameWrite();
+	if (!save_async)
+	{
+		return savewriter.WriteToFile();
+	}
+
+	auto job = new CompositeSavegameWriter;
+	job->Swap(savewriter);
+	savethread.Done = false;
+	savethread.Result = false;
+	savethread.Filename = job->GetFileName();
+	savethread.Thread = std::thread([=]()
+	{
+		savethread.Result = job->WriteToFile();
+		delete job;
+		savethread.Done.store(true, std::memory_order_release);
+	});
+	return true;
 }
 
 void FinishSavegameRead()
@@ -159,6 +236,20 @@ void FinishSavegameRead()
 }
 
 CVAR(Bool, save_formatted, true, 0)	// should be set to false once the conversion is done
+CVARD(Bool, save_binary, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG, "write the game state of savegames in the binary serializer format")
+
+//=============================================================================
+//
+// The displayable savegame info always stays JSON so that it remains
+// readable outside the engine. Both formats can be read back.
+//
+//=============================================================================
+
+static void OpenSaveGameSerializer(FSerializer &arc)
+{
+	if (save_binary) arc.OpenBinaryWriter();
+	else arc.OpenWriter(save_formatted);
+}
 
 //=============================================================================
 //
@@ -168,6 +259,7 @@ CVAR(Bool, save_formatted, true, 0)	// should be set to false once the conversio
 
 bool OpenSaveGameForWrite(const char* filename, const char *name)
 {
+	WaitForSavegameWrite();
 	savewriter.Clear();
 	savewriter.SetFileName(filename);
 
@@ -176,7 +268,7 @@ bool OpenSaveGameForWrite(const char* filename, const char *name)
 	FSerializer savegameengine;		// saved play state.
 
 	savegameinfo.OpenWriter(true);
-	savegameengine.OpenWriter(save_formatted);
+	OpenSaveGameSerializer(savegameengine);
 
 	char buf[100];
 	mysnprintf(buf, countof(buf), GAMENAME " %s", GetVersionString());
@@ -215,14 +307,18 @@ bool OpenSaveGameForWrite(const char* filename, const char *name)
 
 
 	// Handle system-side modules that need to persist data in savegames here, in a central place.
-	savegamesession.OpenWriter(save_formatted);
+	OpenSaveGameSerializer(savegamesession);
 	SerializeSession(savegamesession);
 	buff = savegamesession.GetCompressedOutput();
 	AddCompressedSavegameChunk("session.json", buff);
 
 	SaveEngineState();
-	auto picfile = WriteSavegameChunk("savepic.png");
-	screen->WriteSavePic(picfile, 240, 180);
+	// Only grab the picture here. The PNG gets encoded along with the rest of the file.
+	TArray<uint8_t> savepic;
+	if (screen->CaptureSavePic(savepic, 240, 180))
+		savewriter.AddImageElement("savepic.png", savepic, 240, 180, vid_gamma);
+	else
+		WriteSavegameChunk("savepic.png");
 	return true;
 }
 
@@ -508,6 +604,8 @@ void LoadEngineState()
 	auto fr = ReadSavegameChunk("engine.bin");
 	if (fr.isOpen())
 	{
+		sectorGridClear();
+		canseeCacheClear();
 		memset(sector, 0, sizeof(sector[0]) * MAXSECTORS);
 		memset(wall, 0, sizeof(wall[0]) * MAXWALLS);
 		memset(sprite, 0, sizeof(sprite[0]) * MAXSPRITES);
@@ -565,5 +663,184 @@ void LoadEngineState()
 	CheckMagic(fr);
 
 		fr.Close();
+		sectorGridBuild();
+		canseeCacheBuild();
+	}
+}
+
+//=============================================================================
+//
+// Compares the serializer formats by running all sectors, walls and
+// active sprites of the current map through them.
+//
+//=============================================================================
+
+template<class T>
+static int BenchSerializeField(FSerializer &arc, const char *key, const T &value, uint32_t &crc)
+{
+	int v = arc.isWriting() ? int(value) : 0;
+	arc(key, v);
+	crc = AddCRC32(crc, (const uint8_t *)&v, sizeof(v));
+	return v;
+}
+
+static void BenchSerializeMap(FSerializer &arc, uint32_t &crc)
+{
+	if (arc.BeginArray("sectors"))
+	{
+		int const count = arc.isReading() ? min<int>(arc.ArraySize(), numsectors) : numsectors;
+		for (int i = 0; i < count; i++)
+		{
+			auto const &sec = sector[i];
+			if (arc.BeginObject(nullptr))
+			{
+				BenchSerializeField(arc, "wallptr", sec.wallptr, crc);
+				BenchSerializeField(arc, "wallnum", sec.wallnum, crc);
+				BenchSerializeField(arc, "ceilingz", sec.ceilingz, crc);
+				BenchSerializeField(arc, "floorz", sec.floorz, crc);
+				BenchSerializeField(arc, "ceilingstat", sec.ceilingstat, crc);
+				BenchSerializeField(arc, "floorstat", sec.floorstat, crc);
+				BenchSerializeField(arc, "ceilingpicnum", sec.ceilingpicnum, crc);
+				BenchSerializeField(arc, "ceilingheinum", sec.ceilingheinum, crc);
+				BenchSerializeField(arc, "ceilingshade", sec.ceilingshade, crc);
+				BenchSerializeField(arc, "ceilingpal", sec.ceilingpal, crc);
+				BenchSerializeField(arc, "ceilingxpanning", sec.ceilingxpanning, crc);
+				BenchSerializeField(arc, "ceilingypanning", sec.ceilingypanning, crc);
+				BenchSerializeField(arc, "floorpicnum", sec.floorpicnum, crc);
+				BenchSerializeField(arc, "floorheinum", sec.floorheinum, crc);
+				BenchSerializeField(arc, "floorshade", sec.floorshade, crc);
+				BenchSerializeField(arc, "floorpal", sec.floorpal, crc);
+				BenchSerializeField(arc, "floorxpanning", sec.floorxpanning, crc);
+				BenchSerializeField(arc, "floorypanning", sec.floorypanning, crc);
+				BenchSerializeField(arc, "visibility", sec.visibility, crc);
+				BenchSerializeField(arc, "fogpal", sec.fogpal, crc);
+				BenchSerializeField(arc, "lotag", sec.lotag, crc);
+				BenchSerializeField(arc, "hitag", sec.hitag, crc);
+				BenchSerializeField(arc, "extra", sec.extra, crc);
+				arc.EndObject();
+			}
+		}
+		arc.EndArray();
+	}
+
+	if (arc.BeginArray("walls"))
+	{
+		int const count = arc.isReading() ? min<int>(arc.ArraySize(), numwalls) : numwalls;
+		for (int i = 0; i < count; i++)
+		{
+			auto const &wal = wall[i];
+			if (arc.BeginObject(nullptr))
+			{
+				BenchSerializeField(arc, "x", wal.x, crc);
+				BenchSerializeField(arc, "y", wal.y, crc);
+				BenchSerializeField(arc, "point2", wal.point2, crc);
+				BenchSerializeField(arc, "nextwall", wal.nextwall, crc);
+				BenchSerializeField(arc, "nextsector", wal.nextsector, crc);
+				BenchSerializeField(arc, "cstat", wal.cstat, crc);
+				BenchSerializeField(arc, "picnum", wal.picnum, crc);
+				BenchSerializeField(arc, "overpicnum", wal.overpicnum, crc);
+				BenchSerializeField(arc, "shade", wal.shade, crc);
+				BenchSerializeField(arc, "pal", wal.pal, crc);
+				BenchSerializeField(arc, "xrepeat", wal.xrepeat, crc);
+				BenchSerializeField(arc, "yrepeat", wal.yrepeat, crc);
+				BenchSerializeField(arc, "xpanning", wal.xpanning, crc);
+				BenchSerializeField(arc, "ypanning", wal.ypanning, crc);
+				BenchSerializeField(arc, "lotag", wal.lotag, crc);
+				BenchSerializeField(arc, "hitag", wal.hitag, crc);
+				BenchSerializeField(arc, "extra", wal.extra, crc);
+				arc.EndObject();
+			}
+		}
+		arc.EndArray();
+	}
+
+	if (arc.BeginArray("sprites"))
+	{
+		int const count = arc.isReading() ? min<int>(arc.ArraySize(), MAXSPRITES) : MAXSPRITES;
+		for (int i = 0; i < count; i++)
+		{
+			auto const &spr = sprite[i];
+			if (arc.BeginObject(nullptr))
+			{
+				// Free sprites only store this flag, so that reading them back produces the same crc.
+				if (BenchSerializeField(arc, "used", spr.statnum != MAXSTATUS, crc))
+				{
+					BenchSerializeField(arc, "x", spr.x, crc);
+					BenchSerializeField(arc, "y", spr.y, crc);
+					BenchSerializeField(arc, "z", spr.z, crc);
+					BenchSerializeField(arc, "cstat", spr.cstat, crc);
+					BenchSerializeField(arc, "picnum", spr.picnum, crc);
+					BenchSerializeField(arc, "shade", spr.shade, crc);
+					BenchSerializeField(arc, "pal", spr.pal, crc);
+					BenchSerializeField(arc, "clipdist", spr.clipdist, crc);
+					BenchSerializeField(arc, "xrepeat", spr.xrepeat, crc);
+					BenchSerializeField(arc, "yrepeat", spr.yrepeat, crc);
+					BenchSerializeField(arc, "xoffset", spr.xoffset, crc);
+					BenchSerializeField(arc, "yoffset", spr.yoffset, crc);
+					BenchSerializeField(arc, "sectnum", spr.sectnum, crc);
+					BenchSerializeField(arc, "statnum", spr.statnum, crc);
+					BenchSerializeField(arc, "ang", spr.ang, crc);
+					BenchSerializeField(arc, "owner", spr.owner, crc);
+					BenchSerializeField(arc, "xvel", spr.xvel, crc);
+					BenchSerializeField(arc, "yvel", spr.yvel, crc);
+					BenchSerializeField(arc, "zvel", spr.zvel, crc);
+					BenchSerializeField(arc, "lotag", spr.lotag, crc);
+					BenchSerializeField(arc, "hitag", spr.hitag, crc);
+					BenchSerializeField(arc, "extra", spr.extra, crc);
+				}
+				arc.EndObject();
+			}
+		}
+		arc.EndArray();
+	}
+}
+
+CCMD(bench_serializer)
+{
+	if (numsectors <= 0)
+	{
+		Printf("No map loaded\n");
+		return;
+	}
+
+	int const count = argv.argc() > 1 ? max(1, (int)strtol(argv[1], nullptr, 10)) : 10;
+	static const char *const modes[] = { "JSON formatted", "JSON compact", "binary" };
+
+	for (int mode = 0; mode < 3; mode++)
+	{
+		cycle_t writeclock, readclock;
+		uint32_t writecrc = 0, readcrc = 0;
+		unsigned size = 0, compressedsize = 0;
+
+		writeclock.Reset();
+		readclock.Reset();
+		for (int n = 0; n < count; n++)
+		{
+			FSerializer writer;
+			writeclock.Clock();
+			if (mode == 2) writer.OpenBinaryWriter();
+			else writer.OpenWriter(mode == 0);
+			writecrc = 0;
+			BenchSerializeMap(writer, writecrc);
+			auto buff = writer.GetCompressedOutput();
+			writeclock.Unclock();
+
+			size = buff.mSize;
+			compressedsize = buff.mCompressedSize;
+
+			FSerializer reader;
+			readclock.Clock();
+			if (reader.OpenReader(&buff))
+			{
+				readcrc = 0;
+				BenchSerializeMap(reader, readcrc);
+			}
+			reader.Close();
+			readclock.Unclock();
+			buff.Clean();
+		}
+		Printf("%s: %u bytes, %u compressed, save %.2f ms, load %.2f ms\n", modes[mode], size, compressedsize,
+			writeclock.TimeMS() / count, readclock.TimeMS() / count);
+		if (readcrc != writecrc) Printf(TEXTCOLOR_RED "%s: data read back does not match!\n", modes[mode]);
 	}
 }
@@ -10,6 +10,8 @@ FileReader ReadSavegameChunk(const char *name);
 
 bool FinishSavegameWrite();
 void FinishSavegameRead();
+void CheckSavegameWrite();
+void WaitForSavegameWrite();
 
 // Savegame utilities
 class FileReader;
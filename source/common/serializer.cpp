@@ -50,6 +50,7 @@
 #include "utf8.h"
 #include "printf.h"
 #include "s_soundinternal.h"
+#include "superfasthash.h"
 
 bool save_full = false;
 
@@ -129,6 +130,148 @@ struct FJSONObject
 	}
 };
 
+//==========================================================================
+//
+// Compact binary encoding of the same document structure the JSON writer
+// produces. Numbers are stored as variable length integers or raw doubles
+// and each key is only spelled out on its first use. Afterward it is
+// referenced by index.
+//
+//==========================================================================
+
+static const char BinaryMagic[4] = { 'R', 'Z', 'S', 'B' };
+
+enum EBinaryTag : uint8_t
+{
+	BIN_Null,
+	BIN_False,
+	BIN_True,
+	BIN_Int,		// zigzag encoded varint
+	BIN_Uint,		// varint
+	BIN_Double,		// 8 bytes, native byte order
+	BIN_String,		// varint length, characters, terminating 0
+	BIN_NewKey,		// same as BIN_String, assigns the next key index
+	BIN_Key,		// varint key index
+	BIN_StartObject,
+	BIN_EndObject,
+	BIN_StartArray,
+	BIN_EndArray,
+};
+
+struct FBinaryWriter
+{
+	struct KeyEntry
+	{
+		uint32_t Hash;
+		unsigned Offset;
+		unsigned Length;
+	};
+
+	TArray<uint8_t> mBuffer;
+	TArray<KeyEntry> mKeys;
+	TArray<char> mKeyPool;
+	TArray<unsigned> mKeyHash;	// open addressing, holds key index + 1
+
+	FBinaryWriter()
+	{
+		mBuffer.Grow(65536);
+		mBuffer.Reserve(sizeof(BinaryMagic));
+		memcpy(mBuffer.Data(), BinaryMagic, sizeof(BinaryMagic));
+	}
+
+	void Tag(EBinaryTag tag)
+	{
+		mBuffer.Push(tag);
+	}
+
+	void Varint(uint64_t v)
+	{
+		while (v >= 0x80)
+		{
+			mBuffer.Push(uint8_t(v | 0x80));
+			v >>= 7;
+		}
+		mBuffer.Push(uint8_t(v));
+	}
+
+	void Bytes(const char *s, size_t len)
+	{
+		Varint(len);
+		auto pos = mBuffer.Reserve(len + 1);
+		memcpy(&mBuffer[pos], s, len);
+		mBuffer[pos + len] = 0;
+	}
+
+	void GrowKeyHash()
+	{
+		mKeyHash.Resize(mKeyHash.Size() == 0 ? 256 : mKeyHash.Size() * 2);
+		memset(mKeyHash.Data(), 0, mKeyHash.Size() * sizeof(unsigned));
+		unsigned const mask = mKeyHash.Size() - 1;
+		for (unsigned k = 0; k < mKeys.Size(); k++)
+		{
+			unsigned i = mKeys[k].Hash & mask;
+			while (mKeyHash[i] != 0) i = (i + 1) & mask;
+			mKeyHash[i] = k + 1;
+		}
+	}
+
+	void Key(const char *k)
+	{
+		size_t const len = strlen(k);
+		uint32_t const hash = SuperFastHash(k, len);
+
+		if (mKeys.Size() * 2 >= mKeyHash.Size()) GrowKeyHash();
+
+		unsigned const mask = mKeyHash.Size() - 1;
+		for (unsigned i = hash & mask;; i = (i + 1) & mask)
+		{
+			unsigned const slot = mKeyHash[i];
+			if (slot == 0)
+			{
+				mKeyHash[i] = mKeys.Size() + 1;
+				mKeys.Push({ hash, mKeyPool.Size(), (unsigned)len });
+				auto pos = mKeyPool.Reserve(len);
+				memcpy(&mKeyPool[pos], k, len);
+				Tag(BIN_NewKey);
+				Bytes(k, len);
+				return;
+			}
+			auto &entry = mKeys[slot - 1];
+			if (entry.Hash == hash && entry.Length == len && !memcmp(&mKeyPool[entry.Offset], k, len))
+			{
+				Tag(BIN_Key);
+				Varint(slot - 1);
+				return;
+			}
+		}
+	}
+
+	void String(const char *k)
+	{
+		Tag(BIN_String);
+		Bytes(k, strlen(k));
+	}
+
+	void Int64(int64_t v)
+	{
+		Tag(BIN_Int);
+		Varint((uint64_t(v) << 1) ^ uint64_t(v >> 63));
+	}
+
+	void Uint64(uint64_t v)
+	{
+		Tag(BIN_Uint);
+		Varint(v);
+	}
+
+	void Double(double v)
+	{
+		Tag(BIN_Double);
+		auto pos = mBuffer.Reserve(sizeof(v));
+		memcpy(&mBuffer[pos], &v, sizeof(v));
+	}
+};
+
 //==========================================================================
 //
 // some wrapper stuff to keep the RapidJSON dependencies out of the global headers.
@@ -143,6 +286,7 @@ struct FWriter
 
 	Writer *mWriter1;
 	PrettyWriter *mWriter2;
+	FBinaryWriter *mWriter3 = nullptr;
 	TArray<bool> mInObject;
 	rapidjson::StringBuffer mOutString;
 #if 0
@@ -150,9 +294,15 @@ struct FWriter
 	TMap<DObject *, int> mObjectMap;
 #endif
 	
-	FWriter(bool pretty)
+	FWriter(bool pretty, bool binary = false)
 	{
-		if (!pretty)
+		if (binary)
+		{
+			mWriter1 = nullptr;
+			mWriter2 = nullptr;
+			mWriter3 = new FBinaryWriter;
+		}
+		else if (!pretty)
 		{
 			mWriter1 = new Writer(mOutString);
 			mWriter2 = nullptr;
@@ -168,6 +318,18 @@ struct FWriter
 	{
 		if (mWriter1) delete mWriter1;
 		if (mWriter2) delete mWriter2;
+		if (mWriter3) delete mWriter3;
+	}
+
+	const char *GetOutput(size_t *len)
+	{
+		if (mWriter3)
+		{
+			*len = mWriter3->mBuffer.Size();
+			return (const char *)mWriter3->mBuffer.Data();
+		}
+		*len = mOutString.GetSize();
+		return mOutString.GetString();
 	}
 
 
@@ -180,36 +342,42 @@ struct FWriter
 	{
 		if (mWriter1) mWriter1->StartObject();
 		else if (mWriter2) mWriter2->StartObject();
+		else if (mWriter3) mWriter3->Tag(BIN_StartObject);
 	}
 
 	void EndObject()
 	{
 		if (mWriter1) mWriter1->EndObject();
 		else if (mWriter2) mWriter2->EndObject();
+		else if (mWriter3) mWriter3->Tag(BIN_EndObject);
 	}
 
 	void StartArray()
 	{
 		if (mWriter1) mWriter1->StartArray();
 		else if (mWriter2) mWriter2->StartArray();
+		else if (mWriter3) mWriter3->Tag(BIN_StartArray);
 	}
 
 	void EndArray()
 	{
 		if (mWriter1) mWriter1->EndArray();
 		else if (mWriter2) mWriter2->EndArray();
+		else if (mWriter3) mWriter3->Tag(BIN_EndArray);
 	}
 
 	void Key(const char *k)
 	{
 		if (mWriter1) mWriter1->Key(k);
 		else if (mWriter2) mWriter2->Key(k);
+		else if (mWriter3) mWriter3->Key(k);
 	}
 
 	void Null()
 	{
 		if (mWriter1) mWriter1->Null();
 		else if (mWriter2) mWriter2->Null();
+		else if (mWriter3) mWriter3->Tag(BIN_Null);
 	}
 
 	void StringU(const char *k, bool encode)
@@ -217,6 +385,7 @@ struct FWriter
 		if (encode) k = StringToUnicode(k);
 		if (mWriter1) mWriter1->String(k);
 		else if (mWriter2) mWriter2->String(k);
+		else if (mWriter3) mWriter3->String(k);
 	}
 
 	void String(const char *k)
@@ -224,6 +393,7 @@ struct FWriter
 		k = StringToUnicode(k);
 		if (mWriter1) mWriter1->String(k);
 		else if (mWriter2) mWriter2->String(k);
+		else if (mWriter3) mWriter3->String(k);
 	}
 
 	void String(const char *k, int size)
@@ -231,36 +401,42 @@ struct FWriter
 		k = StringToUnicode(k, size);
 		if (mWriter1) mWriter1->String(k);
 		else if (mWriter2) mWriter2->String(k);
+		else if (mWriter3) mWriter3->String(k);
 	}
 
 	void Bool(bool k)
 	{
 		if (mWriter1) mWriter1->Bool(k);
 		else if (mWriter2) mWriter2->Bool(k);
+		else if (mWriter3) mWriter3->Tag(k ? BIN_True : BIN_False);
 	}
 
 	void Int(int32_t k)
 	{
 		if (mWriter1) mWriter1->Int(k);
 		else if (mWriter2) mWriter2->Int(k);
+		else if (mWriter3) mWriter3->Int64(k);
 	}
 
 	void Int64(int64_t k)
 	{
 		if (mWriter1) mWriter1->Int64(k);
 		else if (mWriter2) mWriter2->Int64(k);
+		else if (mWriter3) mWriter3->Int64(k);
 	}
 
 	void Uint(uint32_t k)
 	{
 		if (mWriter1) mWriter1->Uint(k);
 		else if (mWriter2) mWriter2->Uint(k);
+		else if (mWriter3) mWriter3->Uint64(k);
 	}
 
 	void Uint64(int64_t k)
 	{
 		if (mWriter1) mWriter1->Uint64(k);
 		else if (mWriter2) mWriter2->Uint64(k);
+		else if (mWriter3) mWriter3->Uint64(k);
 	}
 
 	void Double(double k)
@@ -273,10 +449,137 @@ struct FWriter
 		{
 			mWriter2->Double(k);
 		}
+		else if (mWriter3)
+		{
+			mWriter3->Double(k);
+		}
 	}
 
 };
 
+//==========================================================================
+//
+// Turns the binary encoding back into a RapidJSON document so that
+// everything after OpenReader works the same for both formats.
+// The strings in the document point directly into the buffer.
+//
+//==========================================================================
+
+struct FBinaryReader
+{
+	const uint8_t *mPos, *mEnd;
+	TArray<const char *> mKeys;
+	TArray<unsigned> mKeyLengths;
+
+	FBinaryReader(const uint8_t *buffer, size_t length)
+	{
+		mPos = buffer + sizeof(BinaryMagic);
+		mEnd = buffer + length;
+	}
+
+	bool Varint(uint64_t &v)
+	{
+		v = 0;
+		for (int shift = 0; shift < 64 && mPos < mEnd; shift += 7)
+		{
+			uint8_t const b = *mPos++;
+			v |= uint64_t(b & 0x7f) << shift;
+			if (!(b & 0x80)) return true;
+		}
+		return false;
+	}
+
+	bool Bytes(const char *&s, unsigned &len)
+	{
+		uint64_t v;
+		if (!Varint(v) || v >= uint64_t(mEnd - mPos) || mPos[v] != 0) return false;
+		s = (const char *)mPos;
+		len = (unsigned)v;
+		mPos += v + 1;
+		return true;
+	}
+
+	template<class Handler>
+	bool operator()(Handler &h)
+	{
+		TArray<unsigned> counts;	// number of values in each open object or array
+		counts.Push(0);
+		while (mPos < mEnd)
+		{
+			const char *s;
+			unsigned len;
+			uint64_t v;
+			double d;
+
+			switch (*mPos++)
+			{
+			case BIN_Null:
+				h.Null();
+				break;
+
+			case BIN_False:
+			case BIN_True:
+				h.Bool(mPos[-1] == BIN_True);
+				break;
+
+			case BIN_Int:
+				if (!Varint(v)) return false;
+				h.Int64(int64_t(v >> 1) ^ -int64_t(v & 1));
+				break;
+
+			case BIN_Uint:
+				if (!Varint(v)) return false;
+				h.Uint64(v);
+				break;
+
+			case BIN_Double:
+				if (mEnd - mPos < (ptrdiff_t)sizeof(d)) return false;
+				memcpy(&d, mPos, sizeof(d));
+				mPos += sizeof(d);
+				h.Double(d);
+				break;
+
+			case BIN_String:
+				if (!Bytes(s, len)) return false;
+				h.String(s, len, false);
+				break;
+
+			case BIN_NewKey:
+				if (!Bytes(s, len)) return false;
+				mKeys.Push(s);
+				mKeyLengths.Push(len);
+				h.Key(s, len, false);
+				continue;
+
+			case BIN_Key:
+				if (!Varint(v) || v >= mKeys.Size()) return false;
+				h.Key(mKeys[(unsigned)v], mKeyLengths[(unsigned)v], false);
+				continue;
+
+			case BIN_StartObject:
+			case BIN_StartArray:
+				if (mPos[-1] == BIN_StartObject) h.StartObject();
+				else h.StartArray();
+				counts.Push(0);
+				continue;
+
+			case BIN_EndObject:
+			case BIN_EndArray:
+				if (counts.Size() < 2) return false;
+				if (mPos[-1] == BIN_EndObject) h.EndObject(counts.Last());
+				else h.EndArray(counts.Last());
+				counts.Pop();
+				break;
+
+			default:
+				return false;
+			}
+			counts.Last()++;
+		}
+		return counts.Size() == 1 && counts[0] == 1;
+	}
+};
+
 //==========================================================================
 //
 //
@@ -287,6 +590,7 @@ struct FReader
 {
 	TArray<FJSONObject> mObjects;
 	rapidjson::Document mDoc;
+	TArray<uint8_t> mBinary;
 #if 0
 	TArray<DObject *> mDObjects;
 #endif
@@ -295,7 +599,19 @@ struct FReader
 
 	FReader(const char *buffer, size_t length)
 	{
-		mDoc.Parse(buffer, length);
+		if (length >= sizeof(BinaryMagic) && !memcmp(buffer, BinaryMagic, sizeof(BinaryMagic)))
+		{
+			// The document references the strings in the buffer so it needs to be kept.
+			mBinary.Resize((unsigned)length);
+			memcpy(mBinary.Data(), buffer, length);
+			FBinaryReader reader(mBinary.Data(), length);
+			mDoc.Populate(reader);
+			if (!mDoc.IsObject()) Printf(TEXTCOLOR_RED "Corrupt binary serializer data\n");
+		}
+		else
+		{
+			mDoc.Parse(buffer, length);
+		}
 		mObjects.Push(FJSONObject(&mDoc));
 	}
 
@@ -345,6 +661,22 @@ bool FSerializer::OpenWriter(bool pretty)
 	return true;
 }
 
+//==========================================================================
+//
+// The binary format is read back by the regular OpenReader functions.
+//
+//==========================================================================
+
+bool FSerializer::OpenBinaryWriter()
+{
+	if (w != nullptr || r != nullptr) return false;
+
+	mErrors = 0;
+	w = new FWriter(false, true);
+	BeginObject(nullptr);
+	return true;
+}
+
 //==========================================================================
 //
 //
@@ -885,11 +1217,13 @@ const char *FSerializer::GetOutput(unsigned *len)
 	WriteObjects();
 #endif
 	EndObject();
+	size_t size;
+	auto output = w->GetOutput(&size);
 	if (len != nullptr)
 	{
-		*len = (unsigned)w->mOutString.GetSize();
+		*len = (unsigned)size;
 	}
-	return w->mOutString.GetString();
+	return output;
 }
 
 //==========================================================================
@@ -906,16 +1240,18 @@ FCompressedBuffer FSerializer::GetCompressedOutput()
 	WriteObjects();
 #endif
 	EndObject();
-	buff.mSize = (unsigned)w->mOutString.GetSize();
+	size_t size;
+	auto output = w->GetOutput(&size);
+	buff.mSize = (unsigned)size;
 	buff.mZipFlags = 0;
-	buff.mCRC32 = crc32(0, (const Bytef*)w->mOutString.GetString(), buff.mSize);
+	buff.mCRC32 = crc32(0, (const Bytef*)output, buff.mSize);
 
 	uint8_t *compressbuf = new uint8_t[buff.mSize+1];
 
 	z_stream stream;
 	int err;
 
-	stream.next_in = (Bytef *)w->mOutString.GetString();
+	stream.next_in = (Bytef *)output;
 	stream.avail_in = buff.mSize;
 	stream.next_out = (Bytef*)compressbuf;
 	stream.avail_out = buff.mSize;
@@ -949,7 +1285,9 @@ FCompressedBuffer FSerializer::GetCompressedOutput()
 	}
 
 error:
-	memcpy(compressbuf, w->mOutString.GetString(), buff.mSize + 1);
+	memcpy(compressbuf, output, buff.mSize);
+	compressbuf[buff.mSize] = 0;
+	buff.mBuffer = (char*)compressbuf;
 	buff.mCompressedSize = buff.mSize;
 	buff.mMethod = METHOD_STORED;
 	return buff;
@@ -70,6 +70,7 @@ public:
 		Close();
 	}
 	bool OpenWriter(bool pretty = true);
+	bool OpenBinaryWriter();
 	bool OpenReader(const char *buffer, size_t length);
 	bool OpenReader(FCompressedBuffer *input);
 	void Close();
@@ -39,7 +39,10 @@
 #include "image.h"
 #include "files.h"
 #include "filesystem/filesystem.h"
+#include "filesystem/resourcefile.h"
 #include "imagehelpers.h"
+#include "m_crc32.h"
+#include "cmdlib.h"
 
 int FImageSource::NextID;
 
@@ -49,6 +52,58 @@ int FImageSource::NextID;
 //
 //==========================================================================
 
+FileReader FImageSource::OpenReader()
+{
+	FileReader fr;
+	if (PreloadedData.Size() > 0) fr.OpenMemory(PreloadedData.Data(), PreloadedData.Size());
+	else fr = fileSystem.OpenFileReader(Name, 0);
+	return fr;
+}
+
+void FImageSource::PreloadData()
+{
+	// This also needs the file system, so make sure the workers won't have to do it.
+	uint32_t crc, size;
+	GetContentHash(crc, size);
+
+	auto fr = fileSystem.OpenFileReader(Name, 0);
+	if (fr.isOpen()) PreloadedData = fr.Read();
+}
+
+bool FImageSource::GetContentHash(uint32_t &crc, uint32_t &size)
+{
+	// Hashing the file's contents would cost nearly as much as decoding it, so the file
+	// is identified by its name and the modification time of the file it is stored in.
+	std::call_once(ContentHashOnce, [this]()
+	{
+		int const lump = fileSystem.FindFile(Name);
+		if (lump < 0) return;
+
+		FString const path = fileSystem.GetFileFullPath(lump);
+		const char *diskname = fileSystem.GetFileAt(lump)->GetDiskFileName();
+		if (diskname == nullptr) diskname = fileSystem.GetResourceFileFullName(fileSystem.GetFileContainer(lump));
+
+		time_t filetime = 0;
+		if (!GetFileInfo(diskname, nullptr, &filetime)) return;
+
+		int64_t const time = filetime;
+		ContentCrc = crc32(crc32(0, (const uint8_t *)path.GetChars(), path.Len()), (const uint8_t *)&time, sizeof(time));
+		ContentSize = fileSystem.FileLength(lump);
+		ContentHashed = true;
+	});
+
+	if (!ContentHashed) return false;
+	crc = ContentCrc;
+	size = ContentSize;
+	return true;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
 typedef FImageSource * (*CreateFunc)(FileReader & file);
 
 struct TexCreateInfo
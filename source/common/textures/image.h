@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <mutex>
 #include "zstring.h"
 #include "tarray.h"
 #include "textures.h"
@@ -8,6 +9,7 @@
 #include "memarena.h"
 
 class FImageSource;
+class FileReader;
 using PrecacheInfo = TMap<int, std::pair<int, int>>;
 
 struct PalettedPixels
@@ -37,6 +39,13 @@ protected:
 	bool bUseGamePalette = false;				// true if this is an image without its own color set.
 	int ImageID = -1;
 	FString Name;
+	TArray<uint8_t> PreloadedData;
+	uint32_t ContentCrc = 0, ContentSize = 0;
+	bool ContentHashed = false;
+	std::once_flag ContentHashOnce;
+
+	// Opens the image's file, or the data read by PreloadData if there is any.
+	FileReader OpenReader();
 
 	// Internal image creation functions. All external access should go through the cache interface,
 	// so that all code can benefit from future improvements to that.
@@ -64,6 +73,15 @@ public:
 	virtual void CreatePalettedPixels(uint8_t *destbuffer) = 0;
 	virtual int CopyPixels(FBitmap* bmp, int conversion) = 0;			// This will always ignore 'luminance'.
 
+	// The file system is not thread safe. To decode an image on a worker thread
+	// its file must be read on the main thread first.
+	void PreloadData();
+	void ReleasePreloadedData() { PreloadedData.Reset(); }
+
+	// Identifies the image's file for the texture cache, by its path, size and modification time.
+	// Safe to call from worker threads once PreloadData has been called.
+	bool GetContentHash(uint32_t &crc, uint32_t &size);
+
 
 	// Conversion option
 	enum EType
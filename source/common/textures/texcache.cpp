@@ -0,0 +1,221 @@
+//-------------------------------------------------------------------------
+/*
+** texcache.cpp
+**
+** Persistent cache for decoded hightile images.
+**
+** Every decoded image is stored in a file of its own, named after its
+** cache key. The files contain the finished BGRA buffer as CreateTexBuffer
+** returns it, so that a cache hit only needs to inflate the data.
+**
+*/
+//-------------------------------------------------------------------------
+
+#include <zlib.h>
+#include "texcache.h"
+#include "textures.h"
+#include "files.h"
+#include "cmdlib.h"
+#include "templates.h"
+#include "printf.h"
+#include "c_dispatch.h"
+#include "i_specialpaths.h"
+#include "i_system.h"
+
+CVARD(Bool, r_texcache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "keep decoded hightile textures in a cache to speed up loading")
+CVARD(Int, r_texcache_compression, 1, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "zlib compression level for the texture cache (0 = uncompressed)")
+
+enum
+{
+	TEXCACHE_VERSION = 2,
+};
+
+#pragma pack(push, 1)
+struct FTexCacheHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t crc, size;
+	int32_t width, height, flags;
+	uint8_t keymasked;
+
+	uint8_t masked;
+	int8_t translucent;
+	uint8_t compressed;
+	uint32_t datasize;		// as stored in the file
+	uint32_t pixelcrc;		// of the uncompressed pixels
+};
+#pragma pack(pop)
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static const FString &TexCache_Directory()
+{
+	// Thread safe initialization, this may get called by the precache workers first.
+	static const FString dir = []()
+	{
+		FString path = M_GetAppDataPath(true);
+		path << "texcache/";
+		CreatePath(path);
+		return path;
+	}();
+	return dir;
+}
+
+static FString TexCache_FileName(const FTexCacheKey &key)
+{
+	FString name = TexCache_Directory();
+	name.AppendFormat("%08x%08x_%dx%d_%x%d.tex", key.crc, key.size, key.width, key.height, key.flags, key.masked);
+	return name;
+}
+
+//==========================================================================
+//
+// The file's header must match the key exactly, anything else is treated
+// as a cache miss.
+//
+//==========================================================================
+
+bool TexCache_Load(const FTexCacheKey &key, FTextureBuffer &buffer, uint8_t &masked, int8_t &translucent)
+{
+	if (!r_texcache) return false;
+
+	FileReader fr;
+	if (!fr.OpenFile(TexCache_FileName(key))) return false;
+
+	FTexCacheHeader header;
+	if (fr.Read(&header, sizeof(header)) != sizeof(header)) return false;
+	if (memcmp(header.magic, "RTXC", 4) || header.version != TEXCACHE_VERSION) return false;
+	if (header.crc != key.crc || header.size != key.size || header.width != key.width || header.height != key.height ||
+		header.flags != key.flags || header.keymasked != key.masked) return false;
+
+	uint32_t const pixelsize = key.width * key.height * 4;
+	if (header.compressed ? header.datasize == 0 : header.datasize != pixelsize) return false;
+
+	TArray<uint8_t> data = fr.Read(header.datasize);
+	if (data.Size() != header.datasize) return false;
+
+	// Same layout as CreateTexBuffer, which allocates an extra row.
+	uint8_t *pixels = new uint8_t[key.width * (key.height + 1) * 4];
+	memset(pixels + pixelsize, 0, key.width * 4);
+
+	bool ok;
+	if (header.compressed)
+	{
+		uLongf destlen = pixelsize;
+		ok = uncompress(pixels, &destlen, data.Data(), data.Size()) == Z_OK && destlen == pixelsize;
+	}
+	else
+	{
+		memcpy(pixels, data.Data(), pixelsize);
+		ok = true;
+	}
+
+	if (!ok || crc32(0, pixels, pixelsize) != header.pixelcrc)
+	{
+		delete[] pixels;
+		return false;
+	}
+
+	buffer.mBuffer = pixels;
+	buffer.mWidth = key.width;
+	buffer.mHeight = key.height;
+	masked = header.masked;
+	translucent = header.translucent;
+	return true;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void TexCache_Store(const FTexCacheKey &key, const FTextureBuffer &buffer, uint8_t masked, int8_t translucent)
+{
+	if (!r_texcache || buffer.mBuffer == nullptr) return;
+
+	uint32_t const pixelsize = key.width * key.height * 4;
+	int const level = clamp<int>(r_texcache_compression, 0, 9);
+
+	FTexCacheHeader header;
+	memcpy(header.magic, "RTXC", 4);
+	header.version = TEXCACHE_VERSION;
+	header.crc = key.crc;
+	header.size = key.size;
+	header.width = key.width;
+	header.height = key.height;
+	header.flags = key.flags;
+	header.keymasked = key.masked;
+	header.masked = masked;
+	header.translucent = translucent;
+	header.pixelcrc = crc32(0, buffer.mBuffer, pixelsize);
+
+	TArray<uint8_t> compressed;
+	const uint8_t *data = buffer.mBuffer;
+	header.compressed = 0;
+	header.datasize = pixelsize;
+
+	if (level > 0)
+	{
+		uLongf destlen = compressBound(pixelsize);
+		compressed.Resize(destlen);
+		if (compress2(compressed.Data(), &destlen, buffer.mBuffer, pixelsize, level) == Z_OK && destlen < pixelsize)
+		{
+			data = compressed.Data();
+			header.compressed = 1;
+			header.datasize = destlen;
+		}
+	}
+
+	// Write under a temporary name so that an interrupted write never leaves a file with the right name behind.
+	FString filename = TexCache_FileName(key);
+	FString tempname = filename + ".tmp";
+	FileWriter *fw = FileWriter::Open(tempname);
+	if (fw == nullptr) return;
+
+	bool ok = fw->Write(&header, sizeof(header)) == sizeof(header) && fw->Write(data, header.datasize) == header.datasize;
+	delete fw;
+
+	if (!ok || rename(tempname, filename) != 0)
+	{
+		remove(tempname);
+	}
+}
+
+//==========================================================================
+//
+// Deletes all cached textures.
+//
+//==========================================================================
+
+void texcache_invalidate(void)
+{
+	FString pattern = TexCache_Directory() + "*.tex";
+	findstate_t findstate;
+	void *handle = I_FindFirst(pattern, &findstate);
+	int count = 0;
+
+	if (handle != (void *)-1)
+	{
+		do
+		{
+			if (!(I_FindAttr(&findstate) & FA_DIREC))
+			{
+				FString filename = TexCache_Directory() + I_FindName(&findstate);
+				if (remove(filename) == 0) count++;
+			}
+		} while (I_FindNext(handle, &findstate) == 0);
+		I_FindClose(handle);
+	}
+	Printf("%d cached textures deleted\n", count);
+}
+
+CCMD(texcache_clear)
+{
+	texcache_invalidate();
+}
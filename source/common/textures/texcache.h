@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdint.h>
+#include "c_cvars.h"
+
+struct FTextureBuffer;
+
+EXTERN_CVAR(Bool, r_texcache)
+
+// Identifies a decoded image. See FImageSource::GetContentHash for how the
+// image file is identified.
+struct FTexCacheKey
+{
+	uint32_t crc;		// of the image file's path and modification time
+	uint32_t size;		// of the image file
+	int width, height;
+	int flags;			// CTF_ flags the buffer is created with
+	uint8_t masked;		// FTexture::bMasked before the buffer was created, it affects postprocessing
+};
+
+// Both are safe to call from worker threads.
+bool TexCache_Load(const FTexCacheKey &key, FTextureBuffer &buffer, uint8_t &masked, int8_t &translucent);
+void TexCache_Store(const FTexCacheKey &key, const FTextureBuffer &buffer, uint8_t masked, int8_t translucent);
@@ -39,6 +39,7 @@
 
 #include "bitmap.h"
 #include "image.h"
+#include "texcache.h"
 #include "palette.h"
 #include "../glbackend/gl_hwtexture.h"
 
@@ -297,6 +298,18 @@ FTextureBuffer FTexture::CreateTexBuffer(const PalEntry * remap, int flags)
 	W = GetWidth();
 	H = GetHeight();
 
+	FTexCacheKey cachekey;
+	bool usecache = false;
+	if ((flags & CTF_UseCache) && r_texcache && !checkonly && remap == nullptr && GetImage() != nullptr)
+	{
+		cachekey.width = W;
+		cachekey.height = H;
+		cachekey.flags = flags & ~CTF_UseCache;
+		cachekey.masked = bMasked;
+		usecache = GetImage()->GetContentHash(cachekey.crc, cachekey.size);
+		if (usecache && TexCache_Load(cachekey, result, bMasked, bTranslucent)) return result;
+	}
+
 	if (!checkonly)
 	{
 		buffer = new unsigned char[W*(H + 1) * 4];
@@ -330,6 +343,7 @@ FTextureBuffer FTexture::CreateTexBuffer(const PalEntry * remap, int flags)
 		if (!checkonly) ProcessData(result.mBuffer, result.mWidth, result.mHeight, false);
 	}
 
+	if (usecache) TexCache_Store(cachekey, result, bMasked, bTranslucent);
 	return result;
 }
 
@@ -70,6 +70,7 @@ enum ECreateTexBufferFlags
 	CTF_Expand = 2,			// create buffer with a one-pixel wide border
 	CTF_ProcessData = 4,	// run postprocessing on the generated buffer. This is only needed when using the data for a hardware texture.
 	CTF_CheckOnly = 8,		// Only runs the code to get a content ID but does not create a texture. Can be used to access a caching system for the hardware textures.
+	CTF_UseCache = 16,		// look up and store the result in the texture cache (see texcache.cpp). Only works for image textures without remap.
 };
 
 enum
@@ -0,0 +1,150 @@
+/*
+**
+** timedemo.cpp
+** Timing statistics for -timedemo and -benchdemo
+**
+** The games' demo players call into this to measure every game tick and
+** every drawn frame. At the end of the demo a summary with percentiles is
+** printed along with a checksum of the game state so that both
+** performance regressions and desyncs can be caught by automated runs.
+**
+*/
+
+#include <algorithm>
+#include "build.h"
+#include "gamecontrol.h"
+#include "timedemo.h"
+#include "tarray.h"
+#include "printf.h"
+#include "m_crc32.h"
+#include "timer.h"
+
+struct FTimeDemoTimer
+{
+	TArray<double> Times;
+	double Start;
+
+	void Begin()
+	{
+		Start = timerGetHiTicks();
+	}
+
+	void End()
+	{
+		Times.Push(timerGetHiTicks() - Start);
+	}
+
+	void Report(const char *what)
+	{
+		if (Times.Size() == 0) return;
+
+		double total = 0;
+		for (auto t : Times) total += t;
+
+		std::sort(Times.begin(), Times.end());
+		auto percentile = [&](double p) { return Times[std::min<unsigned>(unsigned(Times.Size() * p), Times.Size() - 1)]; };
+
+		Printf("%u %s in %.3f s, %.1f %s/s\n", Times.Size(), what, total / 1000., Times.Size() * 1000. / std::max(total, 0.001), what);
+		Printf("  min %.3f ms, avg %.3f ms, 50%% %.3f ms, 95%% %.3f ms, 99%% %.3f ms, max %.3f ms\n",
+			Times[0], total / Times.Size(), percentile(0.5), percentile(0.95), percentile(0.99), Times.Last());
+	}
+};
+
+static FTimeDemoTimer tickTimer, frameTimer;
+static double timedemoStart = -1;
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+bool TimeDemo_Active()
+{
+	return userConfig.timedemo != TIMEDEMO_OFF;
+}
+
+bool TimeDemo_ShouldRender()
+{
+	return userConfig.timedemo != TIMEDEMO_NORENDER;
+}
+
+void TimeDemo_TickBegin()
+{
+	if (timedemoStart < 0) timedemoStart = timerGetHiTicks();
+	tickTimer.Begin();
+}
+
+void TimeDemo_TickEnd()
+{
+	tickTimer.End();
+}
+
+void TimeDemo_FrameBegin()
+{
+	frameTimer.Begin();
+}
+
+void TimeDemo_FrameEnd()
+{
+	frameTimer.End();
+}
+
+//==========================================================================
+//
+// Only uses state that is common to all games and does not depend on
+// the renderer. The order of the sprites in the status lists is included
+// because it affects the order in which the game processes them.
+//
+//==========================================================================
+
+uint32_t TimeDemo_Checksum()
+{
+	uint32_t crc = 0;
+	auto add = [&](const void *data, size_t len) { crc = AddCRC32(crc, (const uint8_t *)data, (unsigned)len); };
+
+	add(&randomseed, sizeof(randomseed));
+
+	for (int i = 0; i < numsectors; i++)
+	{
+		int32_t const s[] = { sector[i].ceilingz, sector[i].floorz, sector[i].ceilingheinum, sector[i].floorheinum, sector[i].lotag, sector[i].hitag };
+		add(s, sizeof(s));
+	}
+
+	for (int i = 0; i < numwalls; i++)
+	{
+		int32_t const w[] = { wall[i].x, wall[i].y, wall[i].picnum, wall[i].cstat };
+		add(w, sizeof(w));
+	}
+
+	for (int stat = 0; stat < MAXSTATUS; stat++)
+	{
+		for (int i = headspritestat[stat]; i >= 0; i = nextspritestat[i])
+		{
+			auto const &spr = sprite[i];
+			int32_t const s[] = { i, spr.x, spr.y, spr.z, spr.ang, spr.picnum, spr.sectnum, spr.statnum, spr.cstat, spr.xvel, spr.zvel, spr.extra };
+			add(s, sizeof(s));
+		}
+	}
+	return crc;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void TimeDemo_Report(const char *demoname)
+{
+	Printf("Timedemo %s:\n", demoname);
+	tickTimer.Report("ticks");
+	frameTimer.Report("frames");
+	if (timedemoStart >= 0)
+		Printf("Total time %.3f s\n", (timerGetHiTicks() - timedemoStart) / 1000.);
+	Printf("Game state checksum: %08x\n", TimeDemo_Checksum());
+
+	tickTimer.Times.Clear();
+	frameTimer.Times.Clear();
+	timedemoStart = -1;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+
+// -timedemo and -benchdemo run a demo's game ticks back to back without
+// waiting for the real time clock and print timing statistics at the end.
+enum ETimeDemo
+{
+	TIMEDEMO_OFF,
+	TIMEDEMO_RENDER,	// -timedemo: one frame is drawn after each tick
+	TIMEDEMO_NORENDER,	// -benchdemo: nothing gets drawn
+};
+
+bool TimeDemo_Active();
+bool TimeDemo_ShouldRender();
+
+void TimeDemo_TickBegin();
+void TimeDemo_TickEnd();
+void TimeDemo_FrameBegin();
+void TimeDemo_FrameEnd();
+
+// Prints the statistics and a checksum of the current game state. The game is responsible for exiting afterward.
+void TimeDemo_Report(const char *demoname);
+uint32_t TimeDemo_Checksum();
@@ -33,6 +33,17 @@
 **
 */
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "files.h"
 #include "templates.h"	// just for 'clamp'
 #include "zstring.h"
@@ -350,6 +361,84 @@ public:
 
 
 
+//==========================================================================
+//
+// MappedFileReader
+//
+// reads data from a memory mapping of an entire file.
+// The mapping is private and copy-on-write so that anyone handed a pointer
+// into it can patch the data in place without affecting the file or any
+// other process.
+//
+//==========================================================================
+
+class MappedFileReader : public MemoryReader
+{
+#ifdef _WIN32
+	HANDLE Mapping = nullptr;
+#endif
+
+public:
+	~MappedFileReader()
+	{
+		if (bufptr == nullptr) return;
+#ifdef _WIN32
+		UnmapViewOfFile(bufptr);
+		CloseHandle(Mapping);
+#else
+		munmap((void*)bufptr, Length);
+#endif
+	}
+
+	bool Open(const char *filename)
+	{
+#ifdef _WIN32
+		auto widename = WideString(filename);
+		HANDLE file = CreateFileW(widename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0 || size.QuadPart > LONG_MAX)
+		{
+			CloseHandle(file);
+			return false;
+		}
+		Mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		CloseHandle(file);	// the mapping keeps its own reference to the file.
+		if (Mapping == nullptr) return false;
+
+		void *view = MapViewOfFile(Mapping, FILE_MAP_COPY, 0, 0, 0);
+		if (view == nullptr)
+		{
+			CloseHandle(Mapping);
+			Mapping = nullptr;
+			return false;
+		}
+		Length = (long)size.QuadPart;
+#else
+		int fd = open(filename, O_RDONLY);
+		if (fd < 0) return false;
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 || (uint64_t)st.st_size > LONG_MAX)
+		{
+			close(fd);
+			return false;
+		}
+		void *view = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		close(fd);	// the mapping keeps its own reference to the file.
+		if (view == MAP_FAILED) return false;
+		Length = (long)st.st_size;
+#endif
+		bufptr = (const char*)view;
+		FilePos = 0;
+		return true;
+	}
+
+	bool IsMapped() const override { return true; }
+};
+
+
 //==========================================================================
 //
 // FileReader
@@ -371,6 +460,19 @@ bool FileReader::OpenFile(const char *filename, FileReader::Size start, FileRead
 	return true;
 }
 
+bool FileReader::OpenMappedFile(const char *filename)
+{
+	auto reader = new MappedFileReader;
+	if (!reader->Open(filename))
+	{
+		delete reader;
+		return false;
+	}
+	Close();
+	mReader = reader;
+	return true;
+}
+
 bool FileReader::OpenFilePart(FileReader &parent, FileReader::Size start, FileReader::Size length)
 {
 	auto reader = new FileReaderRedirect(parent, (long)start, (long)length);
@@ -71,6 +71,7 @@ public:
 	virtual long Read (void *buffer, long len) = 0;
 	virtual char *Gets(char *strbuf, int len) = 0;
 	virtual const char *GetBuffer() const { return nullptr; }
+	virtual bool IsMapped() const { return false; }
 	long GetLength () const { return Length; }
 };
 
@@ -168,6 +169,7 @@ public:
 	}
 
 	bool OpenFile(const char *filename, Size start = 0, Size length = -1);
+	bool OpenMappedFile(const char *filename);	// maps the entire file into memory, GetBuffer returns the mapping.
 	bool OpenFilePart(FileReader &parent, Size start, Size length);
 	bool OpenMemory(const void *mem, Size length);	// read directly from the buffer
 	bool OpenMemoryArray(const void *mem, Size length);	// read from a copy of the buffer.
@@ -224,6 +226,11 @@ public:
 		return mReader->GetBuffer();
 	}
 
+	bool IsMapped() const
+	{
+		return mReader->IsMapped();
+	}
+
 	Size GetLength() const
 	{
 		return mReader->GetLength();
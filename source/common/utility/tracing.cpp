@@ -0,0 +1,198 @@
+//-------------------------------------------------------------------------
+/*
+** tracing.cpp
+**
+** Records timed zones into per-thread ring buffers and writes them out
+** in the Chrome trace event format.
+**
+** Each buffer has exactly one writer, its owning thread, which publishes
+** new events by advancing the buffer's head. The dump runs concurrently
+** with the writers and discards everything that may have been overwritten
+** while it was copying, so recording never needs to take a lock.
+**
+*/
+//-------------------------------------------------------------------------
+
+#include <chrono>
+#include <mutex>
+#include "tracing.h"
+#include "tarray.h"
+#include "files.h"
+#include "c_cvars.h"
+#include "c_dispatch.h"
+#include "printf.h"
+#include "i_specialpaths.h"
+
+enum
+{
+	TRACE_BUFFERSIZE = 1 << 16,		// events per thread, must be a power of 2
+};
+
+struct FTraceEvent
+{
+	const char *Name;
+	uint64_t Start, End;
+};
+
+struct FTraceBuffer
+{
+	FTraceEvent Events[TRACE_BUFFERSIZE];
+	std::atomic<uint64_t> Head{ 0 };
+	int ThreadIndex;
+};
+
+std::atomic<bool> TraceActive{ false };
+
+// Buffers are never freed so that a dump can still read the ones of threads that have already exited.
+static TArray<FTraceBuffer *> TraceBuffers;
+static std::mutex TraceBufferLock;
+static thread_local FTraceBuffer *ThreadTraceBuffer;
+static std::atomic<uint64_t> TraceClearTime{ 0 };
+
+CUSTOM_CVARD(Bool, trace_enable, false, 0, "record timed zones of the engine for trace_dump")
+{
+	TraceActive.store(self, std::memory_order_relaxed);
+}
+
+uint64_t Trace_Now()
+{
+	using namespace std::chrono;
+	return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static FTraceBuffer *Trace_GetBuffer()
+{
+	if (ThreadTraceBuffer == nullptr)
+	{
+		auto buffer = new FTraceBuffer;
+		std::lock_guard<std::mutex> lock(TraceBufferLock);
+		buffer->ThreadIndex = TraceBuffers.Size();
+		TraceBuffers.Push(buffer);
+		ThreadTraceBuffer = buffer;
+	}
+	return ThreadTraceBuffer;
+}
+
+void Trace_Record(const char *name, uint64_t start, uint64_t end)
+{
+	auto buffer = Trace_GetBuffer();
+	uint64_t head = buffer->Head.load(std::memory_order_relaxed);
+	buffer->Events[head & (TRACE_BUFFERSIZE - 1)] = { name, start, end };
+	buffer->Head.store(head + 1, std::memory_order_release);
+}
+
+//==========================================================================
+//
+// Copies the events of one buffer which are guaranteed not to have been
+// overwritten by its thread during the copy.
+//
+//==========================================================================
+
+static void Trace_CopyEvents(FTraceBuffer *buffer, TArray<FTraceEvent> &events)
+{
+	uint64_t const head = buffer->Head.load(std::memory_order_acquire);
+	uint64_t const first = head > TRACE_BUFFERSIZE ? head - TRACE_BUFFERSIZE : 0;
+
+	TArray<FTraceEvent> copy(unsigned(head - first), true);
+	for (uint64_t i = first; i < head; i++)
+		copy[unsigned(i - first)] = buffer->Events[i & (TRACE_BUFFERSIZE - 1)];
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+	uint64_t const newhead = buffer->Head.load(std::memory_order_relaxed);
+	// The thread may already be writing event newhead, which reuses the slot of newhead - TRACE_BUFFERSIZE.
+	uint64_t const valid = newhead + 1 > TRACE_BUFFERSIZE ? newhead + 1 - TRACE_BUFFERSIZE : 0;
+
+	uint64_t const cleartime = TraceClearTime.load(std::memory_order_relaxed);
+	for (uint64_t i = std::max(first, valid); i < head; i++)
+	{
+		if (copy[unsigned(i - first)].Start >= cleartime)
+			events.Push(copy[unsigned(i - first)]);
+	}
+}
+
+//==========================================================================
+//
+// Writes everything currently in the buffers as a Chrome trace file.
+//
+//==========================================================================
+
+static bool Trace_Write(const char *filename, int *numevents)
+{
+	TArray<FTraceBuffer *> buffers;
+	{
+		std::lock_guard<std::mutex> lock(TraceBufferLock);
+		buffers = TraceBuffers;
+	}
+
+	TArray<TArray<FTraceEvent>> threadevents(buffers.Size(), true);
+	uint64_t base = UINT64_MAX;
+	for (unsigned i = 0; i < buffers.Size(); i++)
+	{
+		Trace_CopyEvents(buffers[i], threadevents[i]);
+		for (auto &ev : threadevents[i])
+			base = std::min(base, ev.Start);
+	}
+
+	FileWriter *fw = FileWriter::Open(filename);
+	if (fw == nullptr)
+		return false;
+
+	*numevents = 0;
+	const char *separator = "";
+	fw->Printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for (unsigned i = 0; i < buffers.Size(); i++)
+	{
+		int const tid = buffers[i]->ThreadIndex;
+		if (tid == 0)
+			fw->Printf("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Main\"}}", separator, tid);
+		else
+			fw->Printf("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Thread %d\"}}", separator, tid, tid);
+		separator = ",\n";
+
+		for (auto &ev : threadevents[i])
+		{
+			fw->Printf(",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", ev.Name, tid,
+				(ev.Start - base) / 1000., (ev.End - ev.Start) / 1000.);
+		}
+		*numevents += threadevents[i].Size();
+	}
+	fw->Printf("\n]}\n");
+	delete fw;
+	return true;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+CCMD(trace_dump)
+{
+	FString filename;
+	if (argv.argc() > 1) filename = argv[1];
+	else filename.Format("%strace.json", M_GetDocumentsPath().GetChars());
+
+	if (!trace_enable)
+		Printf("trace_enable is off, the dump only contains previously recorded zones.\n");
+
+	int numevents = 0;
+	if (!Trace_Write(filename, &numevents))
+	{
+		Printf("Unable to open %s for writing\n", filename.GetChars());
+		return;
+	}
+	Printf("%d zones written to %s\n", numevents, filename.GetChars());
+}
+
+CCMD(trace_clear)
+{
+	// The buffers belong to their threads, so this only hides what was recorded so far.
+	TraceClearTime.store(Trace_Now(), std::memory_order_relaxed);
+}
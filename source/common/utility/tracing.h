@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+//==========================================================================
+//
+// Timeline tracing of the engine's hot paths.
+//
+// While trace_enable is set, every TRACE_ZONE records its start and end
+// time into a ring buffer owned by the current thread. trace_dump writes
+// the recorded zones as a Chrome trace event file which can be opened in
+// chrome://tracing or ui.perfetto.dev.
+//
+// Zone names must be string literals or otherwise outlive the trace.
+//
+//==========================================================================
+
+extern std::atomic<bool> TraceActive;
+
+uint64_t Trace_Now();
+void Trace_Record(const char *name, uint64_t start, uint64_t end);
+
+class FTraceZone
+{
+public:
+	FTraceZone(const char *name)
+	{
+		Name = TraceActive.load(std::memory_order_relaxed) ? name : nullptr;
+		if (Name) Start = Trace_Now();
+	}
+
+	~FTraceZone()
+	{
+		if (Name) Trace_Record(Name, Start, Trace_Now());
+	}
+
+	FTraceZone(const FTraceZone &) = delete;
+	FTraceZone &operator=(const FTraceZone &) = delete;
+
+private:
+	const char *Name;
+	uint64_t Start;
+};
+
+#define TRACE_ZONE_CONCAT2(a, b) a##b
+#define TRACE_ZONE_CONCAT(a, b) TRACE_ZONE_CONCAT2(a, b)
+#define TRACE_ZONE(name) FTraceZone TRACE_ZONE_CONCAT(tracezone_, __LINE__)(name)
@@ -0,0 +1,133 @@
+//-------------------------------------------------------------------------
+/*
+** workerpool.cpp
+**
+** Persistent worker threads for splitting CPU heavy work into slices.
+**
+*/
+//-------------------------------------------------------------------------
+
+#include <algorithm>
+#include "workerpool.h"
+
+FWorkerPool::~FWorkerPool()
+{
+	StopThreads();
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void FWorkerPool::SetNumThreads(int num)
+{
+	if (num < 1) num = 1;
+	if (num == NumThreads()) return;
+
+	StopThreads();
+	Quit = false;
+	for (int i = 1; i < num; i++)
+	{
+		Threads.emplace_back([this]() { WorkerMain(); });
+	}
+}
+
+void FWorkerPool::StopThreads()
+{
+	{
+		std::lock_guard<std::mutex> lock(Lock);
+		Quit = true;
+	}
+	WorkReady.notify_all();
+	for (auto &thread : Threads) thread.join();
+	Threads.clear();
+}
+
+//==========================================================================
+//
+// Slices are handed out through an atomic counter so that faster threads
+// pick up the remaining work of slower ones.
+//
+//==========================================================================
+
+void FWorkerPool::RunSlices()
+{
+	int slice;
+	while ((slice = NextSlice.fetch_add(1)) < NumSlices)
+	{
+		(*Func)(slice);
+	}
+}
+
+void FWorkerPool::WorkerMain()
+{
+	unsigned seen = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(Lock);
+			WorkReady.wait(lock, [&]() { return Quit || Generation != seen; });
+			if (Quit) return;
+			seen = Generation;
+			Active++;
+		}
+
+		RunSlices();
+
+		{
+			std::lock_guard<std::mutex> lock(Lock);
+			Active--;
+		}
+		WorkDone.notify_one();
+	}
+}
+
+//==========================================================================
+//
+// The job's state must not change until every worker that has seen it
+// is done with it, so Run waits for all of them, not just for the slices.
+//
+//==========================================================================
+
+void FWorkerPool::Run(int numslices, const std::function<void(int)> &func)
+{
+	if (numslices <= 0) return;
+
+	if (Threads.size() == 0 || numslices == 1)
+	{
+		for (int i = 0; i < numslices; i++) func(i);
+		return;
+	}
+
+	{
+		// A worker that woke up too late for the previous job may still be looking at it.
+		std::unique_lock<std::mutex> lock(Lock);
+		WorkDone.wait(lock, [&]() { return Active == 0; });
+		Func = &func;
+		NumSlices = numslices;
+		NextSlice = 0;
+		Generation++;
+	}
+	WorkReady.notify_all();
+
+	RunSlices();
+
+	std::unique_lock<std::mutex> lock(Lock);
+	WorkDone.wait(lock, [&]() { return Active == 0; });
+	Func = nullptr;
+	NumSlices = 0;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+int I_GetWorkerThreadCount(int setting)
+{
+	if (setting > 0) return setting;
+	return std::max<int>(std::thread::hardware_concurrency(), 1);
+}
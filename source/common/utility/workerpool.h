@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//==========================================================================
+//
+// A small pool of persistent worker threads for splitting a job into
+// independent slices. The calling thread always takes part in the work
+// and Run only returns after all slices have been processed.
+//
+//==========================================================================
+
+class FWorkerPool
+{
+public:
+	FWorkerPool() = default;
+	FWorkerPool(const FWorkerPool &) = delete;
+	FWorkerPool &operator=(const FWorkerPool &) = delete;
+	~FWorkerPool();
+
+	// Total number of threads working on a job, including the calling one.
+	void SetNumThreads(int num);
+	int NumThreads() const { return int(Threads.size()) + 1; }
+
+	void Run(int numslices, const std::function<void(int)> &func);
+
+private:
+	void StopThreads();
+	void WorkerMain();
+	void RunSlices();
+
+	std::vector<std::thread> Threads;
+	std::mutex Lock;
+	std::condition_variable WorkReady, WorkDone;
+
+	const std::function<void(int)> *Func = nullptr;
+	int NumSlices = 0;
+	std::atomic<int> NextSlice{ 0 };
+	int Active = 0;		// workers currently looking at the job, protected by Lock
+	unsigned Generation = 0;
+	bool Quit = false;
+};
+
+// Returns the number of threads to use for a user setting where 0 or less means 'one per core'.
+int I_GetWorkerThreadCount(int setting);
@@ -26,6 +26,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "duke3d.h"
 #include "sounds.h"
+#include "tracing.h"
 
 BEGIN_DUKE_NS
 
@@ -8584,6 +8585,7 @@ static void G_DoEventGame(int const nEventID)
 
 void G_MoveWorld(void)
 {
+    TRACE_ZONE("G_MoveWorld");
     extern double g_moveActorsTime, g_moveWorldTime;
     const double worldTime = timerGetHiTicks();
 
@@ -28,6 +28,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "baselayer.h"
 #include "cmdline.h"
 #include "m_argv.h"
+#include "timedemo.h"
 #include "printf.h"
 #include "c_dispatch.h"
 
@@ -95,6 +96,13 @@ void G_CheckCommandLine()
 		}
 		Printf("Respawn on.\n");
 	}
+	if (TimeDemo_Active())
+	{
+		// The profiling mode already runs the game tics back to back.
+		Demo_SetFirst(userConfig.CommandDemo);
+		Demo_PlayFirst(TimeDemo_ShouldRender() ? 2 : 1, 1);
+		g_noLogo = 1;
+	}
 }
 
 END_DUKE_NS
@@ -0,0 +1,482 @@
+//-------------------------------------------------------------------------
+/*
+** concache.cpp
+**
+** Writes compiled CON code to a cache file and restores it on the next
+** startup if none of the CON files have changed.
+**
+** The compiled code contains absolute pointers, so these are stored as
+** offsets into the script. Everything the compiler passes on to other
+** parts of the game is recorded in a journal while compiling and replayed
+** through the same functions when the cache is loaded.
+**
+*/
+//-------------------------------------------------------------------------
+
+#include "ns.h"	// Must come before everything else!
+
+#include "duke3d.h"
+#include "concache.h"
+#include "m_crc32.h"
+#include "c_cvars.h"
+#include "files.h"
+#include "printf.h"
+#include "version.h"
+#include "gamecontrol.h"
+#include "m_argv.h"
+#include "i_specialpaths.h"
+
+BEGIN_DUKE_NS
+
+enum
+{
+    CONCACHE_VERSION = 1,
+};
+
+static const char conCacheMagic[4] = { 'D', 'C', 'O', 'N' };
+
+CVARD(Bool, con_cache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "keep compiled CON code in a cache to speed up startup")
+
+struct concachefile_t
+{
+    FString name;
+    uint32_t length, crc;
+};
+
+static bool recording;
+static TArray<concachefile_t> cacheFiles;
+static TArray<uint8_t> cacheJournal;
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+class FConCacheWriter
+{
+public:
+    TArray<uint8_t> &Data;
+
+    FConCacheWriter(TArray<uint8_t> &data) : Data(data) {}
+
+    void Write(const void *src, size_t len)
+    {
+        if (len > 0) memcpy(&Data[Data.Reserve((unsigned)len)], src, len);
+    }
+
+    void WriteInt(int32_t v)
+    {
+        Write(&v, sizeof(v));
+    }
+
+    void WriteString(const char *str)
+    {
+        int32_t const len = (int32_t)strlen(str);
+        WriteInt(len);
+        Write(str, len);
+    }
+};
+
+class FConCacheReader
+{
+    const uint8_t *pos, *end;
+
+public:
+    bool ok = true;
+
+    FConCacheReader(const uint8_t *data, size_t len) : pos(data), end(data + len) {}
+
+    const uint8_t *Skip(size_t len)
+    {
+        if (!ok || size_t(end - pos) < len)
+        {
+            ok = false;
+            return nullptr;
+        }
+        auto const p = pos;
+        pos += len;
+        return p;
+    }
+
+    void Read(void *dest, size_t len)
+    {
+        auto const p = Skip(len);
+        if (p) memcpy(dest, p, len);
+        else memset(dest, 0, len);
+    }
+
+    int32_t ReadInt()
+    {
+        int32_t v;
+        Read(&v, sizeof(v));
+        return v;
+    }
+
+    FString ReadString()
+    {
+        int32_t const len = ReadInt();
+        auto const p = len >= 0 ? Skip(len) : nullptr;
+        if (p == nullptr)
+        {
+            ok = false;
+            return "";
+        }
+        return FString((const char *)p, len);
+    }
+
+    bool AtEnd() const
+    {
+        return pos == end;
+    }
+};
+
+//==========================================================================
+//
+// The cache is only valid for the same set of main CON files and game.
+//
+//==========================================================================
+
+static FString C_CacheRootFiles(const char *fileName)
+{
+    FString roots = fileName;
+    if (userConfig.AddCons) for (FString &m : *userConfig.AddCons.get())
+        roots.AppendFormat("\n%s", m.GetChars());
+    return roots;
+}
+
+static FString C_CachePath(FString const &roots)
+{
+    uint32_t const crc = Bcrc32(roots.GetChars(), (int)roots.Len(), Bcrc32(&g_gameType, sizeof(g_gameType), 0));
+    return FStringf("%s/concache_%08x.bin", M_GetAppDataPath(true).GetChars(), crc);
+}
+
+static FString C_CacheEngineVersion(void)
+{
+    return FStringf("%s %s", GetVersionString(), GetGitHash());
+}
+
+//==========================================================================
+//
+// Recording during compilation
+//
+//==========================================================================
+
+void C_CacheBeginRecording(void)
+{
+    recording = con_cache;
+    cacheFiles.Clear();
+    cacheJournal.Clear();
+}
+
+void C_CacheEndRecording(void)
+{
+    recording = false;
+    cacheFiles.Reset();
+    cacheJournal.Reset();
+}
+
+void C_CacheAddFile(const char *fileName, const char *data, int length)
+{
+    if (recording)
+        cacheFiles.Push({ fileName, (uint32_t)length, Bcrc32(data, length, 0) });
+}
+
+void C_CacheRecordOp(int op, const int32_t *args, int numArgs, const char *string)
+{
+    if (!recording)
+        return;
+
+    FConCacheWriter w(cacheJournal);
+    w.WriteInt(op);
+    w.WriteInt(numArgs);
+    w.Write(args, numArgs * sizeof(int32_t));
+    w.WriteString(string ? string : "");
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void C_CacheSave(const char *fileName)
+{
+    if (!recording)
+        return;
+
+    TArray<uint8_t> data;
+    FConCacheWriter w(data);
+
+    FString const roots = C_CacheRootFiles(fileName);
+
+    w.Write(conCacheMagic, sizeof(conCacheMagic));
+    w.WriteInt(CONCACHE_VERSION);
+    w.WriteInt(sizeof(intptr_t));
+    w.WriteString(C_CacheEngineVersion());
+    w.WriteInt(g_gameType);
+    w.WriteString(roots);
+
+    w.WriteInt(cacheFiles.Size());
+    for (auto &file : cacheFiles)
+    {
+        w.WriteString(file.name);
+        w.WriteInt(file.length);
+        w.WriteInt(file.crc);
+    }
+
+    // Byte code, with all pointers turned into script offsets.
+    w.WriteInt(g_scriptSize);
+    w.WriteInt(int32_t(g_scriptPtr - apScript));
+    for (int i = 0; i < g_scriptSize; i++)
+    {
+        intptr_t word = apScript[i];
+        if (bitmap_test(bitptr, i))
+            word -= (intptr_t)apScript;
+        w.Write(&word, sizeof(word));
+    }
+    w.Write(bitptr, ((g_scriptSize + 7) >> 3) + 1);
+
+    for (auto &tile : g_tile)
+    {
+        w.WriteInt(tile.execPtr ? int32_t(tile.execPtr - apScript) : -1);
+        w.WriteInt(tile.loadPtr ? int32_t(tile.loadPtr - apScript) : -1);
+        w.WriteInt(tile.flags);
+        w.WriteInt(tile.cacherange);
+    }
+
+    w.WriteInt(g_labelCnt);
+    w.Write(label, g_labelCnt << 6);
+    w.Write(labelcode, g_labelCnt * sizeof(int32_t));
+    w.Write(labeltype, g_labelCnt * sizeof(int32_t));
+
+    w.Write(apScriptEvents, sizeof(apScriptEvents));
+    w.WriteInt(g_scriptVersion);
+    w.WriteInt(g_scriptcrc);
+    w.WriteInt(g_numXStrings);
+    w.WriteInt(g_totalLines);
+
+    w.Write(CheatStrings, sizeof(CheatStrings));
+    w.Write(CheatDescriptions, sizeof(CheatDescriptions));
+    w.Write(CheatKeys, sizeof(CheatKeys));
+    w.Write(g_gametypeNames, sizeof(g_gametypeNames));
+    w.Write(g_gametypeFlags, sizeof(g_gametypeFlags));
+    w.WriteInt(g_gametypeCnt);
+
+    w.WriteInt(cacheJournal.Size());
+    w.Write(cacheJournal.Data(), cacheJournal.Size());
+
+    w.WriteInt(Bcrc32(data.Data(), data.Size(), 0));
+
+    FString const path = C_CachePath(roots);
+    FileWriter *fw = FileWriter::Open(path);
+    if (fw == nullptr)
+    {
+        DPrintf(DMSG_NOTIFY, "Unable to write CON cache %s\n", path.GetChars());
+        return;
+    }
+    fw->Write(data.Data(), data.Size());
+    delete fw;
+}
+
+//==========================================================================
+//
+// Checks that every CON file the cache was made from is still the same.
+// The main file has already been read by the caller.
+//
+//==========================================================================
+
+static bool C_CacheCheckFiles(FConCacheReader &r, const char *data, int length)
+{
+    int const numFiles = r.ReadInt();
+    if (!r.ok || numFiles < 1)
+        return false;
+
+    for (int i = 0; i < numFiles; i++)
+    {
+        FString const name = r.ReadString();
+        uint32_t const fileLength = r.ReadInt();
+        uint32_t const fileCrc = r.ReadInt();
+        if (!r.ok)
+            return false;
+
+        if (i == 0)
+        {
+            if (fileLength != (uint32_t)length || fileCrc != Bcrc32(data, length, 0))
+                return false;
+            continue;
+        }
+
+        auto fr = fileSystem.OpenFileReader(name, 0);
+        if (!fr.isOpen() || fr.GetLength() != (long)fileLength)
+            return false;
+
+        auto const contents = fr.Read();
+        if (contents.Size() != fileLength || Bcrc32(contents.Data(), contents.Size(), 0) != fileCrc)
+            return false;
+    }
+    return true;
+}
+
+//==========================================================================
+//
+// Walks the journal once without replaying it so that a damaged cache
+// can be rejected before anything has been changed.
+//
+//==========================================================================
+
+static bool C_CacheReplayJournal(const uint8_t *journal, size_t length, bool replay)
+{
+    FConCacheReader r(journal, length);
+    TArray<int32_t> args;
+
+    while (r.ok && !r.AtEnd())
+    {
+        int const op = r.ReadInt();
+        int const numArgs = r.ReadInt();
+        if (!r.ok || numArgs < 0 || numArgs > 64)
+            return false;
+
+        args.Resize(numArgs);
+        r.Read(args.Data(), numArgs * sizeof(int32_t));
+        FString const string = r.ReadString();
+
+        if (r.ok && replay)
+            C_ReplayCompileOp(op, args.Data(), numArgs, string);
+    }
+    return r.ok;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+bool C_CacheLoad(const char *fileName, const char *data, int length)
+{
+    if (!con_cache)
+        return false;
+
+    FString const roots = C_CacheRootFiles(fileName);
+
+    FileReader fr;
+    if (!fr.OpenFile(C_CachePath(roots)))
+        return false;
+
+    auto const cache = fr.Read();
+    fr.Close();
+
+    if (cache.Size() < sizeof(conCacheMagic) + sizeof(uint32_t))
+        return false;
+
+    uint32_t storedCrc;
+    memcpy(&storedCrc, &cache[cache.Size() - sizeof(uint32_t)], sizeof(uint32_t));
+    if (storedCrc != Bcrc32(cache.Data(), cache.Size() - sizeof(uint32_t), 0))
+        return false;
+
+    FConCacheReader r(cache.Data(), cache.Size() - sizeof(uint32_t));
+
+    char magic[4];
+    r.Read(magic, sizeof(magic));
+    if (memcmp(magic, conCacheMagic, sizeof(magic)) || r.ReadInt() != CONCACHE_VERSION || r.ReadInt() != sizeof(intptr_t))
+        return false;
+
+    if (r.ReadString().Compare(C_CacheEngineVersion()) || r.ReadInt() != g_gameType || r.ReadString().Compare(roots))
+        return false;
+
+    if (!C_CacheCheckFiles(r, data, length))
+        return false;
+
+    int const scriptSize = r.ReadInt();
+    int const scriptPtrOfs = r.ReadInt();
+    if (!r.ok || scriptSize <= 0 || scriptPtrOfs < 0 || scriptPtrOfs > scriptSize)
+        return false;
+
+    auto const scriptWords = (const intptr_t *)r.Skip(scriptSize * sizeof(intptr_t));
+    size_t const bitptrSize = ((scriptSize + 7) >> 3) + 1;
+    auto const scriptBits = r.Skip(bitptrSize);
+    TArray<int32_t> tileData(MAXTILES * 4, true);
+    r.Read(tileData.Data(), tileData.Size() * sizeof(int32_t));
+
+    int const labelCnt = r.ReadInt();
+    if (!r.ok || labelCnt < 0 || (uint32_t)labelCnt > MAXSPRITES * sizeof(spritetype) / 64)
+        return false;
+
+    auto const labelData = r.Skip(labelCnt << 6);
+    auto const labelCodes = r.Skip(labelCnt * sizeof(int32_t));
+    auto const labelTypes = r.Skip(labelCnt * sizeof(int32_t));
+
+    intptr_t scriptEvents[MAXEVENTS];
+    r.Read(scriptEvents, sizeof(scriptEvents));
+    int32_t const scriptVersion = r.ReadInt();
+    uint32_t const scriptCrc = r.ReadInt();
+    int32_t const numXStrings = r.ReadInt();
+    int32_t const totalLines = r.ReadInt();
+
+    auto const cheatStrings = r.Skip(sizeof(CheatStrings));
+    auto const cheatDescriptions = r.Skip(sizeof(CheatDescriptions));
+    auto const cheatKeys = r.Skip(sizeof(CheatKeys));
+    auto const gametypeNames = r.Skip(sizeof(g_gametypeNames));
+    auto const gametypeFlags = r.Skip(sizeof(g_gametypeFlags));
+    int32_t const gametypeCnt = r.ReadInt();
+
+    size_t const journalSize = (uint32_t)r.ReadInt();
+    auto const journal = r.Skip(journalSize);
+
+    if (!r.ok || !r.AtEnd() || !C_CacheReplayJournal(journal, journalSize, false))
+        return false;
+
+    // Everything has been validated, from here on the cache can't fail anymore.
+    Xfree(apScript);
+    Xfree(bitptr);
+
+    apScript = (intptr_t *)Xmalloc(scriptSize * sizeof(intptr_t));
+    bitptr = (uint8_t *)Xmalloc(bitptrSize);
+    memcpy(apScript, scriptWords, scriptSize * sizeof(intptr_t));
+    memcpy(bitptr, scriptBits, bitptrSize);
+
+    for (int i = 0; i < scriptSize; i++)
+    {
+        if (bitmap_test(bitptr, i))
+            apScript[i] += (intptr_t)apScript;
+    }
+
+    g_scriptSize = scriptSize;
+    g_scriptPtr = apScript + scriptPtrOfs;
+
+    g_labelCnt = labelCnt;
+    memcpy(label, labelData, labelCnt << 6);
+    memcpy(labelcode, labelCodes, labelCnt * sizeof(int32_t));
+    memcpy(labeltype, labelTypes, labelCnt * sizeof(int32_t));
+
+    memcpy(apScriptEvents, scriptEvents, sizeof(apScriptEvents));
+
+    C_CacheReplayJournal(journal, journalSize, true);
+
+    // The replayed definitions may have set projectile flags, so these come last.
+    for (int i = 0; i < MAXTILES; i++)
+    {
+        auto const t = &tileData[i * 4];
+        g_tile[i].execPtr = t[0] >= 0 ? apScript + t[0] : nullptr;
+        g_tile[i].loadPtr = t[1] >= 0 ? apScript + t[1] : nullptr;
+        g_tile[i].flags = t[2];
+        g_tile[i].cacherange = t[3];
+    }
+
+    g_scriptVersion = scriptVersion;
+    g_scriptcrc = scriptCrc;
+    g_numXStrings = numXStrings;
+    g_totalLines = totalLines;
+
+    memcpy(CheatStrings, cheatStrings, sizeof(CheatStrings));
+    memcpy(CheatDescriptions, cheatDescriptions, sizeof(CheatDescriptions));
+    memcpy(CheatKeys, cheatKeys, sizeof(CheatKeys));
+    memcpy(g_gametypeNames, gametypeNames, sizeof(g_gametypeNames));
+    memcpy(g_gametypeFlags, gametypeFlags, sizeof(g_gametypeFlags));
+    g_gametypeCnt = gametypeCnt;
+
+    return true;
+}
+
+END_DUKE_NS
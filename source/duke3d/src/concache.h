@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+#include <initializer_list>
+
+BEGIN_DUKE_NS
+
+//==========================================================================
+//
+// Cache for compiled CON code.
+//
+// After a successful compile the byte code, the label tables and the
+// per-tile script data are written out together with a journal of all
+// definitions the compiler passed on to other parts of the game (game
+// variables, sounds, quotes, level names and so on). The cache is keyed
+// on the engine version and the contents of every CON file that was
+// included, so any change to them leads to a normal compile.
+//
+//==========================================================================
+
+enum
+{
+    CONOP_GAMEVAR,          // name; value, flags
+    CONOP_GAMEARRAY,        // name; size, flags
+    CONOP_DYNAMICTILE,      // label; value
+    CONOP_DYNAMICSOUND,     // label; value
+    CONOP_MUSIC,            // file; volume, level
+    CONOP_UNDEFINELEVEL,    // volume, level
+    CONOP_UNDEFINESKILL,    // skill
+    CONOP_UNDEFINEVOLUME,   // volume
+    CONOP_VOLUMENAME,       // name; volume
+    CONOP_VOLUMEFLAGS,      // volume, flags
+    CONOP_SKILLNAME,        // name; skill
+    CONOP_BUTTONALIAS,      // name; function
+    CONOP_CLEARBUTTONALIAS, // function
+    CONOP_LEVELFILE,        // file; volume, level
+    CONOP_LEVELNAME,        // name; volume, level, par time, designer time
+    CONOP_QUOTE,            // text; quote
+    CONOP_EXQUOTE,          // text; index
+    CONOP_SOUND,            // file; sound, minpitch, maxpitch, priority, type, distance
+    CONOP_PROJECTILE,       // tile, field, value
+    CONOP_GAMESTARTUP,      // script version, parameters
+};
+
+void C_CacheBeginRecording(void);
+void C_CacheEndRecording(void);
+void C_CacheAddFile(const char *fileName, const char *data, int length);
+void C_CacheRecordOp(int op, const int32_t *args, int numArgs, const char *string = nullptr);
+
+inline void C_CacheRecordOp(int op, std::initializer_list<int32_t> args, const char *string = nullptr)
+{
+    C_CacheRecordOp(op, args.begin(), (int)args.size(), string);
+}
+
+void C_CacheSave(const char *fileName);
+bool C_CacheLoad(const char *fileName, const char *data, int length);
+
+// Implemented in gamedef.cpp, next to the code it mirrors.
+void C_ReplayCompileOp(int op, const int32_t *args, int numArgs, const char *string);
+
+END_DUKE_NS
@@ -28,6 +28,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "menus.h"
 #include "savegame.h"
 #include "screens.h"
+#include "timedemo.h"
 #include "printf.h"
 #include "menu/menu.h"
 
@@ -426,6 +427,9 @@ static void Demo_FinishProfile(void)
                 OSD_Printf("== demo %d: non-profiled time overhead: %.02f %%\n",
                            dn, 100.0*totalms/totalprofms - 100.0);
         }
+
+        if (TimeDemo_Active())
+            TimeDemo_Report(g_firstDemoFile);
     }
 
     g_demo_profile = 0;
@@ -691,7 +695,9 @@ nextdemo_nomenu:
                 if (Demo_IsProfiling())
                 {
                     double t = timerGetHiTicks();
+                    TimeDemo_TickBegin();
                     G_DoMoveThings();
+                    TimeDemo_TickEnd();
                     Demo_GToc(t);
                 }
                 else if (!g_demo_paused)
@@ -763,6 +769,7 @@ nextdemo_nomenu:
                     for (i=0; i<num; i++)
                     {
                         double t1 = timerGetHiTicks(), t2;
+                        TimeDemo_FrameBegin();
 
                         //                    initprintf("t=%d, o=%d, t-o = %d\n", totalclock,
                         //                               ototalclock, totalclock-ototalclock);
@@ -779,6 +786,7 @@ nextdemo_nomenu:
 
                         G_DisplayRest(j);
 
+                        TimeDemo_FrameEnd();
                         Demo_RToc(t1, t2);
                     }
 
@@ -51,6 +51,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "menu/menu.h"
 #include "mapinfo.h"
 #include "rendering/v_video.h"
+#include "tracing.h"
 
 // Uncomment to prevent anything except mirrors from drawing. It is sensible to
 // also uncomment ENGINE_CLEAR_SCREEN in build/src/engine_priv.h.
@@ -1080,9 +1081,9 @@ void G_DumpDebugInfo(void)
             {
                 if (aGameVars[i].flags & (GAMEVAR_PERACTOR))
                 {
-                    if (aGameVars[i].pValues[j] != aGameVars[i].defaultValue)
+                    if (Gv_ActorValue(aGameVars[i], j) != aGameVars[i].defaultValue)
                     {
-                        buildprint("gamevar ", aGameVars[i].szLabel, " ", aGameVars[i].pValues[j], " GAMEVAR_PERACTOR");
+                        buildprint("gamevar ", aGameVars[i].szLabel, " ", Gv_ActorValue(aGameVars[i], j), " GAMEVAR_PERACTOR");
                         if (aGameVars[i].flags != GAMEVAR_PERACTOR)
                         {
                             buildprint(" // ");
@@ -5880,6 +5881,7 @@ MAIN_LOOP_RESTART:
 
     do //main loop
     {
+        TRACE_ZONE("Frame");
 		gameHandleEvents();
 		if (myplayer.gm == MODE_DEMO)
 		{
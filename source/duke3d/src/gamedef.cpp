@@ -39,6 +39,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "menu/menu.h"
 #include "stringtable.h"
 #include "mapinfo.h"
+#include "concache.h"
 
 void C_CON_SetButtonAlias(int num, const char* text);
 void C_CON_ClearButtonAlias(int num);
@@ -1932,6 +1933,7 @@ static void C_Include(const char *confile)
 
     mptr[len] = 0;
     g_scriptcrc = Bcrc32(mptr, len, g_scriptcrc);
+    C_CacheAddFile(confile, mptr, len);
 
     if (*textptr == '"') // skip past the closing quote if it's there so we don't screw up the next line
         textptr++;
@@ -2446,6 +2448,7 @@ DO_DEFSTATE:
                 }
             }
 
+            C_CacheRecordOp(CONOP_GAMEVAR, { defaultValue, varFlags }, LAST_LABEL);
             Gv_NewVar(LAST_LABEL, defaultValue, varFlags);
             continue;
         }
@@ -2488,6 +2491,7 @@ DO_DEFSTATE:
             arrayFlags = g_scriptPtr[-1];
             g_scriptPtr--;
 
+            C_CacheRecordOp(CONOP_GAMEARRAY, { (int32_t)g_scriptPtr[-1], arrayFlags }, arrayName);
             Gv_NewArray(arrayName, NULL, g_scriptPtr[-1], arrayFlags);
 
             g_scriptPtr -= 2; // no need to save in script...
@@ -2532,7 +2536,10 @@ DO_DEFSTATE:
                     labeltype[g_labelCnt] = LABEL_DEFINE;
                     labelcode[g_labelCnt++] = g_scriptPtr[-1];
                     if (g_scriptPtr[-1] >= 0 && g_scriptPtr[-1] < MAXTILES && g_dynamicTileMapping)
+                    {
+                        C_CacheRecordOp(CONOP_DYNAMICTILE, { (int32_t)g_scriptPtr[-1] }, label+((g_labelCnt-1)<<6));
                         G_ProcessDynamicTileMapping(label+((g_labelCnt-1)<<6),g_scriptPtr[-1]);
+                    }
                 }
                 g_scriptPtr -= 2;
                 continue;
@@ -2653,6 +2660,7 @@ DO_DEFSTATE:
                     }
                     tempbuf[j+1] = '\0';
 
+                    C_CacheRecordOp(CONOP_MUSIC, { k, i }, tempbuf);
                     C_DefineMusic(k, i, tempbuf);
 
                     textptr += j;
@@ -3958,6 +3966,7 @@ setvarvar:
                     continue;
                 }
 
+                C_CacheRecordOp(CONOP_PROJECTILE, { j, y, z });
                 C_DefineProjectile(j, y, z);
                 continue;
             }
@@ -4878,6 +4887,7 @@ repeatcase:
                 continue;
             }
 
+            C_CacheRecordOp(CONOP_UNDEFINELEVEL, { j, k });
             C_UndefineLevel(j, k);
             continue;
 
@@ -4897,6 +4907,7 @@ repeatcase:
                 continue;
             }
 
+            C_CacheRecordOp(CONOP_UNDEFINESKILL, { j });
             C_UndefineSkill(j);
             continue;
 
@@ -4916,6 +4927,7 @@ repeatcase:
                 continue;
             }
 
+            C_CacheRecordOp(CONOP_UNDEFINEVOLUME, { j });
             C_UndefineVolume(j);
             continue;
 
@@ -4938,6 +4950,7 @@ repeatcase:
             }
 
 			i = strcspn(textptr, "\r\n");
+			C_CacheRecordOp(CONOP_VOLUMENAME, { j }, FString(textptr, i));
 			gVolumeNames[j] = FStringTable::MakeMacro(textptr, i);
 			textptr += i;
   
@@ -4961,6 +4974,7 @@ repeatcase:
                 continue;
             }
 
+            C_CacheRecordOp(CONOP_VOLUMEFLAGS, { j, k });
             C_DefineVolumeFlags(j, k);
             continue;
 
@@ -4998,6 +5012,7 @@ repeatcase:
 					}
 				}
 				buffer.Push(0);
+				C_CacheRecordOp(CONOP_BUTTONALIAS, { j }, buffer.Data());
 				C_CON_SetButtonAlias(j, buffer.Data());
 			}
             continue;
@@ -5017,6 +5032,7 @@ repeatcase:
                 continue;
             }
 
+			C_CacheRecordOp(CONOP_CLEARBUTTONALIAS, { j });
 			C_CON_ClearButtonAlias(j);
             continue;
 
@@ -5039,6 +5055,7 @@ repeatcase:
             }
 
 			i = strcspn(textptr, "\r\n");
+			C_CacheRecordOp(CONOP_SKILLNAME, { j }, FString(textptr, i));
 			gSkillNames[j] = FStringTable::MakeMacro(textptr, i);
 			textptr+=i;
 
@@ -5195,6 +5212,7 @@ repeatcase:
 
             Bcorrectfilename(tempbuf,0);
 
+            C_CacheRecordOp(CONOP_LEVELFILE, { j, k }, tempbuf);
             mapList[j * MAXLEVELS + k].SetFileName(tempbuf);
 
             C_SkipComments();
@@ -5236,6 +5254,7 @@ repeatcase:
 
             tempbuf[i] = '\0';
 
+            C_CacheRecordOp(CONOP_LEVELNAME, { j, k, mapList[j * MAXLEVELS + k].parTime, mapList[j * MAXLEVELS + k].designerTime }, tempbuf);
             mapList[j * MAXLEVELS + k].SetName(tempbuf);
 
             continue;
@@ -5277,9 +5296,15 @@ repeatcase:
             }
 			buffer.Push(0);
 			if (tw == CON_DEFINEQUOTE)
+			{
+				C_CacheRecordOp(CONOP_QUOTE, { k }, buffer.Data());
 				quoteMgr.InitializeQuote(k, buffer.Data(), true);
+			}
 			else
+			{
+				C_CacheRecordOp(CONOP_EXQUOTE, { g_numXStrings }, buffer.Data());
 				quoteMgr.InitializeExQuote(g_numXStrings, buffer.Data(), true);
+			}
 
 
             if (tw != CON_DEFINEQUOTE)
@@ -5442,10 +5467,14 @@ repeatcase:
             vo = g_scriptPtr[-1];
             g_scriptPtr -= 5;
 
+            C_CacheRecordOp(CONOP_SOUND, { k, ps, pe, pr, m, vo }, buffer.Data());
             int res = S_DefineSound(k, buffer.Data(), ps, pe, pr, m, vo, 1.f);
 
             if (g_dynamicSoundMapping && j >= 0 && (labeltype[j] & LABEL_DEFINE))
+            {
+                C_CacheRecordOp(CONOP_DYNAMICSOUND, { k }, label + (j << 6));
                 G_ProcessDynamicSoundMapping(label + (j << 6), k);
+            }
             continue;
         }
 
@@ -5654,6 +5683,10 @@ repeatcase:
                 TRIPBOMBLASERMODE
                 */
 
+                int32_t cacheArgs[32] = { g_scriptVersion };
+                memcpy(&cacheArgs[1], params, sizeof(params));
+                C_CacheRecordOp(CONOP_GAMESTARTUP, cacheArgs, 32);
+
                 G_DoGameStartup(params);
             }
             continue;
@@ -5900,6 +5933,139 @@ void scriptInitTables()
 #endif
 }
 
+//==========================================================================
+//
+// Repeats a definition that was recorded in the CON cache while compiling.
+// This must stay in sync with the parser above.
+//
+//==========================================================================
+
+void C_ReplayCompileOp(int op, const int32_t *args, int numArgs, const char *string)
+{
+    static const uint8_t numOpArgs[] = { 2, 2, 1, 1, 2, 2, 1, 1, 1, 2, 1, 1, 1, 2, 4, 1, 1, 6, 3, 32 };
+    EDUKE32_STATIC_ASSERT(ARRAY_SIZE(numOpArgs) == CONOP_GAMESTARTUP + 1);
+
+    if ((unsigned)op >= ARRAY_SIZE(numOpArgs) || numArgs < numOpArgs[op])
+        return;
+
+    switch (op)
+    {
+    case CONOP_GAMEVAR:
+        Gv_NewVar(string, args[0], args[1]);
+        break;
+
+    case CONOP_GAMEARRAY:
+        Gv_NewArray(string, NULL, args[0], args[1]);
+        break;
+
+    case CONOP_DYNAMICTILE:
+        G_ProcessDynamicTileMapping(string, args[0]);
+        break;
+
+    case CONOP_DYNAMICSOUND:
+        G_ProcessDynamicSoundMapping(string, args[0]);
+        break;
+
+    case CONOP_MUSIC:
+        C_DefineMusic(args[0], args[1], string);
+        break;
+
+    case CONOP_UNDEFINELEVEL:
+        C_UndefineLevel(args[0], args[1]);
+        break;
+
+    case CONOP_UNDEFINESKILL:
+        C_UndefineSkill(args[0]);
+        break;
+
+    case CONOP_UNDEFINEVOLUME:
+        C_UndefineVolume(args[0]);
+        break;
+
+    case CONOP_VOLUMENAME:
+        gVolumeNames[args[0]] = FStringTable::MakeMacro(string);
+        g_volumeCnt = args[0]+1;
+        break;
+
+    case CONOP_VOLUMEFLAGS:
+        C_DefineVolumeFlags(args[0], args[1]);
+        break;
+
+    case CONOP_SKILLNAME:
+    {
+        gSkillNames[args[0]] = FStringTable::MakeMacro(string);
+
+        int i;
+        for (i=0; i<MAXSKILLS; i++)
+            if (gSkillNames[i].IsEmpty())
+                break;
+
+        g_skillCnt = i;
+        break;
+    }
+
+    case CONOP_BUTTONALIAS:
+        C_CON_SetButtonAlias(args[0], string);
+        break;
+
+    case CONOP_CLEARBUTTONALIAS:
+        C_CON_ClearButtonAlias(args[0]);
+        break;
+
+    case CONOP_LEVELFILE:
+        mapList[args[0] * MAXLEVELS + args[1]].SetFileName(string);
+        break;
+
+    case CONOP_LEVELNAME:
+    {
+        auto &gmap = mapList[args[0] * MAXLEVELS + args[1]];
+        gmap.parTime = args[2];
+        gmap.designerTime = args[3];
+        gmap.SetName(string);
+        break;
+    }
+
+    case CONOP_QUOTE:
+        C_AllocQuote(args[0]);
+        quoteMgr.InitializeQuote(args[0], string, true);
+        break;
+
+    case CONOP_EXQUOTE:
+        quoteMgr.InitializeExQuote(args[0], string, true);
+        break;
+
+    case CONOP_SOUND:
+        S_DefineSound(args[0], string, args[1], args[2], args[3], args[4], args[5], 1.f);
+        break;
+
+    case CONOP_PROJECTILE:
+        C_DefineProjectile(args[0], args[1], args[2]);
+        break;
+
+    case CONOP_GAMESTARTUP:
+        g_scriptVersion = args[0];
+        G_DoGameStartup(&args[1]);
+        break;
+    }
+}
+
+static void C_FinishCompile(void)
+{
+    for (auto i : tables_free)
+        hash_free(i);
+
+    for (auto i : inttables)
+        inthash_free(i);
+
+    freehashnames();
+    freesoundhashnames();
+
+    if (g_scriptDebug)
+        C_PrintStats();
+
+    C_InitQuotes();
+}
+
 void C_Compile(const char *fileName)
 {
     Bmemset(apScriptEvents, 0, sizeof(apScriptEvents));
@@ -5908,9 +6074,6 @@ void C_Compile(const char *fileName)
     for (auto & i : g_tile)
         Bmemset(&i, 0, sizeof(tiledata_t));
 
-    for (double & actorMinMs : g_actorMinMs)
-        actorMinMs = 1e308;
-
     scriptInitTables();
     scriptInitStructTables();
 
@@ -5940,6 +6103,20 @@ void C_Compile(const char *fileName)
     g_scriptcrc = Bcrc32(NULL, 0, 0L);
     g_scriptcrc = Bcrc32(textptr, kFileLen, g_scriptcrc);
 
+    if (C_CacheLoad(fileName, mptr, kFileLen))
+    {
+        DO_FREE_AND_NULL(mptr);
+
+        initprintf("Loaded %d bytes of compiled code from cache in %ums%s\n", (int)((intptr_t)g_scriptPtr - (intptr_t)apScript),
+                   timerGetTicks() - startcompiletime, C_ScriptVersionString(g_scriptVersion));
+
+        C_FinishCompile();
+        return;
+    }
+
+    C_CacheBeginRecording();
+    C_CacheAddFile(fileName, mptr, kFileLen);
+
     Xfree(apScript);
 
     apScript = (intptr_t *)Xcalloc(1, g_scriptSize * sizeof(intptr_t));
@@ -6003,19 +6180,11 @@ void C_Compile(const char *fileName)
     initprintf("Compiled %d bytes in %ums%s\n", (int)((intptr_t)g_scriptPtr - (intptr_t)apScript),
                timerGetTicks() - startcompiletime, C_ScriptVersionString(g_scriptVersion));
 
-    for (auto i : tables_free)
-        hash_free(i);
-
-    for (auto i : inttables)
-        inthash_free(i);
-
-    freehashnames();
-    freesoundhashnames();
-
-    if (g_scriptDebug)
-        C_PrintStats();
+    if (!g_errorCnt)
+        C_CacheSave(fileName);
+    C_CacheEndRecording();
 
-    C_InitQuotes();
+    C_FinishCompile();
 }
 
 void C_ReportError(int error)
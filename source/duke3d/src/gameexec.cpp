@@ -43,6 +43,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "mapinfo.h"
 #include "version.h"
 #include "v_video.h"
+#include "tracing.h"
+#include "vmprofile.h"
 
 #include "debugbreak.h"
 
@@ -81,10 +83,6 @@ int32_t g_textureVarID   = -1;  // var ID of "TEXTURE"
 int32_t g_thisActorVarID = -1;  // var ID of "THISACTOR"
 int32_t g_structVarIDs   = -1;
 
-// for timing events and actors
-uint32_t g_eventCalls[MAXEVENTS], g_actorCalls[MAXTILES];
-double g_eventTotalMs[MAXEVENTS], g_actorTotalMs[MAXTILES], g_actorMinMs[MAXTILES], g_actorMaxMs[MAXTILES];
-
 GAMEEXEC_STATIC void VM_Execute(int const loop = false);
 
 # include "gamestructures.cpp"
@@ -145,14 +143,8 @@ intptr_t apScriptEvents[MAXEVENTS];
 #ifdef LUNATIC
 static FORCE_INLINE int32_t VM_EventInlineInternal__(int const &eventNum, int const &spriteNum, int const &playerNum, int const &playerDist, int32_t returnValue)
 {
-    const double t = timerGetHiTicks();
     int32_t ret = El_CallEvent(&g_ElState, eventNum, spriteNum, playerNum, playerDist, &returnValue);
 
-    // NOTE: the run times are those of the called event plus any events
-    // called by it, *not* "self" time.
-    g_eventTotalMs[eventNum] += timerGetHiTicks()-t;
-    g_eventCalls[eventNum]++;
-
     if (ret == 1)
         VM_DeleteSprite(spriteNum, playerNum);
 
@@ -194,7 +186,8 @@ static FORCE_INLINE int32_t VM_EventInlineInternal__(int const eventNum, int con
     insptr = apScript + apScriptEvents[eventNum];
     globalReturn = returnValue;
 
-    double const t = timerGetHiTicks();
+    TRACE_ZONE(EventNames[eventNum]);
+    VMProfileZone const profileZone(VMPROF_EVENT, eventNum);
 
     if ((unsigned)spriteNum >= MAXSPRITES)
         VM_DummySprite();
@@ -207,9 +200,6 @@ static FORCE_INLINE int32_t VM_EventInlineInternal__(int const eventNum, int con
     if (vm.flags & VM_KILL)
         VM_DeleteSprite(vm.spriteNum, vm.playerNum);
 
-    g_eventTotalMs[eventNum] += timerGetHiTicks()-t;
-    g_eventCalls[eventNum]++;
-
     // restoring these needs to happen after VM_DeleteSprite() due to event recursion
     returnValue = globalReturn;
 
@@ -1428,6 +1418,7 @@ GAMEEXEC_STATIC void VM_Execute(int const loop /*= false*/)
             {
                 auto tempscrptr = &insptr[2];
                 insptr = (intptr_t *)insptr[1];
+                VMProfileZone const profileZone(VMPROF_STATE, insptr - apScript);
                 VM_Execute(true);
                 insptr = tempscrptr;
             }
@@ -1558,123 +1549,123 @@ GAMEEXEC_STATIC void VM_Execute(int const loop /*= false*/)
 
             vInstruction(CON_IFVARE_ACTOR):
                 insptr++;
-                tw = aGameVars[*insptr++].pValues[vm.spriteNum & (MAXSPRITES-1)];
+                tw = Gv_ActorValue(aGameVars[*insptr++], vm.spriteNum & (MAXSPRITES-1));
                 VM_CONDITIONAL(tw == *insptr);
                 dispatch();
             vInstruction(CON_IFVARN_ACTOR):
                 insptr++;
-                tw = aGameVars[*insptr++].pValues[vm.spriteNum & (MAXSPRITES-1)];
+                tw = Gv_ActorValue(aGameVars[*insptr++], vm.spriteNum & (MAXSPRITES-1));
                 VM_CONDITIONAL(tw != *insptr);
                 dispatch();
             vInstruction(CON_IFVARAND_ACTOR):
                 insptr++;
-                tw = aGameVars[*insptr++].pValues[vm.spriteNum & (MAXSPRITES-1)];
+                tw = Gv_ActorValue(aGameVars[*insptr++], vm.spriteNum & (MAXSPRITES-1));
                 VM_CONDITIONAL(tw & *insptr);
                 dispatch();
             vInstruction(CON_IFVAROR_ACTOR):
                 insptr++;
-                tw = aGameVars[*insptr++].pValues[vm.spriteNum & (MAXSPRITES-1)];
+                tw = Gv_ActorValue(aGameVars[*insptr++], vm.spriteNum & (MAXSPRITES-1));
                 VM_CONDITIONAL(tw | *insptr);
                 dispatch();
             vInstruction(CON_IFVARXOR_ACTOR):
                 insptr++;
-                tw = aGameVars[*insptr++].pValues[vm.spriteNum & (MAXSPRITES-1)];
+                tw = Gv_ActorValue(aGameVars[*insptr++], vm.spriteNum & (MAXSPRITES-1));
                 VM_CONDITIONAL(tw ^ *insptr);
                 dispatch();
             vInstruction(CON_IFVAREITHER_ACTOR):
                 insptr++;
-                tw = aGameVars[*insptr++].pValues[vm.spriteNum & (MAXSPRITES-1)];
+                tw = Gv_ActorValue(aGameVars[*insptr++], vm.spriteNum & (MAXSPRITES-1));
                 VM_CONDITIONAL(tw || *insptr);
                 dispatch();
             vInstruction(CON_IFVARBOTH_ACTOR):
                 insptr++;
-                tw = aGameVars[*insptr++].pValues[vm.spriteNum & (MAXSPRITES-1)];
+                tw = Gv_ActorValue(aGameVars[*insptr++], vm.spriteNum & (MAXSPRITES-1));
                 VM_CONDITIONAL(tw && *insptr);
                 dispatch();
             vInstruction(CON_IFVARG_ACTOR):
                 insptr++;
-                tw = aGameVars[*insptr++].pValues[vm.spriteNum & (MAXSPRITES-1)];
+                tw = Gv_ActorValue(aGameVars[*insptr++], vm.spriteNum & (MAXSPRITES-1));
                 VM_CONDITIONAL(tw > *insptr);
                 dispatch();
             vInstruction(CON_IFVARGE_ACTOR):
                 insptr++;
-                tw = aGameVars[*insptr++].pValues[vm.spriteNum & (MAXSPRITES-1)];
+                tw = Gv_ActorValue(aGameVars[*insptr++], vm.spriteNum & (MAXSPRITES-1));
                 VM_CONDITIONAL(tw >= *insptr);
                 dispatch();
             vInstruction(CON_IFVARL_ACTOR):
                 insptr++;
-                tw = aGameVars[*insptr++].pValues[vm.spriteNum & (MAXSPRITES-1)];
+                tw = Gv_ActorValue(aGameVars[*insptr++], vm.spriteNum & (MAXSPRITES-1));
                 VM_CONDITIONAL(tw < *insptr);
                 dispatch();
             vInstruction(CON_IFVARLE_ACTOR):
                 insptr++;
-                tw = aGameVars[*insptr++].pValues[vm.spriteNum & (MAXSPRITES-1)];
+                tw = Gv_ActorValue(aGameVars[*insptr++], vm.spriteNum & (MAXSPRITES-1));
                 VM_CONDITIONAL(tw <= *insptr);
                 dispatch();
             vInstruction(CON_IFVARA_ACTOR):
                 insptr++;
-                tw = aGameVars[*insptr++].pValues[vm.spriteNum & (MAXSPRITES-1)];
+                tw = Gv_ActorValue(aGameVars[*insptr++], vm.spriteNum & (MAXSPRITES-1));
                 VM_CONDITIONAL((uint32_t)tw > (uint32_t)*insptr);
                 dispatch();
             vInstruction(CON_IFVARAE_ACTOR):
                 insptr++;
-                tw = aGameVars[*insptr++].pValues[vm.spriteNum & (MAXSPRITES-1)];
+                tw = Gv_ActorValue(aGameVars[*insptr++], vm.spriteNum & (MAXSPRITES-1));
                 VM_CONDITIONAL((uint32_t)tw >= (uint32_t)*insptr);
                 dispatch();
             vInstruction(CON_IFVARB_ACTOR):
                 insptr++;
-                tw = aGameVars[*insptr++].pValues[vm.spriteNum & (MAXSPRITES-1)];
+                tw = Gv_ActorValue(aGameVars[*insptr++], vm.spriteNum & (MAXSPRITES-1));
                 VM_CONDITIONAL((uint32_t)tw < (uint32_t)*insptr);
                 dispatch();
             vInstruction(CON_IFVARBE_ACTOR):
                 insptr++;
-                tw = aGameVars[*insptr++].pValues[vm.spriteNum & (MAXSPRITES-1)];
+                tw = Gv_ActorValue(aGameVars[*insptr++], vm.spriteNum & (MAXSPRITES-1));
                 VM_CONDITIONAL((uint32_t)tw <= (uint32_t)*insptr);
                 dispatch();
 
             vInstruction(CON_SETVAR_ACTOR):
                 insptr++;
-                aGameVars[*insptr].pValues[vm.spriteNum & (MAXSPRITES-1)] = insptr[1];
+                Gv_ActorValue(aGameVars[*insptr], vm.spriteNum & (MAXSPRITES-1)) = insptr[1];
                 insptr += 2;
                 dispatch();
             vInstruction(CON_ADDVAR_ACTOR):
                 insptr++;
-                aGameVars[*insptr].pValues[vm.spriteNum & (MAXSPRITES-1)] += insptr[1];
+                Gv_ActorValue(aGameVars[*insptr], vm.spriteNum & (MAXSPRITES-1)) += insptr[1];
                 insptr += 2;
                 dispatch();
             vInstruction(CON_SUBVAR_ACTOR):
                 insptr++;
-                aGameVars[*insptr].pValues[vm.spriteNum & (MAXSPRITES-1)] -= insptr[1];
+                Gv_ActorValue(aGameVars[*insptr], vm.spriteNum & (MAXSPRITES-1)) -= insptr[1];
                 insptr += 2;
                 dispatch();
             vInstruction(CON_MULVAR_ACTOR):
                 insptr++;
-                aGameVars[*insptr].pValues[vm.spriteNum & (MAXSPRITES-1)] *= insptr[1];
+                Gv_ActorValue(aGameVars[*insptr], vm.spriteNum & (MAXSPRITES-1)) *= insptr[1];
                 insptr += 2;
                 dispatch();
             vInstruction(CON_ANDVAR_ACTOR):
                 insptr++;
-                aGameVars[*insptr].pValues[vm.spriteNum & (MAXSPRITES-1)] &= insptr[1];
+                Gv_ActorValue(aGameVars[*insptr], vm.spriteNum & (MAXSPRITES-1)) &= insptr[1];
                 insptr += 2;
                 dispatch();
             vInstruction(CON_XORVAR_ACTOR):
                 insptr++;
-                aGameVars[*insptr].pValues[vm.spriteNum & (MAXSPRITES-1)] ^= insptr[1];
+                Gv_ActorValue(aGameVars[*insptr], vm.spriteNum & (MAXSPRITES-1)) ^= insptr[1];
                 insptr += 2;
                 dispatch();
             vInstruction(CON_ORVAR_ACTOR):
                 insptr++;
-                aGameVars[*insptr].pValues[vm.spriteNum & (MAXSPRITES-1)] |= insptr[1];
+                Gv_ActorValue(aGameVars[*insptr], vm.spriteNum & (MAXSPRITES-1)) |= insptr[1];
                 insptr += 2;
                 dispatch();
             vInstruction(CON_SHIFTVARL_ACTOR):
                 insptr++;
-                aGameVars[*insptr].pValues[vm.spriteNum & (MAXSPRITES-1)] <<= insptr[1];
+                Gv_ActorValue(aGameVars[*insptr], vm.spriteNum & (MAXSPRITES-1)) <<= insptr[1];
                 insptr += 2;
                 dispatch();
             vInstruction(CON_SHIFTVARR_ACTOR):
                 insptr++;
-                aGameVars[*insptr].pValues[vm.spriteNum & (MAXSPRITES-1)] >>= insptr[1];
+                Gv_ActorValue(aGameVars[*insptr], vm.spriteNum & (MAXSPRITES-1)) >>= insptr[1];
                 insptr += 2;
                 dispatch();
 
@@ -1827,7 +1818,7 @@ GAMEEXEC_STATIC void VM_Execute(int const loop /*= false*/)
             vInstruction(CON_WHILEVARN_ACTOR):
             {
                 auto const savedinsptr = &insptr[2];
-                auto &v = aGameVars[savedinsptr[-1]].pValues[vm.spriteNum & (MAXSPRITES-1)];
+                auto &v = Gv_ActorValue(aGameVars[savedinsptr[-1]], vm.spriteNum & (MAXSPRITES-1));
                 do
                 {
                     insptr = savedinsptr;
@@ -1841,7 +1832,7 @@ GAMEEXEC_STATIC void VM_Execute(int const loop /*= false*/)
             vInstruction(CON_WHILEVARL_ACTOR):
             {
                 auto const savedinsptr = &insptr[2];
-                auto &v = aGameVars[savedinsptr[-1]].pValues[vm.spriteNum & (MAXSPRITES-1)];
+                auto &v = Gv_ActorValue(aGameVars[savedinsptr[-1]], vm.spriteNum & (MAXSPRITES-1));
                 do
                 {
                     insptr = savedinsptr;
@@ -1887,7 +1878,7 @@ GAMEEXEC_STATIC void VM_Execute(int const loop /*= false*/)
                 dispatch();
             vInstruction(CON_MODVAR_ACTOR):
                 insptr++;
-                aGameVars[*insptr].pValues[vm.spriteNum & (MAXSPRITES-1)] %= insptr[1];
+                Gv_ActorValue(aGameVars[*insptr], vm.spriteNum & (MAXSPRITES-1)) %= insptr[1];
                 insptr += 2;
                 dispatch();
             vInstruction(CON_MODVAR_PLAYER):
@@ -2060,7 +2051,7 @@ GAMEEXEC_STATIC void VM_Execute(int const loop /*= false*/)
             vInstruction(CON_DIVVAR_ACTOR):
             {
                 insptr++;
-                auto &v = aGameVars[*insptr].pValues[vm.spriteNum & (MAXSPRITES - 1)];
+                auto &v = Gv_ActorValue(aGameVars[*insptr], vm.spriteNum & (MAXSPRITES - 1));
 
                 v = tabledivide32(v, insptr[1]);
                 insptr += 2;
@@ -2354,7 +2345,7 @@ GAMEEXEC_STATIC void VM_Execute(int const loop /*= false*/)
 
             vInstruction(CON_RANDVAR_ACTOR):
                 insptr++;
-                aGameVars[*insptr].pValues[vm.spriteNum & (MAXSPRITES-1)] = mulscale16(krand(), insptr[1] + 1);
+                Gv_ActorValue(aGameVars[*insptr], vm.spriteNum & (MAXSPRITES-1)) = mulscale16(krand(), insptr[1] + 1);
                 insptr += 2;
                 dispatch();
 #endif
@@ -6396,24 +6387,19 @@ void A_Execute(int const spriteNum, int const playerNum, int const playerDist)
     VM_UpdateAnim(vm.spriteNum, vm.pData);
     int const picnum = vm.pSprite->picnum;
 
-    double t = timerGetHiTicks();
-
 #ifdef LUNATIC
     int32_t killit=0;
     if (L_IsInitialized(&g_ElState) && El_HaveActor(picnum))
         killit = (El_CallActor(&g_ElState, picnum, spriteNum, playerNum, playerDist)==1);
 #else
-    insptr = 4 + (g_tile[vm.pSprite->picnum].execPtr);
-    VM_Execute(true);
-    insptr = NULL;
+    {
+        VMProfileZone const profileZone(VMPROF_ACTOR, picnum);
+        insptr = 4 + (g_tile[vm.pSprite->picnum].execPtr);
+        VM_Execute(true);
+        insptr = NULL;
+    }
 #endif
 
-    t = timerGetHiTicks()-t;
-    g_actorTotalMs[picnum] += t;
-    g_actorMinMs[picnum] = min(g_actorMinMs[picnum], t);
-    g_actorMaxMs[picnum] = max(g_actorMaxMs[picnum], t);
-    g_actorCalls[picnum]++;
-
 #ifdef LUNATIC
     if (!killit)
 #else
@@ -6574,7 +6560,7 @@ void G_SaveMapState(void)
         {
             if (!save->vars[i])
                 save->vars[i] = (intptr_t *)Xaligned_alloc(ACTOR_VAR_ALIGNMENT, MAXSPRITES * sizeof(intptr_t));
-            Bmemcpy(&save->vars[i][0], aGameVars[i].pValues, sizeof(intptr_t) * MAXSPRITES);
+            Gv_GetActorValues(i, save->vars[i]);
         }
         else
             save->vars[i] = (intptr_t *)aGameVars[i].global;
@@ -6659,6 +6645,8 @@ void G_RestoreMapState(void)
         Bmemcpy(yax_nextwall, pSavedState->yax_nextwall, sizeof(yax_nextwall));
 # endif
 #endif
+        sectorGridBuild();
+        canseeCacheInvalidate();
         Bmemcpy(&actor[0],&pSavedState->actor[0],sizeof(actor_t)*MAXSPRITES);
 
         g_cyclerCnt = pSavedState->g_cyclerCnt;
@@ -6706,7 +6694,7 @@ void G_RestoreMapState(void)
             {
                 if (!pSavedState->vars[i])
                     continue;
-                Bmemcpy(aGameVars[i].pValues, pSavedState->vars[i], sizeof(intptr_t) * MAXSPRITES);
+                Gv_SetActorValues(i, pSavedState->vars[i]);
             }
             else
                 aGameVars[i].global = (intptr_t)pSavedState->vars[i];
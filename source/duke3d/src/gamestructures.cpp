@@ -178,11 +178,11 @@ void __fastcall VM_SetSector(int const sectNum, int const labelNum, int32_t newV
 
 const memberlabel_t WallLabels[]=
 {
-    LABEL_SETUP(wall, x,          WALL_X),
-    LABEL_SETUP(wall, y,          WALL_Y),
+    { "x", WALL_X, sizeof(wall[0].x) | LABEL_WRITEFUNC, 0, offsetof(uwalltype, x) },
+    { "y", WALL_Y, sizeof(wall[0].y) | LABEL_WRITEFUNC, 0, offsetof(uwalltype, y) },
     LABEL_SETUP(wall, point2,     WALL_POINT2),
     LABEL_SETUP(wall, nextwall,   WALL_NEXTWALL),
-    LABEL_SETUP(wall, nextsector, WALL_NEXTSECTOR),
+    { "nextsector", WALL_NEXTSECTOR, sizeof(wall[0].nextsector) | LABEL_WRITEFUNC, 0, offsetof(uwalltype, nextsector) },
     LABEL_SETUP(wall, cstat,      WALL_CSTAT),
     LABEL_SETUP(wall, picnum,     WALL_PICNUM),
     LABEL_SETUP(wall, overpicnum, WALL_OVERPICNUM),
@@ -236,6 +236,21 @@ void __fastcall VM_SetWall(int const wallNum, int const labelNum, int32_t const
 
     switch (labelNum)
     {
+        case WALL_X:
+            wall[wallNum].x = newValue;
+            sectorGridInvalidate(sectorofwall(wallNum));
+            break;
+
+        case WALL_Y:
+            wall[wallNum].y = newValue;
+            sectorGridInvalidate(sectorofwall(wallNum));
+            break;
+
+        case WALL_NEXTSECTOR:
+            wall[wallNum].nextsector = newValue;
+            canseeCacheInvalidate();
+            break;
+
         case WALL_BLEND:
 #ifdef NEW_MAP_FORMAT
             w.blend = newValue;
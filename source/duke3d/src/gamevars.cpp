@@ -42,6 +42,14 @@ gamearray_t aGameArrays[MAXGAMEARRAYS];
 int32_t     g_gameVarCount   = 0;
 int32_t     g_gameArrayCount = 0;
 
+intptr_t *g_actorVarBlock;
+intptr_t *g_actorVarDefaults;
+int32_t   g_actorVarStride;
+int32_t   g_actorVarResetCount;
+static int32_t g_actorVarKeepCount;  // GAMEVAR_NODEFAULT columns at the end of each record
+
+#define ACTOR_VAR_MINSTRIDE 16
+
 // pointers to weapon gamevar data
 intptr_t *aplWeaponClip[MAX_WEAPONS];           // number of items in magazine
 intptr_t *aplWeaponFireDelay[MAX_WEAPONS];      // delay to fire
@@ -65,6 +73,97 @@ intptr_t *aplWeaponWorksLike[MAX_WEAPONS];      // What original the weapon work
 
 # include "gamestructures.cpp"
 
+// Moves the per-actor values into a block with records of newStride values.
+// The reset columns stay in front, the GAMEVAR_NODEFAULT ones at the end.
+static void Gv_ResizeActorVars(int const newStride)
+{
+    auto const newBlock    = (intptr_t *)Xaligned_alloc(ACTOR_VAR_ALIGNMENT, MAXSPRITES * newStride * sizeof(intptr_t));
+    auto const newDefaults = (intptr_t *)Xcalloc(newStride, sizeof(intptr_t));
+
+    for (bssize_t j = 0; j < MAXSPRITES; j++)
+    {
+        auto const src = &g_actorVarBlock[j * g_actorVarStride];
+        auto const dst = &newBlock[j * newStride];
+
+        Bmemcpy(dst, src, g_actorVarResetCount * sizeof(intptr_t));
+        Bmemcpy(dst + newStride - g_actorVarKeepCount, src + g_actorVarStride - g_actorVarKeepCount, g_actorVarKeepCount * sizeof(intptr_t));
+    }
+
+    if (g_actorVarResetCount)
+        Bmemcpy(newDefaults, g_actorVarDefaults, g_actorVarResetCount * sizeof(intptr_t));
+
+    for (bssize_t i = 0; i < g_gameVarCount; i++)
+    {
+        auto &var = aGameVars[i];
+
+        if (!(var.flags & GAMEVAR_PERACTOR) || !var.pValues)
+            continue;
+
+        int column = var.pValues - g_actorVarBlock;
+        if (column >= g_actorVarResetCount)
+            column += newStride - g_actorVarStride;
+        var.pValues = newBlock + column;
+    }
+
+    ALIGNED_FREE_AND_NULL(g_actorVarBlock);
+    DO_FREE_AND_NULL(g_actorVarDefaults);
+
+    g_actorVarBlock    = newBlock;
+    g_actorVarDefaults = newDefaults;
+    g_actorVarStride   = newStride;
+}
+
+// Gives a per-actor var its column in the block.
+static void Gv_AddActorVar(int const gameVar)
+{
+    if (g_actorVarResetCount + g_actorVarKeepCount == g_actorVarStride)
+        Gv_ResizeActorVars(max(g_actorVarStride * 2, ACTOR_VAR_MINSTRIDE));
+
+    auto &var = aGameVars[gameVar];
+
+    if (var.flags & GAMEVAR_NODEFAULT)
+        var.pValues = g_actorVarBlock + g_actorVarStride - ++g_actorVarKeepCount;
+    else
+    {
+        g_actorVarDefaults[g_actorVarResetCount] = var.defaultValue;
+        var.pValues = g_actorVarBlock + g_actorVarResetCount++;
+    }
+}
+
+// Drops the unused columns once all per-actor vars are known.
+static void Gv_CompactActorVars(void)
+{
+    int const numColumns = g_actorVarResetCount + g_actorVarKeepCount;
+
+    if (numColumns > 0 && numColumns < g_actorVarStride)
+        Gv_ResizeActorVars(numColumns);
+}
+
+static void Gv_FreeActorVars(void)
+{
+    ALIGNED_FREE_AND_NULL(g_actorVarBlock);
+    DO_FREE_AND_NULL(g_actorVarDefaults);
+    g_actorVarStride = g_actorVarResetCount = g_actorVarKeepCount = 0;
+}
+
+// Copies a per-actor var from or to a plain array of MAXSPRITES values, which is
+// what savegames and map states store.
+void Gv_GetActorValues(int const gameVar, intptr_t * const outBuf)
+{
+    auto const &var = aGameVars[gameVar];
+
+    for (bssize_t j = 0; j < MAXSPRITES; j++)
+        outBuf[j] = Gv_ActorValue(var, j);
+}
+
+void Gv_SetActorValues(int const gameVar, intptr_t const * const inBuf)
+{
+    auto const &var = aGameVars[gameVar];
+
+    for (bssize_t j = 0; j < MAXSPRITES; j++)
+        Gv_ActorValue(var, j) = inBuf[j];
+}
+
 // Frees the memory for the *values* of game variables and arrays. Resets their
 // counts to zero. Call this function as many times as needed.
 //
@@ -73,11 +172,15 @@ int Gv_Free(void)
 {
     for (auto &gameVar : aGameVars)
     {
-        if (gameVar.flags & GAMEVAR_USER_MASK)
+        if (gameVar.flags & GAMEVAR_PERACTOR)
+            gameVar.pValues = nullptr;
+        else if (gameVar.flags & GAMEVAR_USER_MASK)
             ALIGNED_FREE_AND_NULL(gameVar.pValues);
         gameVar.flags |= GAMEVAR_RESET;
     }
 
+    Gv_FreeActorVars();
+
     for (auto & gameArray : aGameArrays)
     {
         if (gameArray.flags & GAMEARRAY_ALLOCATED)
@@ -144,11 +247,16 @@ int Gv_ReadSave(FileReader &kFile)
         }
         else if (aGameVars[i].flags & GAMEVAR_PERACTOR)
         {
-            aGameVars[i].pValues = (intptr_t*)Xaligned_alloc(ACTOR_VAR_ALIGNMENT, MAXSPRITES * sizeof(intptr_t));
-            if (kFile.Read(aGameVars[i].pValues,sizeof(intptr_t) * MAXSPRITES) != sizeof(intptr_t) * MAXSPRITES) goto corrupt;
+            TArray<intptr_t> values(MAXSPRITES, true);
+            if (kFile.Read(values.Data(), sizeof(intptr_t) * MAXSPRITES) != sizeof(intptr_t) * MAXSPRITES) goto corrupt;
+            aGameVars[i].pValues = nullptr;
+            Gv_AddActorVar(i);
+            Gv_SetActorValues(i, values.Data());
         }
     }
 
+    Gv_CompactActorVars();
+
     Gv_InitWeaponPointers();
 
     if (kFile.Read(&g_gameArrayCount,sizeof(g_gameArrayCount)) != sizeof(g_gameArrayCount)) goto corrupt;
@@ -250,7 +358,11 @@ void Gv_WriteSave(FileWriter &fil)
         if (aGameVars[i].flags & GAMEVAR_PERPLAYER)
 			fil.Write(aGameVars[i].pValues, sizeof(intptr_t) * MAXPLAYERS);
         else if (aGameVars[i].flags & GAMEVAR_PERACTOR)
-			fil.Write(aGameVars[i].pValues, sizeof(intptr_t) * MAXSPRITES);
+        {
+            TArray<intptr_t> values(MAXSPRITES, true);
+            Gv_GetActorValues(i, values.Data());
+			fil.Write(values.Data(), sizeof(intptr_t) * MAXSPRITES);
+        }
     }
 
 	fil.Write(&g_gameArrayCount,sizeof(g_gameArrayCount));
@@ -355,6 +467,8 @@ void Gv_ResetVars(void) /* this is called during a new game and nowhere else */
         if (aGameArray.szLabel != NULL && aGameArray.flags & GAMEARRAY_RESET)
             Gv_NewArray(aGameArray.szLabel, aGameArray.pValues, aGameArray.size, aGameArray.flags);
     }
+
+    Gv_CompactActorVars();
 }
 
 unsigned __fastcall Gv_GetArrayElementSize(int const arrayIdx)
@@ -500,9 +614,11 @@ void Gv_NewVar(const char *pszLabel, intptr_t lValue, uint32_t dwFlags)
         // and the flags
         aGameVars[gV].flags=dwFlags;
 
-        // only free if per-{actor,player}
-        if (aGameVars[gV].flags & GAMEVAR_USER_MASK)
+        // only free if per-player, per-actor values live in g_actorVarBlock
+        if (aGameVars[gV].flags & GAMEVAR_PERPLAYER)
             ALIGNED_FREE_AND_NULL(aGameVars[gV].pValues);
+        else if (aGameVars[gV].flags & GAMEVAR_PERACTOR)
+            aGameVars[gV].pValues = nullptr;
     }
 
     // if existing is system, they only get to change default value....
@@ -529,12 +645,11 @@ void Gv_NewVar(const char *pszLabel, intptr_t lValue, uint32_t dwFlags)
     else if (aGameVars[gV].flags & GAMEVAR_PERACTOR)
     {
         if (!aGameVars[gV].pValues)
-        {
-            aGameVars[gV].pValues = (intptr_t *) Xaligned_alloc(ACTOR_VAR_ALIGNMENT, MAXSPRITES * sizeof(intptr_t));
-            Bmemset(aGameVars[gV].pValues, 0, MAXSPRITES * sizeof(intptr_t));
-        }
+            Gv_AddActorVar(gV);
+        else if (!(aGameVars[gV].flags & GAMEVAR_NODEFAULT))
+            g_actorVarDefaults[aGameVars[gV].pValues - g_actorVarBlock] = lValue;
         for (bssize_t j=MAXSPRITES-1; j>=0; --j)
-            aGameVars[gV].pValues[j]=lValue;
+            Gv_ActorValue(aGameVars[gV], j)=lValue;
     }
     else aGameVars[gV].global = lValue;
 }
@@ -764,7 +879,7 @@ static FORCE_INLINE int __fastcall getvar__(int const gameVar, int const spriteN
 
         if (!varFlags) returnValue = var.global;
         else if (varFlags == GAMEVAR_PERACTOR)
-            returnValue = var.pValues[spriteNum & (MAXSPRITES-1)];
+            returnValue = Gv_ActorValue(var, spriteNum & (MAXSPRITES-1));
         else if (varFlags == GAMEVAR_PERPLAYER)
             returnValue = var.pValues[playerNum & (MAXPLAYERS-1)];
         else switch (varFlags & GAMEVAR_PTR_MASK)
@@ -797,7 +912,7 @@ static FORCE_INLINE void __fastcall setvar__(int const gameVar, int const newVal
 
     if (!varFlags) var.global=newValue;
     else if (varFlags == GAMEVAR_PERACTOR)
-        var.pValues[spriteNum & (MAXSPRITES-1)] = newValue;
+        Gv_ActorValue(var, spriteNum & (MAXSPRITES-1)) = newValue;
     else if (varFlags == GAMEVAR_PERPLAYER)
         var.pValues[playerNum & (MAXPLAYERS-1)] = newValue;
     else switch (varFlags & GAMEVAR_PTR_MASK)
@@ -121,6 +121,20 @@ extern gamearray_t aGameArrays[MAXGAMEARRAYS];
 extern int32_t     g_gameVarCount;
 extern int32_t     g_gameArrayCount;
 
+// Per-actor gamevars live in one block holding a record of g_actorVarStride
+// values for each sprite. The pValues of such a var point to its column in the
+// first record. The first g_actorVarResetCount columns are reset on spawn,
+// GAMEVAR_NODEFAULT vars are allocated from the end of the record.
+extern intptr_t *g_actorVarBlock;
+extern intptr_t *g_actorVarDefaults;
+extern int32_t   g_actorVarStride;
+extern int32_t   g_actorVarResetCount;
+
+static FORCE_INLINE intptr_t &Gv_ActorValue(gamevar_t const &var, int const spriteNum)
+{
+    return var.pValues[spriteNum * g_actorVarStride];
+}
+
 size_t __fastcall Gv_GetArrayAllocSizeForCount(int const arrayIdx, size_t const count);
 size_t __fastcall Gv_GetArrayCountForAllocSize(int const arrayIdx, size_t const filelength);
 static FORCE_INLINE size_t Gv_GetArrayAllocSize(int const arrayIdx) { return Gv_GetArrayAllocSizeForCount(arrayIdx, aGameArrays[arrayIdx].size); }
@@ -144,13 +158,12 @@ int Gv_GetVarByLabel(const char *szGameLabel,int defaultValue,int spriteNum,int
 void Gv_NewArray(const char *pszLabel,void *arrayptr,intptr_t asize,uint32_t dwFlags);
 void Gv_NewVar(const char *pszLabel,intptr_t lValue,uint32_t dwFlags);
 
+void Gv_GetActorValues(int const gameVar, intptr_t * const outBuf);
+void Gv_SetActorValues(int const gameVar, intptr_t const * const inBuf);
+
 static FORCE_INLINE void A_ResetVars(int const spriteNum)
 {
-    for (auto &gv : aGameVars)
-    {
-        if ((gv.flags & (GAMEVAR_PERACTOR|GAMEVAR_NODEFAULT)) == GAMEVAR_PERACTOR)
-            gv.pValues[spriteNum] = gv.defaultValue;
-    }
+    Bmemcpy(&g_actorVarBlock[spriteNum * g_actorVarStride], g_actorVarDefaults, g_actorVarResetCount * sizeof(intptr_t));
 }
 void scriptInitStructTables(void);
 void Gv_DumpValues(void);
@@ -222,7 +235,7 @@ static FORCE_INLINE void __fastcall VM_SetStruct(uint32_t const flags, intptr_t
                 var.pValues[vm.playerNum & (MAXPLAYERS-1)] operator operand;                           \
                 break;                                                                                 \
             case GAMEVAR_PERACTOR:                                                                     \
-                var.pValues[vm.spriteNum & (MAXSPRITES-1)] operator operand;                           \
+                Gv_ActorValue(var, vm.spriteNum & (MAXSPRITES-1)) operator operand;                    \
                 break;                                                                                 \
             case GAMEVAR_INT32PTR: *(int32_t *)var.pValues operator(int32_t) operand; break;           \
             case GAMEVAR_INT16PTR: *(int16_t *)var.pValues operator(int16_t) operand; break;           \
@@ -253,7 +266,7 @@ static FORCE_INLINE void __fastcall Gv_DivVar(int const id, int32_t const d)
     
     switch (var.flags & (GAMEVAR_USER_MASK | GAMEVAR_PTR_MASK))
     {
-        case GAMEVAR_PERACTOR: iptr = &var.pValues[vm.spriteNum & (MAXSPRITES-1)]; goto jmp;
+        case GAMEVAR_PERACTOR: iptr = &Gv_ActorValue(var, vm.spriteNum & (MAXSPRITES-1)); goto jmp;
         case GAMEVAR_PERPLAYER: iptr = &var.pValues[vm.playerNum & (MAXPLAYERS-1)]; fallthrough__;
         default: jmp: *iptr = libdivide_s32_do(*iptr, dptr); break;
 
@@ -45,6 +45,13 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "m_crc32.h"
 
+#include "c_dispatch.h"
+#include "i_time.h"
+
+#include <zlib.h>
+#include <chrono>
+#include <thread>
+
 BEGIN_DUKE_NS
 
 // Data needed even if netcode is disabled
@@ -467,6 +474,22 @@ static TArray<netmapstate_t> g_cl_InterpolatedMapStateHistory;
 static TArray<netmapstate_t> g_mapStateHistory;
 static TArray<uint8_t> tempnetbuf;
 
+// One bit for every wall, sector and actor that differs between a server revision and the one before it.
+// ORing these together over a client's missing revisions tells Net_SendWorldUpdate which entities
+// can have changed for that client, so that all others can be skipped without comparing them.
+typedef struct netdirtymask_s
+{
+    uint64_t wall[(MAXWALLS + 63) >> 6];
+    uint64_t sector[(MAXSECTORS + 63) >> 6];
+    uint64_t actor[(MAXSPRITES + 63) >> 6];
+
+    // set when the previous revision isn't available, e.g. for the first revision of a map
+    bool all;
+} netdirtymask_t;
+
+static TArray<netdirtymask_t> g_mapDirtyHistory;
+static netdirtymask_t g_sendDirtyMask;
+
 // Remember that this constant needs to be one bit longer than a struct index, so it can't be mistaken for a valid wall, sprite, or sector index
 static const int32_t cSTOP_PARSING_CODE = ((1 << NETINDEX_BITS) - 1);
 
@@ -620,7 +643,11 @@ static void Net_CopyWallFromNet(netWall_t* netWall, walltype* gameWall)
 
     gameWall->point2 = netWall->point2;
     gameWall->nextwall = netWall->nextwall;
-    gameWall->nextsector = netWall->nextsector;
+    if (gameWall->nextsector != netWall->nextsector)
+    {
+        gameWall->nextsector = netWall->nextsector;
+        canseeCacheInvalidate();
+    }
 
     gameWall->cstat = netWall->cstat;
 
@@ -1497,6 +1524,107 @@ static void Net_AddWorldToSnapshot(netmapstate_t* snapshot)
 //------------------------------------------------------------------------------------------------------------------------
 
 
+//------------------------------------------------------------------------------------------------------------------------
+// Packet compression
+//
+// Every datagram ENet sends is run through deflate, whose Huffman stage does the entropy coding
+// for the bit packed world updates. ENet falls back to sending a datagram uncompressed if this
+// doesn't make it any smaller, so both ends must always be able to decompress.
+//------------------------------------------------------------------------------------------------------------------------
+
+typedef struct netcompressor_s
+{
+    z_stream deflater;
+    z_stream inflater;
+} netcompressor_t;
+
+static size_t ENET_CALLBACK Net_Compress(void* context, const ENetBuffer* inBuffers, size_t inBufferCount, size_t inLimit, enet_uint8* outData, size_t outLimit)
+{
+    z_stream* const zs = &((netcompressor_t*)context)->deflater;
+
+    if (inBufferCount == 0 || deflateReset(zs) != Z_OK)
+    {
+        return 0;
+    }
+
+    zs->next_out  = outData;
+    zs->avail_out = (uInt)outLimit;
+
+    for (size_t bufferIndex = 0; bufferIndex < inBufferCount; bufferIndex++)
+    {
+        int const flush = (bufferIndex == inBufferCount - 1) ? Z_FINISH : Z_NO_FLUSH;
+
+        zs->next_in  = (Bytef*)inBuffers[bufferIndex].data;
+        zs->avail_in = (uInt)inBuffers[bufferIndex].dataLength;
+
+        int const status = deflate(zs, flush);
+
+        // ran out of output space, the datagram goes out uncompressed
+        if (status == Z_STREAM_ERROR || zs->avail_in != 0 || (flush == Z_FINISH && status != Z_STREAM_END))
+        {
+            return 0;
+        }
+    }
+
+    return outLimit - zs->avail_out;
+}
+
+static size_t ENET_CALLBACK Net_Decompress(void* context, const enet_uint8* inData, size_t inLimit, enet_uint8* outData, size_t outLimit)
+{
+    z_stream* const zs = &((netcompressor_t*)context)->inflater;
+
+    if (inflateReset(zs) != Z_OK)
+    {
+        return 0;
+    }
+
+    zs->next_in   = (Bytef*)inData;
+    zs->avail_in  = (uInt)inLimit;
+    zs->next_out  = outData;
+    zs->avail_out = (uInt)outLimit;
+
+    if (inflate(zs, Z_FINISH) != Z_STREAM_END)
+    {
+        return 0;
+    }
+
+    return outLimit - zs->avail_out;
+}
+
+static void ENET_CALLBACK Net_DestroyCompressor(void* context)
+{
+    netcompressor_t* const compressor = (netcompressor_t*)context;
+
+    deflateEnd(&compressor->deflater);
+    inflateEnd(&compressor->inflater);
+    Xfree(compressor);
+}
+
+static void Net_SetupCompression(ENetHost* host)
+{
+    netcompressor_t* const compressor = (netcompressor_t*)Xcalloc(1, sizeof(netcompressor_t));
+
+    // raw deflate streams, the datagrams are already checksummed by ENet
+    if (deflateInit2(&compressor->deflater, Z_BEST_SPEED, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        Xfree(compressor);
+        return;
+    }
+
+    if (inflateInit2(&compressor->inflater, -MAX_WBITS) != Z_OK)
+    {
+        deflateEnd(&compressor->deflater);
+        Xfree(compressor);
+        return;
+    }
+
+    ENetCompressor const enetCompressor = { compressor, Net_Compress, Net_Decompress, Net_DestroyCompressor };
+
+    enet_host_compress(host, &enetCompressor);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+
 static void P_RemovePlayer(int32_t p)
 {
     // server obviously can't leave the game, and index 0 shows up for disconnect events from
@@ -3380,7 +3508,17 @@ static void NetBuffer_WriteDeltaNetActor(NetBuffer_t* netBuffer, const netactor_
 }
 
 
-static void Net_WriteNetActorsToBuffer(NetBuffer_t* netBuffer, const netmapstate_t* from, const netmapstate_t* to)
+static inline bool Net_IsDirty(const uint64_t* dirtyBits, int32_t index)
+{
+    return (dirtyBits[index >> 6] & (1ull << (index & 63))) != 0;
+}
+
+static inline void Net_SetDirty(uint64_t* dirtyBits, int32_t index)
+{
+    dirtyBits[index >> 6] |= 1ull << (index & 63);
+}
+
+static void Net_WriteNetActorsToBuffer(NetBuffer_t* netBuffer, const netmapstate_t* from, const netmapstate_t* to, const netdirtymask_t* dirtyMask)
 {
     const netactor_t* fromActor = NULL;
 
@@ -3405,6 +3543,12 @@ static void Net_WriteNetActorsToBuffer(NetBuffer_t* netBuffer, const netmapstate
         actorIndex < fromMaxIndex
         )
     {
+        // identical in both snapshots, NetBuffer_WriteDeltaNetActor() wouldn't write anything
+        if (dirtyMask && !Net_IsDirty(dirtyMask->actor, actorIndex))
+        {
+            actorIndex++;
+            continue;
+        }
 
         // load actor pointers using actor indexes
         if (actorIndex >= to->maxActorIndex)
@@ -3444,7 +3588,8 @@ static void Net_WriteNetActorsToBuffer(NetBuffer_t* netBuffer, const netmapstate
 }
 
 
-static void Net_WriteWorldToBuffer(NetBuffer_t* netBuffer, const netmapstate_t* fromSnapshot, const netmapstate_t* toSnapshot)
+// dirtyMask may be NULL, in which case every entity is compared.
+static void Net_WriteWorldToBuffer(NetBuffer_t* netBuffer, const netmapstate_t* fromSnapshot, const netmapstate_t* toSnapshot, const netdirtymask_t* dirtyMask)
 {
     int32_t index = 0;
 
@@ -3452,6 +3597,11 @@ static void Net_WriteWorldToBuffer(NetBuffer_t* netBuffer, const netmapstate_t*
     {
         Bassert(index < MAXWALLS);
 
+        if (dirtyMask && !Net_IsDirty(dirtyMask->wall, index))
+        {
+            continue;
+        }
+
         const netWall_t* fromWall = &fromSnapshot->wall[index];
         const netWall_t* toWall = &toSnapshot->wall[index];
 
@@ -3467,6 +3617,11 @@ static void Net_WriteWorldToBuffer(NetBuffer_t* netBuffer, const netmapstate_t*
     {
         Bassert(index < MAXSECTORS);
 
+        if (dirtyMask && !Net_IsDirty(dirtyMask->sector, index))
+        {
+            continue;
+        }
+
         const netSector_t* fromSector = &fromSnapshot->sector[index];
         const netSector_t* toSector = &toSnapshot->sector[index];
 
@@ -3475,7 +3630,7 @@ static void Net_WriteWorldToBuffer(NetBuffer_t* netBuffer, const netmapstate_t*
 
     NetBuffer_WriteBits(netBuffer, cSTOP_PARSING_CODE, NETINDEX_BITS);
 
-    Net_WriteNetActorsToBuffer(netBuffer, fromSnapshot, toSnapshot);
+    Net_WriteNetActorsToBuffer(netBuffer, fromSnapshot, toSnapshot, dirtyMask);
 
     NetBuffer_WriteBits(netBuffer, cSTOP_PARSING_CODE, NETINDEX_BITS); // end of actors/sprites
 
@@ -4207,6 +4362,74 @@ static void NetBuffer_ReadWorldSnapshotFromBuffer(NetBuffer_t* netBuffer, netmap
 }
 
 
+// Records which entities changed between the previous server revision and this one.
+// prevMapState is NULL if the previous revision isn't available.
+static void Net_UpdateDirtyMask(const netmapstate_t* prevMapState, const netmapstate_t* curMapState, netdirtymask_t* dirtyMask)
+{
+    if (!prevMapState)
+    {
+        dirtyMask->all = true;
+        return;
+    }
+
+    memset(dirtyMask, 0, sizeof(*dirtyMask));
+
+    for (int32_t index = 0; index < numwalls; index++)
+    {
+        if (memcmp(&prevMapState->wall[index], &curMapState->wall[index], sizeof(netWall_t)))
+        {
+            Net_SetDirty(dirtyMask->wall, index);
+        }
+    }
+
+    for (int32_t index = 0; index < numsectors; index++)
+    {
+        if (memcmp(&prevMapState->sector[index], &curMapState->sector[index], sizeof(netSector_t)))
+        {
+            Net_SetDirty(dirtyMask->sector, index);
+        }
+    }
+
+    int32_t const maxActorIndex = max(prevMapState->maxActorIndex, curMapState->maxActorIndex);
+
+    for (int32_t index = 0; index < maxActorIndex; index++)
+    {
+        if (memcmp(&prevMapState->actor[index], &curMapState->actor[index], sizeof(netactor_t)))
+        {
+            Net_SetDirty(dirtyMask->actor, index);
+        }
+    }
+}
+
+// Collects everything that changed after fromRevisionNumber up to and including toRevisionNumber.
+// dirtyHistory holds the masks of the last historySize revisions, indexed by <revision number> % historySize.
+// Returns false if that isn't known, then all entities have to be compared.
+static bool Net_CollectDirtyMask(const netdirtymask_t* dirtyHistory, uint32_t historySize, uint32_t fromRevisionNumber, uint32_t toRevisionNumber, netdirtymask_t* dirtyMask)
+{
+    memset(dirtyMask, 0, sizeof(*dirtyMask));
+
+    for (uint32_t revisionNumber = fromRevisionNumber + 1; revisionNumber - 1 != toRevisionNumber; revisionNumber++)
+    {
+        const netdirtymask_t* revisionMask = &dirtyHistory[revisionNumber % historySize];
+
+        if (revisionMask->all)
+        {
+            return false;
+        }
+
+        for (unsigned i = 0; i < ARRAY_SIZE(dirtyMask->wall); i++)
+            dirtyMask->wall[i] |= revisionMask->wall[i];
+
+        for (unsigned i = 0; i < ARRAY_SIZE(dirtyMask->sector); i++)
+            dirtyMask->sector[i] |= revisionMask->sector[i];
+
+        for (unsigned i = 0; i < ARRAY_SIZE(dirtyMask->actor); i++)
+            dirtyMask->actor[i] |= revisionMask->actor[i];
+    }
+
+    return true;
+}
+
 static void Net_SendWorldUpdate(uint32_t fromRevisionNumber, uint32_t toRevisionNumber, int32_t sendToPlayerIndex)
 {
     if (sendToPlayerIndex == myconnectindex)
@@ -4236,6 +4459,7 @@ static void Net_SendWorldUpdate(uint32_t fromRevisionNumber, uint32_t toRevision
 
     netmapstate_t*  toMapState = &g_mapStateHistory[toRevisionNumber % NET_REVISIONS];
     netmapstate_t*  fromMapState = NULL;
+    netdirtymask_t* dirtyMask = NULL;
 
     NET_75_CHECK++; // during the rollover state it might be a good idea to init the map state history?
                     // maybe not? I do init map states before using them, so it might not be needed.
@@ -4252,6 +4476,11 @@ static void Net_SendWorldUpdate(uint32_t fromRevisionNumber, uint32_t toRevision
 
         fromMapState = &g_mapStateHistory[tFromRevisionIndex];
         fromRevisionNumberToSend = fromRevisionNumber;
+
+        if (Net_CollectDirtyMask(&g_mapDirtyHistory[0], NET_REVISIONS, fromRevisionNumber, toRevisionNumber, &g_sendDirtyMask))
+        {
+            dirtyMask = &g_sendDirtyMask;
+        }
     }
 
 
@@ -4264,7 +4493,7 @@ static void Net_SendWorldUpdate(uint32_t fromRevisionNumber, uint32_t toRevision
     NetBuffer_WriteDword(bufferPtr, fromRevisionNumberToSend);
     NetBuffer_WriteDword(bufferPtr, toRevisionNumber);
 
-    Net_WriteWorldToBuffer(bufferPtr, fromMapState, toMapState);
+    Net_WriteWorldToBuffer(bufferPtr, fromMapState, toMapState, dirtyMask);
 
     if (sendToPlayerIndex > ((int32_t) g_netServer->peerCount))
     {
@@ -4624,6 +4853,16 @@ void Net_SendMapUpdate(void)
 
     toMapState->revisionNumber = g_netMapRevisionNumber;
 
+    // the previous slot doesn't hold the previous revision if the counter just started or rolled over
+    const netmapstate_t* prevMapState = NULL;
+
+    if (g_netMapRevisionNumber > cStartingRevisionIndex)
+    {
+        prevMapState = &g_mapStateHistory[(g_netMapRevisionNumber - 1) % NET_REVISIONS];
+    }
+
+    Net_UpdateDirtyMask(prevMapState, toMapState, &g_mapDirtyHistory[g_netMapRevisionNumber % NET_REVISIONS]);
+
     int32_t playerIndex = 0;
 
     for (TRAVERSE_CONNECT(playerIndex))
@@ -4756,6 +4995,8 @@ void Net_Connect(const char *srvaddr)
         return;
     }
 
+    Net_SetupCompression(g_netClient);
+
     addrstr = strtok(oursrvaddr, ":");
     enet_address_set_host(&address, addrstr);
     addrstr      = strtok(NULL, ":");
@@ -5146,6 +5387,8 @@ void Net_InitMapStateHistory()
 
         Net_InitMapState(mapState);
         Net_InitMapState(clState);
+
+        g_mapDirtyHistory[mapStateIndex].all = true;
     }
 
     Net_InitMapState(&g_mapStartState);
@@ -5160,6 +5403,7 @@ void Net_StartNewGame()
 {
     g_mapStateHistory.Resize(NET_REVISIONS);
     g_cl_InterpolatedMapStateHistory.Resize(NET_REVISIONS);
+    g_mapDirtyHistory.Resize(NET_REVISIONS);
     tempnetbuf.Resize(MAX_WORLDBUFFER);
     Net_ResetPlayers();
 
@@ -5250,7 +5494,11 @@ void Net_InitNetwork()
 
     if (g_netServer == NULL)
         initprintf("An error occurred while trying to create an ENet server host.\n");
-    else initprintf("Multiplayer server initialized\n");
+    else
+    {
+        Net_SetupCompression(g_netServer);
+        initprintf("Multiplayer server initialized\n");
+    }
 }
 
 void Net_PrintLag(FString &output)
@@ -5378,6 +5626,622 @@ static int osdcmd_kickban(osdcmdptr_t parm)
 }
 #endif
 
+
+//------------------------------------------------------------------------------------------------------------------------
+// Loopback benchmark
+//
+// net_bench starts a server and a number of clients inside this process and sends them world updates
+// for the current map, just like Net_SendMapUpdate does in a real game. Every client is connected
+// through its own relay socket that delays, jitters and drops datagrams in both directions.
+//
+// Only the snapshots are changed by the scripted movement, the game state itself is never touched.
+// Client 0 decodes every update it receives and checks the result against what the server sent,
+// the other clients just acknowledge the revisions they got.
+//------------------------------------------------------------------------------------------------------------------------
+
+enum
+{
+    NETBENCH_REVISIONS   = 8,   // revisions kept by the server and the decoding client
+    NETBENCH_MAXCLIENTS  = MAXPLAYERS - 1,
+    NETBENCH_ACTIVESPAN  = 64,  // distance in build units that moving actors travel back and forth
+};
+
+typedef struct netbenchsettings_s
+{
+    int32_t numClients;
+    int32_t numTics;
+    int32_t latency;    // in ms, one way
+    int32_t jitter;     // in ms, added to the latency
+    int32_t loss;       // in percent, per datagram and direction
+    int32_t activity;   // percentage of actors that move every tic
+} netbenchsettings_t;
+
+typedef struct netbenchdatagram_s
+{
+    uint64_t    deliverTime;
+    bool        toClient;
+    int32_t     length;
+    uint8_t     data[ENET_PROTOCOL_MAXIMUM_MTU];
+} netbenchdatagram_t;
+
+typedef struct netbenchlinkstats_s
+{
+    uint32_t    packets;
+    uint32_t    dropped;
+    uint64_t    bytes;
+} netbenchlinkstats_t;
+
+struct netbenchclient_t
+{
+    ENetHost*   host = NULL;
+    ENetPeer*   peer = NULL;        // the client's connection to the server
+    ENetPeer*   serverPeer = NULL;  // the server's connection to the client
+
+    ENetSocket  relay = ENET_SOCKET_NULL;
+    ENetAddress relayAddress;
+    ENetAddress clientAddress;
+    bool        knowsClient = false;
+
+    TArray<netbenchdatagram_t> inFlight;
+
+    netbenchlinkstats_t up = {}, down = {};
+
+    uint32_t    ackedRevision = cInitialMapStateRevisionNumber;     // as seen by the server
+    uint32_t    receivedRevision = cInitialMapStateRevisionNumber;  // as seen by the client
+    uint32_t    updatesSent = 0;
+    uint32_t    updatesReceived = 0;
+    uint64_t    updateBytes = 0;
+};
+
+typedef struct netbenchprobe_s
+{
+    uint32_t    decoded;
+    uint32_t    undecodable;    // the from revision was no longer available
+    uint32_t    mismatches;
+    uint64_t    decodeTime;
+    uint64_t    maxDecodeTime;
+} netbenchprobe_t;
+
+static uint32_t g_netBenchRandom;
+
+static uint32_t Net_BenchRandom(void)
+{
+    // xorshift, so that the benchmark doesn't disturb the game's random number generator
+    g_netBenchRandom ^= g_netBenchRandom << 13;
+    g_netBenchRandom ^= g_netBenchRandom >> 17;
+    g_netBenchRandom ^= g_netBenchRandom << 5;
+    return g_netBenchRandom;
+}
+
+// IPv4 loopback as an IPv4 mapped IPv6 address, which is what ENet's dual stack sockets expect
+static ENetAddress Net_BenchLoopbackAddress(void)
+{
+    ENetAddress address;
+
+    memset(&address, 0, sizeof(address));
+
+    uint8_t* const bytes = (uint8_t*)&address.host;
+
+    bytes[10] = bytes[11] = 0xff;
+    bytes[12] = 127;
+    bytes[15] = 1;
+
+    return address;
+}
+
+static inline bool Net_BenchSameAddress(const ENetAddress* a, const ENetAddress* b)
+{
+    return a->port == b->port && in6_equal(a->host, b->host);
+}
+
+// Moves the active actors of a snapshot along a fixed pattern, so that consecutive revisions differ
+// in the same way they would with monsters and projectiles moving around.
+static void Net_BenchMoveActors(netmapstate_t* mapState, uint32_t revisionNumber, int32_t activity)
+{
+    for (int32_t index = 0; index < mapState->maxActorIndex; index++)
+    {
+        netactor_t* const netActor = &mapState->actor[index];
+
+        if (netActor->spr_statnum == cLocSprite_DeletedSpriteStat || (index * 37) % 100 >= activity)
+        {
+            continue;
+        }
+
+        int32_t const phase = (int32_t)((revisionNumber + index) % (NETBENCH_ACTIVESPAN * 2));
+        int32_t const offset = phase < NETBENCH_ACTIVESPAN ? phase : NETBENCH_ACTIVESPAN * 2 - phase;
+
+        netActor->spr_x += offset;
+        netActor->spr_y -= offset;
+        netActor->spr_ang = (netActor->spr_ang + revisionNumber * 16) & 2047;
+    }
+}
+
+// Forwards everything that arrived at a client's relay socket and delivers what is due.
+static void Net_BenchPumpLink(netbenchclient_t* client, const ENetAddress* serverAddress, const netbenchsettings_t* settings, uint64_t now)
+{
+    netbenchdatagram_t datagram;
+    ENetAddress        fromAddress;
+    ENetBuffer         buffer;
+
+    buffer.data       = datagram.data;
+    buffer.dataLength = sizeof(datagram.data);
+
+    while ((datagram.length = enet_socket_receive(client->relay, &fromAddress, &buffer, 1)) > 0)
+    {
+        datagram.toClient = Net_BenchSameAddress(&fromAddress, serverAddress);
+
+        if (!datagram.toClient)
+        {
+            client->clientAddress = fromAddress;
+            client->knowsClient = true;
+        }
+
+        netbenchlinkstats_t* const stats = datagram.toClient ? &client->down : &client->up;
+
+        stats->packets++;
+        stats->bytes += datagram.length;
+
+        if ((int32_t)(Net_BenchRandom() % 100) < settings->loss)
+        {
+            stats->dropped++;
+            continue;
+        }
+
+        uint64_t delay = settings->latency;
+
+        if (settings->jitter > 0)
+        {
+            delay += Net_BenchRandom() % (settings->jitter + 1);
+        }
+
+        datagram.deliverTime = now + delay * 1000000;
+        client->inFlight.Push(datagram);
+    }
+
+    for (unsigned i = 0; i < client->inFlight.Size();)
+    {
+        netbenchdatagram_t* const pending = &client->inFlight[i];
+
+        if (pending->deliverTime > now)
+        {
+            i++;
+            continue;
+        }
+
+        if (!pending->toClient || client->knowsClient)
+        {
+            buffer.data       = pending->data;
+            buffer.dataLength = pending->length;
+
+            enet_socket_send(client->relay, pending->toClient ? &client->clientAddress : serverAddress, &buffer, 1);
+        }
+
+        client->inFlight.Delete(i);
+    }
+}
+
+static void Net_BenchSendAck(netbenchclient_t* client, uint32_t revisionNumber)
+{
+    uint8_t ack[5];
+
+    ack[0] = PACKET_ACK;
+    B_BUF32(&ack[1], revisionNumber);
+
+    enet_peer_send(client->peer, CHAN_MOVE, enet_packet_create(ack, sizeof(ack), 0));
+}
+
+// Decodes a world update on the probing client and compares the result with the server's copy.
+// Returns false if the update couldn't be decoded.
+static bool Net_BenchDecodeUpdate(const ENetPacket* packet, netbenchprobe_t* probe, netmapstate_t* baseMapState,
+                                  TArray<netmapstate_t>& probeHistory, TArray<netmapstate_t>& serverHistory)
+{
+    NetBuffer_t buffer;
+
+    NetBuffer_Init(&buffer, packet->data + 1, packet->dataLength - 1);
+    buffer.CurSize = packet->dataLength - 1;
+
+    uint32_t const fromRevisionNumber = NetBuffer_ReadDWord(&buffer);
+    uint32_t const toRevisionNumber = NetBuffer_ReadDWord(&buffer);
+
+    netmapstate_t* fromMapState = baseMapState;
+
+    if (fromRevisionNumber != cInitialMapStateRevisionNumber)
+    {
+        fromMapState = &probeHistory[fromRevisionNumber % NETBENCH_REVISIONS];
+
+        if (fromMapState->revisionNumber != fromRevisionNumber)
+        {
+            probe->undecodable++;
+            return false;
+        }
+    }
+
+    netmapstate_t* const toMapState = &probeHistory[toRevisionNumber % NETBENCH_REVISIONS];
+
+    uint64_t const startTime = I_nsTime();
+
+    NetBuffer_ReadWorldSnapshotFromBuffer(&buffer, fromMapState, toMapState);
+
+    uint64_t const decodeTime = I_nsTime() - startTime;
+
+    toMapState->revisionNumber = toRevisionNumber;
+
+    probe->decoded++;
+    probe->decodeTime += decodeTime;
+    probe->maxDecodeTime = max(probe->maxDecodeTime, decodeTime);
+
+    const netmapstate_t* const serverMapState = &serverHistory[toRevisionNumber % NETBENCH_REVISIONS];
+
+    if (serverMapState->revisionNumber == toRevisionNumber
+        && (memcmp(toMapState->wall, serverMapState->wall, numwalls * sizeof(netWall_t))
+            || memcmp(toMapState->sector, serverMapState->sector, numsectors * sizeof(netSector_t))
+            || memcmp(toMapState->actor, serverMapState->actor, sizeof(toMapState->actor))))
+    {
+        probe->mismatches++;
+    }
+
+    return true;
+}
+
+static void Net_BenchServiceClient(netbenchclient_t* client, int32_t clientIndex, netbenchprobe_t* probe, netmapstate_t* baseMapState,
+                                   TArray<netmapstate_t>& probeHistory, TArray<netmapstate_t>& serverHistory)
+{
+    ENetEvent event;
+
+    while (enet_host_service(client->host, &event, 0) > 0)
+    {
+        if (event.type != ENET_EVENT_TYPE_RECEIVE)
+        {
+            continue;
+        }
+
+        if (event.packet->dataLength >= 9 && event.packet->data[0] == PACKET_WORLD_UPDATE)
+        {
+            NetBuffer_t buffer;
+
+            NetBuffer_Init(&buffer, event.packet->data + 1, event.packet->dataLength - 1);
+            buffer.CurSize = event.packet->dataLength - 1;
+
+            NetBuffer_ReadDWord(&buffer);
+            uint32_t const toRevisionNumber = NetBuffer_ReadDWord(&buffer);
+
+            // like Net_ReadWorldUpdate, ignore updates that arrive out of order
+            if (toRevisionNumber > client->receivedRevision)
+            {
+                client->updatesReceived++;
+
+                // the decoding client can only acknowledge what it actually has
+                if (clientIndex != 0 || Net_BenchDecodeUpdate(event.packet, probe, baseMapState, probeHistory, serverHistory))
+                {
+                    client->receivedRevision = toRevisionNumber;
+                    Net_BenchSendAck(client, toRevisionNumber);
+                }
+            }
+        }
+
+        enet_packet_destroy(event.packet);
+    }
+}
+
+static void Net_BenchServiceServer(ENetHost* server, TArray<netbenchclient_t>& clients)
+{
+    ENetEvent event;
+
+    while (enet_host_service(server, &event, 0) > 0)
+    {
+        switch (event.type)
+        {
+        case ENET_EVENT_TYPE_CONNECT:
+            // clients are told apart by the relay they come through
+            for (auto& client : clients)
+            {
+                if (event.peer->address.port == client.relayAddress.port)
+                {
+                    client.serverPeer = event.peer;
+                    event.peer->data = &client;
+                }
+            }
+            break;
+
+        case ENET_EVENT_TYPE_RECEIVE:
+        {
+            netbenchclient_t* const client = (netbenchclient_t*)event.peer->data;
+
+            if (client && event.packet->dataLength == 5 && event.packet->data[0] == PACKET_ACK)
+            {
+                uint32_t const revisionNumber = B_UNBUF32(&event.packet->data[1]);
+
+                client->ackedRevision = max(client->ackedRevision, revisionNumber);
+            }
+
+            enet_packet_destroy(event.packet);
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+}
+
+static void Net_BenchPump(ENetHost* server, const ENetAddress* serverAddress, TArray<netbenchclient_t>& clients, const netbenchsettings_t* settings,
+                          netbenchprobe_t* probe, netmapstate_t* baseMapState, TArray<netmapstate_t>& probeHistory, TArray<netmapstate_t>& serverHistory)
+{
+    uint64_t const now = I_nsTime();
+
+    Net_BenchServiceServer(server, clients);
+
+    for (unsigned i = 0; i < clients.Size(); i++)
+    {
+        Net_BenchPumpLink(&clients[i], serverAddress, settings, now);
+        Net_BenchServiceClient(&clients[i], i, probe, baseMapState, probeHistory, serverHistory);
+        Net_BenchPumpLink(&clients[i], serverAddress, settings, now);
+    }
+}
+
+static void Net_BenchShutdown(ENetHost* server, TArray<netbenchclient_t>& clients)
+{
+    for (auto& client : clients)
+    {
+        if (client.host)
+        {
+            enet_host_destroy(client.host);
+        }
+
+        if (client.relay != ENET_SOCKET_NULL)
+        {
+            enet_socket_destroy(client.relay);
+        }
+    }
+
+    if (server)
+    {
+        enet_host_destroy(server);
+    }
+}
+
+static void Net_RunBenchmark(const netbenchsettings_t* settings)
+{
+    TArray<netbenchclient_t> clients;
+    TArray<netmapstate_t>    serverHistory, probeHistory;
+    TArray<netdirtymask_t>   dirtyHistory;
+    TArray<uint8_t>          updateBuffer;
+    netdirtymask_t           sendDirtyMask;
+    netbenchprobe_t          probe = {};
+
+    g_netBenchRandom = 0x2545F491;
+
+    // the last element is the initial map state, which every client already has
+    serverHistory.Resize(NETBENCH_REVISIONS + 1);
+    probeHistory.Resize(NETBENCH_REVISIONS);
+    dirtyHistory.Resize(NETBENCH_REVISIONS);
+    updateBuffer.Resize(MAX_WORLDBUFFER + 1);
+
+    netmapstate_t* const baseMapState = &serverHistory[NETBENCH_REVISIONS];
+
+    Net_InitMapState(baseMapState);
+    baseMapState->revisionNumber = cInitialMapStateRevisionNumber;
+
+    for (unsigned i = 0; i < NETBENCH_REVISIONS; i++)
+    {
+        serverHistory[i].revisionNumber = probeHistory[i].revisionNumber = cInitialMapStateRevisionNumber;
+    }
+
+    ENetAddress serverAddress = Net_BenchLoopbackAddress();
+    ENetHost* const server = enet_host_create(&serverAddress, settings->numClients, CHAN_MAX, 0, 0);
+
+    clients.Resize(settings->numClients);
+
+    if (!server)
+    {
+        Printf("net_bench: unable to create the server host\n");
+        return;
+    }
+
+    Net_SetupCompression(server);
+    serverAddress = server->address;
+
+    for (auto& client : clients)
+    {
+        client.relayAddress = Net_BenchLoopbackAddress();
+        client.relay = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM);
+
+        if (client.relay == ENET_SOCKET_NULL
+            || enet_socket_set_option(client.relay, ENET_SOCKOPT_IPV6_V6ONLY, 0) < 0
+            || enet_socket_bind(client.relay, &client.relayAddress) < 0
+            || enet_socket_get_address(client.relay, &client.relayAddress) < 0
+            || (client.host = enet_host_create(NULL, 1, CHAN_MAX, 0, 0)) == NULL)
+        {
+            Printf("net_bench: unable to set up the loopback links\n");
+            Net_BenchShutdown(server, clients);
+            return;
+        }
+
+        enet_socket_set_option(client.relay, ENET_SOCKOPT_NONBLOCK, 1);
+        Net_SetupCompression(client.host);
+        client.peer = enet_host_connect(client.host, &client.relayAddress, CHAN_MAX, 0);
+    }
+
+    // connect everybody, allowing for a few lost handshake datagrams
+    uint64_t const connectDeadline = I_nsTime() + 10000000000ull;
+    int32_t numConnected = 0;
+
+    while (numConnected < settings->numClients && I_nsTime() < connectDeadline)
+    {
+        Net_BenchPump(server, &serverAddress, clients, settings, &probe, baseMapState, probeHistory, serverHistory);
+
+        numConnected = 0;
+        for (auto& client : clients)
+        {
+            numConnected += client.serverPeer != NULL && client.peer->state == ENET_PEER_STATE_CONNECTED;
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+
+    if (numConnected < settings->numClients)
+    {
+        Printf("net_bench: only %d of %d clients could connect\n", numConnected, settings->numClients);
+        Net_BenchShutdown(server, clients);
+        return;
+    }
+
+    for (auto& client : clients)
+    {
+        client.up = client.down = {};
+    }
+
+    uint64_t const ticTime = 1000000000ull / REALGAMETICSPERSEC;
+    uint64_t const startTime = I_nsTime();
+    uint64_t snapshotTime = 0, encodeTime = 0, maxTicTime = 0;
+    uint64_t nextTic = startTime;
+
+    for (uint32_t revisionNumber = cStartingRevisionIndex; revisionNumber <= (uint32_t)settings->numTics; revisionNumber++)
+    {
+        while (I_nsTime() < nextTic)
+        {
+            Net_BenchPump(server, &serverAddress, clients, settings, &probe, baseMapState, probeHistory, serverHistory);
+            std::this_thread::sleep_for(std::chrono::microseconds(250));
+        }
+
+        nextTic += ticTime;
+
+        // the same work Net_SendMapUpdate does every tic
+        uint64_t const ticStart = I_nsTime();
+
+        netmapstate_t* const toMapState = &serverHistory[revisionNumber % NETBENCH_REVISIONS];
+
+        Net_InitMapState(toMapState);
+        Net_AddWorldToSnapshot(toMapState);
+        Net_BenchMoveActors(toMapState, revisionNumber, settings->activity);
+
+        toMapState->revisionNumber = revisionNumber;
+
+        const netmapstate_t* prevMapState = NULL;
+
+        if (revisionNumber > cStartingRevisionIndex)
+        {
+            prevMapState = &serverHistory[(revisionNumber - 1) % NETBENCH_REVISIONS];
+        }
+
+        Net_UpdateDirtyMask(prevMapState, toMapState, &dirtyHistory[revisionNumber % NETBENCH_REVISIONS]);
+
+        uint64_t const encodeStart = I_nsTime();
+
+        snapshotTime += encodeStart - ticStart;
+
+        for (auto& client : clients)
+        {
+            uint32_t const fromRevisionNumber = client.ackedRevision;
+
+            const netmapstate_t* fromMapState = baseMapState;
+            netdirtymask_t* dirtyMask = NULL;
+
+            if (fromRevisionNumber != cInitialMapStateRevisionNumber && revisionNumber - fromRevisionNumber < NETBENCH_REVISIONS)
+            {
+                fromMapState = &serverHistory[fromRevisionNumber % NETBENCH_REVISIONS];
+
+                if (Net_CollectDirtyMask(&dirtyHistory[0], NETBENCH_REVISIONS, fromRevisionNumber, revisionNumber, &sendDirtyMask))
+                {
+                    dirtyMask = &sendDirtyMask;
+                }
+            }
+
+            NetBuffer_t buffer;
+
+            updateBuffer[0] = PACKET_WORLD_UPDATE;
+            NetBuffer_Init(&buffer, &updateBuffer[1], MAX_WORLDBUFFER);
+
+            NetBuffer_WriteDword(&buffer, fromMapState->revisionNumber);
+            NetBuffer_WriteDword(&buffer, revisionNumber);
+
+            Net_WriteWorldToBuffer(&buffer, fromMapState, toMapState, dirtyMask);
+
+            enet_peer_send(client.serverPeer, CHAN_GAMESTATE, enet_packet_create(&updateBuffer[0], buffer.CurSize + 1, 0));
+
+            client.updatesSent++;
+            client.updateBytes += buffer.CurSize + 1;
+        }
+
+        enet_host_flush(server);
+
+        uint64_t const ticEnd = I_nsTime();
+
+        encodeTime += ticEnd - encodeStart;
+        maxTicTime = max(maxTicTime, ticEnd - ticStart);
+    }
+
+    // let the last updates arrive
+    uint64_t const drainDeadline = I_nsTime() + (settings->latency + settings->jitter) * 2000000ull + 250000000ull;
+
+    while (I_nsTime() < drainDeadline)
+    {
+        Net_BenchPump(server, &serverAddress, clients, settings, &probe, baseMapState, probeHistory, serverHistory);
+        std::this_thread::sleep_for(std::chrono::microseconds(250));
+    }
+
+    double const seconds = (I_nsTime() - startTime) / 1e9;
+    int32_t const numTics = max(settings->numTics, 1);
+
+    Printf("net_bench: %d clients, %d tics, %d ms latency, %d ms jitter, %d%% loss, %d%% active actors\n",
+           settings->numClients, settings->numTics, settings->latency, settings->jitter, settings->loss, settings->activity);
+    Printf("server tic: %.3f ms snapshot, %.3f ms encoding, %.3f ms average, %.3f ms max\n",
+           snapshotTime / 1e6 / numTics, encodeTime / 1e6 / numTics, (snapshotTime + encodeTime) / 1e6 / numTics, maxTicTime / 1e6);
+    Printf("%-6s %12s %12s %12s %10s %10s %10s\n", "client", "update B/s", "down B/s", "up B/s", "sent", "received", "dropped");
+
+    for (unsigned i = 0; i < clients.Size(); i++)
+    {
+        auto const& client = clients[i];
+
+        Printf("%-6u %12.0f %12.0f %12.0f %10u %10u %10u\n", i, client.updateBytes / seconds, client.down.bytes / seconds, client.up.bytes / seconds,
+               client.updatesSent, client.updatesReceived, client.down.dropped + client.up.dropped);
+    }
+
+    if (probe.decoded)
+    {
+        Printf("client 0 decoding: %.3f ms average, %.3f ms max, %u updates, %u undecodable, %u mismatches\n",
+               probe.decodeTime / 1e6 / probe.decoded, probe.maxDecodeTime / 1e6, probe.decoded, probe.undecodable, probe.mismatches);
+    }
+
+    Net_BenchShutdown(server, clients);
+}
+
+CCMD(net_bench)
+{
+    netbenchsettings_t settings = { 4, REALGAMETICSPERSEC * 10, 50, 10, 1, 10 };
+    int32_t* const params[] = { &settings.numClients, &settings.numTics, &settings.latency, &settings.jitter, &settings.loss, &settings.activity };
+
+    for (int i = 1; i < argv.argc() && i <= (int)ARRAY_SIZE(params); i++)
+    {
+        *params[i - 1] = max(0, (int)strtol(argv[i], nullptr, 10));
+    }
+
+    if (argv.argc() > 1 && !stricmp(argv[1], "help"))
+    {
+        Printf("Usage: net_bench [clients] [tics] [latency ms] [jitter ms] [loss %%] [active actors %%]\n");
+        return;
+    }
+
+    if (g_netServer || g_netClient)
+    {
+        Printf("net_bench can't be used during a network game\n");
+        return;
+    }
+
+    if (numsectors <= 0)
+    {
+        Printf("net_bench needs a map to be loaded\n");
+        return;
+    }
+
+    settings.numClients = clamp(settings.numClients, 1, (int32_t)NETBENCH_MAXCLIENTS);
+    settings.numTics = max(settings.numTics, 1);
+    settings.loss = min(settings.loss, 100);
+    settings.activity = min(settings.activity, 100);
+
+    Net_RunBenchmark(&settings);
+}
+
 #endif
 
 //-------------------------------------------------------------------------------------------------
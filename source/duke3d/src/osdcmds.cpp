@@ -546,75 +546,6 @@ static int osdcmd_password(osdcmdptr_t parm)
 int osdcmd_listplayers(osdcmdptr_t parm);
 
 
-
-static int osdcmd_printtimes(osdcmdptr_t UNUSED(parm))
-{
-    UNREFERENCED_CONST_PARAMETER(parm);
-
-    char buf[32];
-    int32_t maxlen = 0;
-    int32_t haveev=0, haveac=0;
-    static char const s_event_[] = "EVENT_";
-    int constexpr strlen_event_  = ARRAY_SIZE(s_event_) - 1;
-
-    for (auto & EventName : EventNames)
-    {
-        int const len = Bstrlen(EventName+strlen_event_);
-        Bassert(len < ARRAY_SSIZE(buf));
-        maxlen = max(len, maxlen);
-    }
-
-    for (int i=0; i<MAXEVENTS; i++)
-        if (g_eventCalls[i])
-        {
-            int32_t n=Bsprintf(buf, "%s", EventNames[i]+strlen_event_);
-
-            if (!haveev)
-            {
-                haveev = 1;
-                OSD_Printf("\nevent times: event, total calls, total time [ms], mean time/call [us]\n");
-            }
-
-            buf[n] = 0;
-
-            OSD_Printf("%17s, %8d, %10.3f, %10.3f,\n",
-                buf, g_eventCalls[i], g_eventTotalMs[i],
-                1000*g_eventTotalMs[i]/g_eventCalls[i]);
-        }
-
-    for (int i=0; i<MAXTILES; i++)
-        if (g_actorCalls[i])
-        {
-            if (!haveac)
-            {
-                haveac = 1;
-                OSD_Printf("\nactor times: tile, total calls, total time [ms], {min,mean,max} time/call [us]\n");
-            }
-
-            buf[0] = 0;
-
-            for (int ii=0; ii<g_labelCnt; ii++)
-            {
-                if (labelcode[ii] == i && labeltype[ii] & LABEL_ACTOR)
-                {
-                    Bstrcpy(buf, label+(ii<<6));
-                    break;
-                }
-            }
-
-            if (!buf[0]) Bsprintf(buf, "%d", i);
-
-            OSD_Printf("%17s, %8d, %9.3f, %9.3f, %9.3f, %9.3f,\n",
-                buf, g_actorCalls[i], g_actorTotalMs[i],
-                1000*g_actorMinMs[i],
-                1000*g_actorTotalMs[i]/g_actorCalls[i],
-                1000*g_actorMaxMs[i]);
-        }
-
-    return OSDCMD_OK;
-}
-
-
 int32_t registerosdcommands(void)
 {
 #if !defined NETCODE_DISABLE
@@ -646,7 +577,6 @@ int32_t registerosdcommands(void)
     OSD_RegisterFunction("levelwarp","levelwarp <e> <m>: warp to episode 'e' and map 'm'", osdcmd_levelwarp);
 
 
-    OSD_RegisterFunction("printtimes", "printtimes: prints VM timing statistics", osdcmd_printtimes);
 
     OSD_RegisterFunction("restartmap", "restartmap: restarts the current map", osdcmd_restartmap);
 	OSD_RegisterFunction("addlogvar","addlogvar <gamevar>: prints the value of a gamevar", osdcmd_addlogvar);
@@ -476,6 +476,10 @@ void G_CacheMapData(void)
             gameHandleEvents();
     }
 
+#ifdef USE_OPENGL
+    FinishHardwareTexturePrecache([](int, int) { gameHandleEvents(); });
+#endif
+
     Bmemset(gotpic, 0, sizeof(gotpic));
 
     OSD_Printf("Cache time: %dms\n", timerGetTicks() - cacheStartTime);
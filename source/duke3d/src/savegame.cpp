@@ -1199,7 +1199,9 @@ static void sv_makevarspec()
     int vcnt = 0;
 
     for (int i = 0; i < g_gameVarCount; i++)
-        vcnt += (aGameVars[i].flags & SV_SKIPMASK) ? 0 : 1;
+        vcnt += (aGameVars[i].flags & (SV_SKIPMASK|GAMEVAR_PERACTOR)) ? 0 : 1;
+
+    vcnt += (g_actorVarStride > 0);
 
     for (int i=0; i<g_gameArrayCount; i++)
         vcnt += !(aGameArrays[i].flags & (GAMEARRAY_SYSTEM|GAMEARRAY_READONLY));  // SYSTEM_GAMEARRAY
@@ -1214,15 +1216,26 @@ static void sv_makevarspec()
 
     for (int i = 0; i < g_gameVarCount; i++)
     {
-        if (aGameVars[i].flags & SV_SKIPMASK)
+        if (aGameVars[i].flags & (SV_SKIPMASK|GAMEVAR_PERACTOR))
             continue;
 
-        unsigned const per = aGameVars[i].flags & GAMEVAR_USER_MASK;
+        unsigned const per = aGameVars[i].flags & GAMEVAR_PERPLAYER;
 
         svgm_vars[vcnt].flags = 0;
         svgm_vars[vcnt].ptr   = (per == 0) ? &aGameVars[i].global : aGameVars[i].pValues;
         svgm_vars[vcnt].size  = sizeof(intptr_t);
-        svgm_vars[vcnt].cnt   = (per == 0) ? 1 : (per == GAMEVAR_PERPLAYER ? MAXPLAYERS : MAXSPRITES);
+        svgm_vars[vcnt].cnt   = (per == 0) ? 1 : MAXPLAYERS;
+
+        ++vcnt;
+    }
+
+    // The per-actor vars are interleaved, so they all go in as one block.
+    if (g_actorVarStride > 0)
+    {
+        svgm_vars[vcnt].flags = 0;
+        svgm_vars[vcnt].ptr   = g_actorVarBlock;
+        svgm_vars[vcnt].size  = sizeof(intptr_t);
+        svgm_vars[vcnt].cnt   = MAXSPRITES * g_actorVarStride;
 
         ++vcnt;
     }
@@ -389,7 +389,7 @@ static void G_SetupCamTile(int spriteNum, int tileNum, int smoothRatio)
     vec3_t const camera     = G_GetCameraPosition(spriteNum, smoothRatio);
     int const    saveMirror = display_mirror;
 
-    renderSetTarget(tileNum, tilesiz[tileNum].y, tilesiz[tileNum].x);
+    bool const hwTarget = renderSetCameraTarget(tileNum, tilesiz[tileNum].y, tilesiz[tileNum].x);
 
     int const noDraw = VM_OnEventWithReturn(EVENT_DISPLAYROOMSCAMERATILE, spriteNum, playerNum, 0);
 
@@ -414,8 +414,12 @@ static void G_SetupCamTile(int spriteNum, int tileNum, int smoothRatio)
 
 finishTileSetup:
     renderRestoreTarget();
-    squarerotatetile(tileNum);
-    tileInvalidate(tileNum, -1, 255);
+
+    if (!hwTarget)
+    {
+        squarerotatetile(tileNum);
+        tileInvalidate(tileNum, -1, 255);
+    }
 }
 
 void G_AnimateCamSprite(int smoothRatio)
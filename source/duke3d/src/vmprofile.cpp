@@ -0,0 +1,273 @@
+//-------------------------------------------------------------------------
+/*
+** vmprofile.cpp
+**
+** Call counts and inclusive/exclusive run times of CON events, actors
+** and states.
+**
+** The profiler keeps a stack of the code blocks currently running. When a
+** block finishes its time is added to the block that called it, so that
+** this can be subtracted from the caller's exclusive time. Recursive calls
+** add their inclusive time once for every level.
+**
+*/
+//-------------------------------------------------------------------------
+
+#include "ns.h"	// Must come before everything else!
+
+#include "duke3d.h"
+#include "vmprofile.h"
+#include "i_time.h"
+#include "c_cvars.h"
+#include "c_dispatch.h"
+#include "files.h"
+#include "printf.h"
+#include "i_specialpaths.h"
+
+BEGIN_DUKE_NS
+
+enum
+{
+    VMPROF_MAXDEPTH = 256,
+};
+
+struct vmprofentry_t
+{
+    uint32_t calls;
+    uint64_t inclusive, exclusive;  // in ns
+    uint64_t mincall, maxcall;      // inclusive time of the fastest and slowest call
+};
+
+struct vmprofframe_t
+{
+    vmprofentry_t *entry;
+    uint64_t start, children;
+};
+
+bool g_vmProfileActive;
+
+static vmprofentry_t eventProfile[MAXEVENTS];
+static vmprofentry_t actorProfile[MAXTILES];
+static TArray<vmprofentry_t> stateProfile;  // by label index, the last one collects unknown states
+static TMap<intptr_t, int> stateLabels;      // script offset to label index
+
+static vmprofframe_t profStack[VMPROF_MAXDEPTH];
+static int profDepth;
+
+static void VM_ProfileInitStates(void)
+{
+    stateLabels.Clear();
+    for (int i = 0; i < g_labelCnt; i++)
+    {
+        if (labeltype[i] & LABEL_STATE)
+            stateLabels.Insert(labelcode[i], i);
+    }
+
+    stateProfile.Resize(g_labelCnt + 1);
+    memset(stateProfile.Data(), 0, stateProfile.Size() * sizeof(vmprofentry_t));
+}
+
+static void VM_ProfileReset(void)
+{
+    memset(eventProfile, 0, sizeof(eventProfile));
+    memset(actorProfile, 0, sizeof(actorProfile));
+    VM_ProfileInitStates();
+}
+
+CUSTOM_CVARD(Bool, vm_profile, false, 0, "collect run time statistics of CON events, actors and states")
+{
+    // Only rebuild the state table when nothing refers to it.
+    if (self && profDepth == 0 && stateProfile.Size() != unsigned(g_labelCnt + 1))
+        VM_ProfileInitStates();
+    g_vmProfileActive = self;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static vmprofentry_t *VM_ProfileEntry(int const kind, intptr_t const id)
+{
+    switch (kind)
+    {
+    case VMPROF_EVENT:
+        return (uintptr_t)id < MAXEVENTS ? &eventProfile[id] : nullptr;
+
+    case VMPROF_ACTOR:
+        return (uintptr_t)id < MAXTILES ? &actorProfile[id] : nullptr;
+
+    default:
+    {
+        if (stateProfile.Size() == 0)
+            VM_ProfileInitStates();
+        int const *const labelNum = stateLabels.CheckKey(id);
+        return &stateProfile[labelNum ? *labelNum : stateProfile.Size() - 1];
+    }
+    }
+}
+
+void VM_ProfileEnter(int const kind, intptr_t const id)
+{
+    if (profDepth < VMPROF_MAXDEPTH)
+    {
+        auto &frame    = profStack[profDepth];
+        frame.entry    = VM_ProfileEntry(kind, id);
+        frame.children = 0;
+        frame.start    = I_nsTime();
+    }
+    profDepth++;
+}
+
+void VM_ProfileLeave(void)
+{
+    if (--profDepth >= VMPROF_MAXDEPTH)
+        return;
+
+    auto &frame = profStack[profDepth];
+    uint64_t const time = I_nsTime() - frame.start;
+
+    // ids out of range are not profiled, but their time still counts for the caller.
+    if (auto const entry = frame.entry)
+    {
+        entry->mincall = entry->calls ? min(entry->mincall, time) : time;
+        entry->maxcall = max(entry->maxcall, time);
+        entry->calls++;
+        entry->inclusive += time;
+        entry->exclusive += time - min(time, frame.children);
+    }
+
+    if (profDepth > 0)
+        profStack[profDepth - 1].children += time;
+}
+
+//==========================================================================
+//
+// Collects all entries that have been called at least once.
+//
+//==========================================================================
+
+struct vmprofrow_t
+{
+    int kind;
+    FString name;
+    vmprofentry_t const *entry;
+};
+
+static void VM_ProfileGetRows(TArray<vmprofrow_t> &rows)
+{
+    for (int i = 0; i < MAXEVENTS; i++)
+    {
+        if (eventProfile[i].calls)
+            rows.Push({ VMPROF_EVENT, EventNames[i], &eventProfile[i] });
+    }
+
+    for (int i = 0; i < MAXTILES; i++)
+    {
+        if (!actorProfile[i].calls)
+            continue;
+
+        FString name;
+        for (int j = 0; j < g_labelCnt; j++)
+        {
+            if (labelcode[j] == i && (labeltype[j] & LABEL_ACTOR))
+            {
+                name = label + (j << 6);
+                break;
+            }
+        }
+        if (name.IsEmpty()) name.Format("%d", i);
+        rows.Push({ VMPROF_ACTOR, name, &actorProfile[i] });
+    }
+
+    for (unsigned i = 0; i < stateProfile.Size(); i++)
+    {
+        if (stateProfile[i].calls)
+            rows.Push({ VMPROF_STATE, i < unsigned(g_labelCnt) ? label + (i << 6) : "<unknown>", &stateProfile[i] });
+    }
+}
+
+static const char *const kindNames[VMPROF_NUMKINDS] = { "event", "actor", "state" };
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+CCMD(vm_profile_print)
+{
+    int sortBy = 0;
+    if (argv.argc() > 1)
+    {
+        if (!stricmp(argv[1], "excl")) sortBy = 0;
+        else if (!stricmp(argv[1], "incl")) sortBy = 1;
+        else if (!stricmp(argv[1], "calls")) sortBy = 2;
+        else
+        {
+            Printf("Usage: vm_profile_print [excl|incl|calls] [count]\n");
+            return;
+        }
+    }
+    int const count = argv.argc() > 2 ? max(1, (int)strtol(argv[2], nullptr, 10)) : 30;
+
+    TArray<vmprofrow_t> rows;
+    VM_ProfileGetRows(rows);
+
+    if (rows.Size() == 0)
+    {
+        Printf("No CON code has been profiled%s\n", g_vmProfileActive ? "" : ", set vm_profile to 1 to start");
+        return;
+    }
+
+    auto sortKey = [=](vmprofrow_t const &row) -> uint64_t
+    {
+        return sortBy == 0 ? row.entry->exclusive : sortBy == 1 ? row.entry->inclusive : row.entry->calls;
+    };
+    std::sort(rows.begin(), rows.end(), [=](vmprofrow_t const &a, vmprofrow_t const &b) { return sortKey(a) > sortKey(b); });
+
+    Printf("%-6s %-32s %10s %12s %12s %10s %10s %10s\n", "type", "name", "calls", "incl [ms]", "excl [ms]", "excl/call [us]", "min [us]", "max [us]");
+    for (unsigned i = 0; i < rows.Size() && i < unsigned(count); i++)
+    {
+        auto const &row = rows[i];
+        Printf("%-6s %-32s %10u %12.3f %12.3f %10.3f %10.3f %10.3f\n", kindNames[row.kind], row.name.GetChars(), row.entry->calls,
+               row.entry->inclusive / 1e6, row.entry->exclusive / 1e6, row.entry->exclusive / 1e3 / row.entry->calls,
+               row.entry->mincall / 1e3, row.entry->maxcall / 1e3);
+    }
+}
+
+CCMD(vm_profile_dump)
+{
+    FString filename;
+    if (argv.argc() > 1) filename = argv[1];
+    else filename.Format("%svmprofile.csv", M_GetDocumentsPath().GetChars());
+
+    TArray<vmprofrow_t> rows;
+    VM_ProfileGetRows(rows);
+
+    FileWriter *fw = FileWriter::Open(filename);
+    if (fw == nullptr)
+    {
+        Printf("Unable to open %s for writing\n", filename.GetChars());
+        return;
+    }
+
+    fw->Printf("type,name,calls,inclusive_ms,exclusive_ms,min_call_us,max_call_us\n");
+    for (auto const &row : rows)
+    {
+        fw->Printf("%s,%s,%u,%.6f,%.6f,%.3f,%.3f\n", kindNames[row.kind], row.name.GetChars(), row.entry->calls,
+                   row.entry->inclusive / 1e6, row.entry->exclusive / 1e6, row.entry->mincall / 1e3, row.entry->maxcall / 1e3);
+    }
+    delete fw;
+
+    Printf("%u entries written to %s\n", rows.Size(), filename.GetChars());
+}
+
+CCMD(vm_profile_reset)
+{
+    if (profDepth == 0)
+        VM_ProfileReset();
+}
+
+END_DUKE_NS
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+
+BEGIN_DUKE_NS
+
+//==========================================================================
+//
+// Profiler for CON code.
+//
+// While vm_profile is set, every event, actor and state invocation is
+// counted and timed. Exclusive times leave out everything the code called
+// itself. vm_profile_print shows the results, vm_profile_dump writes them
+// out as CSV.
+//
+//==========================================================================
+
+enum
+{
+    VMPROF_EVENT,
+    VMPROF_ACTOR,
+    VMPROF_STATE,
+    VMPROF_NUMKINDS
+};
+
+extern bool g_vmProfileActive;
+
+void VM_ProfileEnter(int const kind, intptr_t const id);
+void VM_ProfileLeave(void);
+
+class VMProfileZone
+{
+public:
+    VMProfileZone(int const kind, intptr_t const id)
+    {
+        active = g_vmProfileActive;
+        if (active) VM_ProfileEnter(kind, id);
+    }
+
+    ~VMProfileZone()
+    {
+        if (active) VM_ProfileLeave();
+    }
+
+    VMProfileZone(const VMProfileZone &) = delete;
+    VMProfileZone &operator=(const VMProfileZone &) = delete;
+
+private:
+    bool active;
+};
+
+END_DUKE_NS
@@ -174,5 +174,9 @@ void precache()
 			doTileLoad(j);
         }
     }
+
+#ifdef USE_OPENGL
+    FinishHardwareTexturePrecache();
+#endif
 }
 END_PS_NS
@@ -73,6 +73,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <assert.h>
 #include "gamecvars.h"
 #include "savegamehelp.h"
+#include "gamecontrol.h"
+#include "timedemo.h"
 #include "c_dispatch.h"
 #include "s_soundinternal.h"
 #include "common/menu/menu.h"
@@ -1827,6 +1829,17 @@ void CheckCommandLine(int argc, char const* const* argv, int &doTitle)
             }
         }
     }
+
+    if (TimeDemo_Active() && !bRecord)
+    {
+        if (vcrfp) fclose(vcrfp);
+        vcrfp = fopen(userConfig.CommandDemo, "rb");
+        if (vcrfp == NULL) {
+            I_Error("Can't open demo %s for reading\n", userConfig.CommandDemo.GetChars());
+        }
+        bPlayback = kTrue;
+        doTitle = kFalse;
+    }
 }
 
 
@@ -2207,7 +2220,15 @@ GAMELOOP:
             if (moveframes != 0)
                 tclocks2 = totalclock;
 
-            if (bPlayback)
+            if (bPlayback && TimeDemo_Active())
+            {
+                if (!ReadPlaybackInputs())
+                {
+                    TimeDemo_Report(userConfig.CommandDemo);
+                    goto EXITGAME;
+                }
+            }
+            else if (bPlayback)
             {
                 // YELLOW
                 if (((bInDemo && inputState.keyBufferWaiting()) || !ReadPlaybackInputs()) && inputState.keyGetChar())
@@ -2272,7 +2293,9 @@ GAMELOOP:
             tclocks += moveframes * 4;
             while (moveframes && levelnew < 0)
             {
+                TimeDemo_TickBegin();
                 GameMove();
+                TimeDemo_TickEnd();
                 // if (nNetTime > 0)
                 // {
                 //     nNetTime--;
@@ -2296,15 +2319,30 @@ GAMELOOP:
             // END YELLOW SECTION
 
             // loc_12149:
-            if (bInDemo || bPlayback)
+            if (TimeDemo_Active())
             {
-                while (tclocks > totalclock) { HandleAsync(); }
+                // don't wait for the real time to catch up with the demo.
                 tclocks = totalclock;
-            }
 
-            if (G_FPSLimit())
+                if (TimeDemo_ShouldRender())
+                {
+                    TimeDemo_FrameBegin();
+                    GameDisplay();
+                    TimeDemo_FrameEnd();
+                }
+            }
+            else
             {
-                GameDisplay();
+                if (bInDemo || bPlayback)
+                {
+                    while (tclocks > totalclock) { HandleAsync(); }
+                    tclocks = totalclock;
+                }
+
+                if (G_FPSLimit())
+                {
+                    GameDisplay();
+                }
             }
         }
         else
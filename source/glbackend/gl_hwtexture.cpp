@@ -40,6 +40,7 @@
 #include "c_dispatch.h"
 #include "printf.h"
 #include "gl_interface.h"
+#include "v_video.h"
 //#include "compat.h"
 
 // Workaround to avoid including the dirty 'compat.h' header. This will hopefully not be needed anymore once the texture format uses something better.
@@ -48,6 +49,8 @@
 
 uint64_t alltexturesize;
 
+static const uint8_t texelbytes[] = { 1, 4, 2, 1 };
+
 CCMD(alltexturesize)
 {
 	Printf("All textures are %llu bytes\n", alltexturesize);
@@ -63,7 +66,6 @@ CCMD(alltexturesize)
 unsigned int FHardwareTexture::CreateTexture(int w, int h, int type, bool mipmapped)
 {
 	static int gltypes[] = { GL_R8, GL_RGBA8, GL_RGB5_A1, GL_RGBA2 };
-	static uint8_t bytes[] = { 1, 4, 2, 1 };
 	glGenTextures(1, &glTexID);
 	glActiveTexture(GL_TEXTURE15);
 	glBindTexture(GL_TEXTURE_2D, glTexID);
@@ -84,7 +86,7 @@ unsigned int FHardwareTexture::CreateTexture(int w, int h, int type, bool mipmap
 			allocated += mip;
 		}
 	}
-	allocated *= bytes[type];
+	allocated *= texelbytes[type];
 	alltexturesize += allocated;
 
 	glTexStorage2D(GL_TEXTURE_2D, mipmapped? bits : 1, gltypes[type], w, h);
@@ -137,6 +139,85 @@ unsigned int FHardwareTexture::LoadTexturePart(const unsigned char* buffer, int
 	return glTexID;
 }
 
+//===========================================================================
+// 
+//	Creates a persistently mapped pixel buffer for textures that get
+//	replaced every frame. It is split into slices that are used in turn,
+//	so that the next frame can be filled in while the GPU is still
+//	copying the previous one into the texture.
+//
+//===========================================================================
+
+bool FHardwareTexture::CreateUploadBuffer()
+{
+	if (glBufferID != 0) return true;
+	if (glTexID == 0 || mipmapped || !(gl.flags & RFL_BUFFER_STORAGE)) return false;
+
+	// Keep every slice aligned so that the driver can use the fast path for all of them.
+	uploadSliceSize = (mWidth * mHeight * texelbytes[internalType] + 255) & ~255;
+	size_t size = uploadSliceSize * NumUploadSlices;
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+	glGenBuffers(1, &glBufferID);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, glBufferID);
+	glBufferStorage(GL_PIXEL_UNPACK_BUFFER, size, nullptr, flags);
+	uploadMap = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, flags);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	if (uploadMap == nullptr)
+	{
+		glDeleteBuffers(1, &glBufferID);
+		glBufferID = 0;
+		return false;
+	}
+	uploadSlice = 0;
+	return true;
+}
+
+//===========================================================================
+// 
+//	Returns the memory of the next slice once the GPU is done with it
+//
+//===========================================================================
+
+uint8_t *FHardwareTexture::MapUploadBuffer()
+{
+	if (uploadMap == nullptr) return nullptr;
+
+	auto fence = (GLsync)uploadFences[uploadSlice];
+	if (fence != nullptr)
+	{
+		// This slice was last used NumUploadSlices frames ago so normally this will not wait.
+		GLenum status;
+		do
+		{
+			status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		} while (status == GL_TIMEOUT_EXPIRED);
+		glDeleteSync(fence);
+		uploadFences[uploadSlice] = nullptr;
+	}
+	return uploadMap + uploadSlice * uploadSliceSize;
+}
+
+//===========================================================================
+// 
+//	Starts copying the slice returned by MapUploadBuffer into the texture
+//
+//===========================================================================
+
+unsigned int FHardwareTexture::LoadTextureFromUploadBuffer()
+{
+	if (uploadMap == nullptr) return 0;
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, glBufferID);
+	LoadTexturePart((const unsigned char*)(uploadSlice * uploadSliceSize), 0, 0, mWidth, mHeight);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	uploadFences[uploadSlice] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	uploadSlice = (uploadSlice + 1) % NumUploadSlices;
+	return glTexID;
+}
+
 //===========================================================================
 // 
 //	Destroys the texture
@@ -145,8 +226,12 @@ unsigned int FHardwareTexture::LoadTexturePart(const unsigned char* buffer, int
 FHardwareTexture::~FHardwareTexture() 
 { 
 	alltexturesize -= allocated;
+	for (auto fence : uploadFences)
+	{
+		if (fence != nullptr) glDeleteSync((GLsync)fence);
+	}
 	if (glTexID != 0) glDeleteTextures(1, &glTexID);
-	if (glBufferID != 0) glDeleteBuffers(1, &glBufferID);
+	if (glBufferID != 0) glDeleteBuffers(1, &glBufferID);	// this also unmaps the upload buffer
 }
 
 
@@ -15,12 +15,21 @@ public:
 		Brightmap,		// This can be stored as RGBA2 to save space, it also doesn't really need a mipmap.
 	};
 
+	enum
+	{
+		NumUploadSlices = 2,
+	};
+
 private:
 
 	int mSampler = 0;
 	unsigned int glTexID = 0;
 	unsigned int glDepthID = 0;	// only used by camera textures
-	unsigned int glBufferID = 0;
+	unsigned int glBufferID = 0;	// persistently mapped pixel buffer for streaming uploads
+	uint8_t *uploadMap = nullptr;
+	size_t uploadSliceSize = 0;
+	int uploadSlice = 0;
+	void *uploadFences[NumUploadSlices] = {};	// GLsync objects of the uploads still reading from each slice
 	int internalType = TrueColor;
 	bool mipmapped = true;
 	int mWidth = 0, mHeight = 0;
@@ -40,10 +49,15 @@ public:
 	unsigned int LoadTexture(const unsigned char * buffer);
 	unsigned int LoadTexturePart(const unsigned char* buffer, int x, int y, int w, int h);
 	unsigned int LoadTexture(FBitmap &bmp);
+	bool CreateUploadBuffer();
+	uint8_t *MapUploadBuffer();
+	unsigned int LoadTextureFromUploadBuffer();
 	unsigned int GetTextureHandle();
 	int GetSampler() { return mSampler; }
 	void SetSampler(int sampler) { mSampler = sampler;  }
 	bool isIndexed() const { return internalType == Indexed; }
+	int GetWidth() const { return mWidth; }
+	int GetHeight() const { return mHeight; }
 	void BindToFrameBuffer(int w, int h);
 
 	friend class FGameTexture;
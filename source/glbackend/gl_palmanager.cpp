@@ -83,6 +83,9 @@ void PaletteManager::DeleteAll()
 	DeleteAllTextures();
 	palettes.Reset();
 	palswaps.Reset();
+	palettecrcs.Clear();
+	palswapcrcs.Clear();
+	swappedpalmap.Clear();
 	lastindex = ~0u;
 	lastsindex = ~0u;
 	memset(palettemap, 0, sizeof(palettemap));
@@ -103,14 +106,12 @@ void PaletteManager::DeleteAll()
 unsigned PaletteManager::FindPalette(const uint8_t *paldata)
 {
 	auto crc32 = CalcCRC32(paldata, 1024);
-	for (unsigned int i = 0; i< palettes.Size(); i++)
+	auto &candidates = palettecrcs[crc32];
+	for (auto i : candidates)
 	{
-		if (crc32 == palettes[i].crc32)
+		if (!memcmp(paldata, palettes[i].colors, 1024))
 		{
-			if (!memcmp(paldata, palettes[i].colors, 1024))
-			{
-				return i;
-			}
+			return i;
 		}
 	}
 	PaletteData pd;
@@ -118,7 +119,9 @@ unsigned PaletteManager::FindPalette(const uint8_t *paldata)
 	pd.crc32 = crc32;
 	pd.paltexture = nullptr;
 	pd.shadesdone = false;
-	return palettes.Push(pd);
+	unsigned index = palettes.Push(pd);
+	candidates.Push(index);
+	return index;
 }
 
 //===========================================================================
@@ -130,22 +133,37 @@ unsigned PaletteManager::FindPalette(const uint8_t *paldata)
 unsigned PaletteManager::FindPalswap(const uint8_t* paldata, palette_t &fadecolor)
 {
 	if (paldata == nullptr) return 0;
-	auto crc32 = CalcCRC32(paldata, 256 * numshades);
-	for (unsigned int i = 0; i < palswaps.Size(); i++)
+	unsigned size = 256 * numshades;
+	auto crc32 = CalcCRC32(paldata, size);
+	auto &candidates = palswapcrcs[crc32];
+	for (auto i : candidates)
 	{
-		if (crc32 == palswaps[i].crc32)
+		if (palswaps[i].lookup.Size() == size && !memcmp(paldata, palswaps[i].lookup.Data(), size))
 		{
-			if (!memcmp(paldata, palswaps[i].lookup, 256 * numshades))
-			{
-				return i;
-			}
+			return i;
 		}
 	}
-	PalswapData pd;
-	pd.lookup = paldata;
+	unsigned index = palswaps.Reserve(1);
+	auto& pd = palswaps[index];
+	pd.lookup.Resize(size);
+	memcpy(pd.lookup.Data(), paldata, size);
 	pd.crc32 = crc32;
 	pd.swaptexture = nullptr;
-	memset(pd.brightcolors, 0, 256);
+	SetupPalswap(pd, fadecolor);
+	candidates.Push(index);
+	return index;
+}
+
+//===========================================================================
+//
+// Sets up the data that gets derived from the lookup table.
+//
+//===========================================================================
+
+void PaletteManager::SetupPalswap(PalswapData& pd, palette_t& fadecolor)
+{
+	const uint8_t* paldata = pd.lookup.Data();
+	memset(pd.brightcolors, 0, 255);
 	pd.isbright = false;
 
 	for (int i = 0; i < 255; i++)
@@ -190,8 +208,77 @@ unsigned PaletteManager::FindPalswap(const uint8_t* paldata, palette_t &fadecolo
 	{
 		pd.fadeColor = PalEntry(fadecolor.r, fadecolor.g, fadecolor.b);
 	}
+}
+
+//===========================================================================
+//
+// Changes the palswap of an index in place if no other index uses it,
+// so that only the shade rows that actually changed need to be uploaded.
+// Returns false if a new palswap needs to be looked up instead.
+//
+//===========================================================================
+
+bool PaletteManager::UpdatePalswap(int index, const uint8_t* paldata, palette_t& fadecolor)
+{
+	unsigned uindex = palswapmap[index];
+	if (uindex >= palswaps.Size()) return false;
+
+	auto& ps = palswaps[uindex];
+	unsigned size = 256 * numshades;
+	if (ps.lookup.Size() != size) return false;
+
+	auto crc32 = CalcCRC32(paldata, size);
+	if (crc32 == (uint32_t)ps.crc32 && !memcmp(paldata, ps.lookup.Data(), size)) return true;
+
+	for (int i = 0; i < 256; i++)
+	{
+		if (i != index && palswapmap[i] == uindex) return false;
+	}
+
+	// If the new data already exists, use that instead.
+	auto candidates = palswapcrcs.CheckKey(crc32);
+	if (candidates != nullptr)
+	{
+		for (auto i : *candidates)
+		{
+			if (palswaps[i].lookup.Size() == size && !memcmp(paldata, palswaps[i].lookup.Data(), size)) return false;
+		}
+	}
+
+	if (ps.swaptexture)
+	{
+		for (int row = 0; row < numshades;)
+		{
+			if (!memcmp(paldata + row * 256, &ps.lookup[row * 256], 256))
+			{
+				row++;
+				continue;
+			}
+			int first = row;
+			while (row < numshades && memcmp(paldata + row * 256, &ps.lookup[row * 256], 256)) row++;
+			ps.swaptexture->LoadTexturePart(paldata + first * 256, 0, first, 256, row - first);
+		}
+	}
+
+	auto& oldcandidates = palswapcrcs[ps.crc32];
+	oldcandidates.Delete(oldcandidates.Find(uindex));
+	palswapcrcs[crc32].Push(uindex);
+	ps.crc32 = crc32;
+	memcpy(ps.lookup.Data(), paldata, size);
+	SetupPalswap(ps, fadecolor);
+
+	// Palettes that were combined with the old data are no longer valid.
+	TArray<int> obsolete;
+	decltype(swappedpalmap)::Iterator it(swappedpalmap);
+	decltype(swappedpalmap)::Pair* pair;
+	while (it.NextPair(pair))
+	{
+		if ((pair->Key & 0xffff) == (int)uindex) obsolete.Push(pair->Key);
+	}
+	for (auto key : obsolete) swappedpalmap.Remove(key);
 
-	return palswaps.Push(pd);
+	if (lastsindex == uindex) lastsindex = ~0u;	// the fade color needs to be set again.
+	return true;
 }
 
 //===========================================================================
@@ -251,6 +338,7 @@ void PaletteManager::SetPalswapData(int index, const uint8_t* data, int numshade
 {
 	if (index < 0 || index > 255) return;	// invalid index - ignore.
 	numshades = numshades_;
+	if (data != nullptr && UpdatePalswap(index, data, fadecolor)) return;
 	palswapmap[index] = FindPalswap(data, fadecolor);
 }
 
@@ -273,7 +361,7 @@ void PaletteManager::BindPalswap(int index)
 			{
 				auto p = GLInterface.NewTexture();
 				p->CreateTexture(256, numshades, FHardwareTexture::Indexed, false);
-				p->LoadTexture((uint8_t*)ps.lookup);
+				p->LoadTexture(ps.lookup.Data());
 				p->SetSampler(SamplerNoFilterClampXY);
 				ps.swaptexture = p;
 			}
@@ -51,6 +51,7 @@ enum PRSFlags
 	STF_CLEARDEPTH = 2048,
 	STF_VIEWPORTSET = 4096,
 	STF_SCISSORSET = 8192,
+	STF_RENDERTARGET = 16384,
 
 
 };
@@ -73,6 +74,9 @@ struct FDepthBiasState
 struct PolymostRenderState
 {
 	int vindex, vcount, primtype;
+	const uint32_t *indices = nullptr;	// model frames: triangles relative to vindex, interpolated towards the frame at vindex2.
+	int vindex2;
+	float InterpolationFactor = 0.f;
     float Shade;
     float NumShades = 64.f;
 	float ShadeDiv = 62.f;
@@ -96,6 +100,8 @@ struct PolymostRenderState
 	short vp_x, vp_y, vp_w, vp_h;
 	short sc_x = SHRT_MIN, sc_y, sc_w, sc_h;
 	int texIds[6], samplerIds[6];
+	unsigned RenderTarget;	// texture handle for STF_RENDERTARGET, 0 returns to the previous framebuffer.
+	short rt_w, rt_h;
 
 	PalEntry FogColor;
 
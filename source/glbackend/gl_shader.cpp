@@ -68,6 +68,7 @@ bool FShader::Load(const char * name, const char * vert_prog, const char * frag_
 	glBindAttribLocation(hShader, 0, "i_vertPos");
 	glBindAttribLocation(hShader, 1, "i_texCoord");
 	glBindAttribLocation(hShader, 2, "i_color");
+	glBindAttribLocation(hShader, 3, "i_vertPos2");
 
 	glLinkProgram(hShader);
 
@@ -148,6 +149,7 @@ bool PolymostShader::Load(const char * name, const char * vert_prog, const char
 	TintModulate.Init(hShader, "u_tintModulate");
 	TintOverlay.Init(hShader, "u_tintOverlay");
 	TintFlags.Init(hShader, "u_tintFlags");
+	InterpolationFactor.Init(hShader, "u_interpolationFactor");
 
     RotMatrix.Init(hShader, "u_rotMatrix");
 	ModelMatrix.Init(hShader, "u_modelMatrix");
@@ -49,6 +49,7 @@ public:
 	FBufferedUniformPalEntry TintModulate;
 	FBufferedUniformPalEntry TintOverlay;
 	FBufferedUniform1i TintFlags;
+	FBufferedUniform1f InterpolationFactor;
 
 
 	FUniformMatrix4f   RotMatrix;
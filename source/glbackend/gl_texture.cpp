@@ -40,12 +40,17 @@
 #include "textures.h"
 #include "bitmap.h"
 #include "v_font.h"
+#include "image.h"
+#include "workerpool.h"
 #include "../../glbackend/glbackend.h"
 
 // Test CVARs.
 CVAR(Int, fixpalette, -1, 0)
 CVAR(Int, fixpalswap, -1, 0)
 
+CVARD(Int, r_precachethreads, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "number of threads used to decode hightile textures while precaching (0 = one per core)")
+static FWorkerPool precachepool;
+
 template<class T>
 void FlipNonSquareBlock(T* dst, const T* src, int x, int y, int srcpitch)
 {
@@ -96,7 +101,9 @@ FHardwareTexture* GLInstance::CreateTrueColorTexture(FTexture* tex, int palid, b
 {
 	auto palette = palid < 0? nullptr : palmanager.GetPaletteData(palid);
 	if (palid >= 0 && palette == nullptr) return nullptr;
-	auto texbuffer = tex->CreateTexBuffer(palette, checkfulltransparency? 0: CTF_ProcessData);
+	int flags = checkfulltransparency ? 0 : CTF_ProcessData;
+	if (palette == nullptr) flags |= CTF_UseCache;	// i.e. a hightile replacement
+	auto texbuffer = tex->CreateTexBuffer(palette, flags);
 	// Check if the texture is fully transparent. When creating a brightmap such textures can be discarded.
 	if (checkfulltransparency)
 	{
@@ -112,7 +119,11 @@ FHardwareTexture* GLInstance::CreateTrueColorTexture(FTexture* tex, int palid, b
 		}
 		if (!found) return nullptr;
 	}
+	return UploadTrueColorTexture(texbuffer, rgb8bit);
+}
 
+FHardwareTexture* GLInstance::UploadTrueColorTexture(const FTextureBuffer& texbuffer, bool rgb8bit)
+{
 	auto glpic = GLInterface.NewTexture();
 	if (!rgb8bit)
 		glpic->CreateTexture(texbuffer.mWidth, texbuffer.mHeight, FHardwareTexture::TrueColor, true);
@@ -122,6 +133,54 @@ FHardwareTexture* GLInstance::CreateTrueColorTexture(FTexture* tex, int palid, b
 	return glpic;
 }
 
+//===========================================================================
+// 
+//	Creates the hardware textures for a list of hightile replacements.
+//	Decoding the image files is done on the worker threads, the GL calls
+//	all happen on the main thread. The textures get the same hardware
+//	texture slot LoadTexture uses for TT_HICREPLACE.
+//
+//===========================================================================
+
+void GLInstance::PrecacheHightiles(const TArray<FTexture*>& textures, const std::function<void(int)>& progress)
+{
+	precachepool.SetNumThreads(I_GetWorkerThreadCount(r_precachethreads));
+
+	// Limit the amount of decoded data waiting for upload.
+	unsigned const batchsize = precachepool.NumThreads() * 4;
+	TArray<FTextureBuffer> buffers;
+
+	for (unsigned start = 0; start < textures.Size(); start += batchsize)
+	{
+		unsigned const count = std::min(batchsize, textures.Size() - start);
+
+		// The file system may only be accessed from the main thread.
+		for (unsigned i = 0; i < count; i++)
+		{
+			textures[start + i]->GetImage()->PreloadData();
+		}
+
+		buffers.Resize(count);
+		precachepool.Run(count, [&](int i)
+		{
+			buffers[i] = textures[start + i]->CreateTexBuffer(nullptr, CTF_ProcessData | CTF_UseCache);
+		});
+
+		for (unsigned i = 0; i < count; i++)
+		{
+			auto tex = textures[start + i];
+			tex->GetImage()->ReleasePreloadedData();
+			if (buffers[i].mBuffer && !tex->GetHardwareTexture(0))
+			{
+				tex->SetHardwareTexture(0, UploadTrueColorTexture(buffers[i], false));
+			}
+		}
+		buffers.Clear();
+
+		if (progress) progress(start + count);
+	}
+}
+
 //===========================================================================
 // 
 //	Retrieve the texture to be used.
@@ -167,6 +226,23 @@ bool GLInstance::SetTextureInternal(int picnum, FTexture* tex, int palette, int
 
 	GLInterface.SetBasepalTint(0xffffff);
 
+	// A camera tile rendered by the hardware renderer. Its pixel data is not up to date so the rendered texture is all there is.
+	auto prtex = tex->GetHardwareTexture(RENDERTARGET_PALID);
+	if (prtex)
+	{
+		TextureType = TT_TRUECOLOR;
+		GLInterface.SetTinting(-1, 0xffffff, 0xffffff);
+		UseDetailMapping(false);
+		UseGlowMapping(false);
+		UseBrightmaps(false);
+		BindTexture(0, *prtex, (method & DAMETH_CLAMPED) ? (sampleroverride != -1 ? sampleroverride : SamplerClampXY) : SamplerRepeat);
+		UnbindTexture(3);
+		UnbindTexture(4);
+		UnbindTexture(5);
+		GLInterface.SetAlphaThreshold(0.5f);
+		return true;
+	}
+
 	auto& h = hictinting[palette];
 	bool applytint = false;
 	auto rep = (hw_hightile && !(h.f & HICTINT_ALWAYSUSEART)) ? tex->FindReplacement(palette) : nullptr;
@@ -52,6 +52,8 @@
 
 float shadediv[MAXPALOOKUPS];
 
+CVARD(Bool, hw_batchdraws, true, 0, "merge consecutive draw calls with identical render state")
+
 static int blendstyles[] = { GL_ZERO, GL_ONE, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_COLOR, GL_ONE_MINUS_SRC_COLOR, GL_DST_COLOR, GL_ONE_MINUS_DST_COLOR, GL_DST_ALPHA, GL_ONE_MINUS_DST_ALPHA };
 static int renderops[] = { GL_FUNC_ADD, GL_FUNC_ADD, GL_FUNC_SUBTRACT, GL_FUNC_REVERSE_SUBTRACT };
 int depthf[] = { GL_ALWAYS, GL_LESS, GL_EQUAL, GL_LEQUAL };
@@ -184,6 +186,9 @@ void GLInstance::Deinit()
 	activeShader = nullptr;
 	palmanager.DeleteAllTextures();
 	lastPalswapIndex = -1;
+	DeleteRenderTarget();
+	if (copyFB != 0) glDeleteFramebuffers(1, &copyFB);
+	copyFB = 0;
 }
 
 FHardwareTexture* GLInstance::NewTexture()
@@ -235,7 +240,26 @@ void GLInstance::Draw(EDrawType type, size_t start, size_t count)
 	rendercommands.Push(renderState);
 	SetIdentityMatrix(Matrix_Texture);
 	SetIdentityMatrix(Matrix_Detail);
-	renderState.StateFlags &= ~(STF_CLEARCOLOR | STF_CLEARDEPTH | STF_VIEWPORTSET | STF_SCISSORSET);
+	renderState.StateFlags &= ~(STF_CLEARCOLOR | STF_CLEARDEPTH | STF_VIEWPORTSET | STF_SCISSORSET | STF_RENDERTARGET);
+}
+
+//===========================================================================
+//
+// Draws a model whose frames are stored in the static part of the vertex
+// buffer. The indices are relative to the frame start and get copied into
+// the index buffer when the command is executed, the vertex shader blends
+// the two frames.
+//
+//===========================================================================
+
+void GLInstance::DrawModelFrames(size_t frame1, size_t frame2, float interpolation, const uint32_t* indices, size_t count)
+{
+	renderState.indices = indices;
+	renderState.vindex2 = frame2;
+	renderState.InterpolationFactor = interpolation;
+	Draw(DT_TRIANGLES, frame1, count);
+	renderState.indices = nullptr;
+	renderState.InterpolationFactor = 0.f;
 }
 
 void GLInstance::DrawElement(EDrawType type, size_t start, size_t count, PolymostRenderState &renderState)
@@ -256,19 +280,155 @@ void GLInstance::DrawElement(EDrawType type, size_t start, size_t count, Polymos
 	}
 }
 
+//===========================================================================
+//
+// Checks if two render commands can be drawn with a single draw call.
+// Everything that goes into PolymostRenderState::Apply must be identical,
+// only the vertex range may differ.
+//
+//===========================================================================
+
+static bool MatricesMatch(int index1, int index2)
+{
+	if (index1 == index2) return true;
+	if (index1 < 0 || index2 < 0) return false;
+	return !memcmp(matrixArray[index1].get(), matrixArray[index2].get(), 16 * sizeof(float));
+}
+
+static bool CanBatch(const PolymostRenderState& rs1, const PolymostRenderState& rs2)
+{
+	auto canconvert = [](int primtype) { return primtype == DT_TRIANGLES || primtype == DT_TRIANGLE_FAN; };
+
+	if (!canconvert(rs1.primtype) || !canconvert(rs2.primtype)) return false;
+	if (rs1.indices || rs2.indices) return false;
+
+	// State that gets applied only once must not be part of a merged command.
+	if (rs2.StateFlags & (STF_CLEARCOLOR | STF_CLEARDEPTH | STF_VIEWPORTSET | STF_SCISSORSET | STF_RENDERTARGET)) return false;
+	if (rs2.mBias.mChanged) return false;
+
+	if (rs1.StateFlags != rs2.StateFlags || rs1.Flags != rs2.Flags || rs1.Style != rs2.Style || rs1.DepthFunc != rs2.DepthFunc) return false;
+	if (memcmp(rs1.texIds, rs2.texIds, sizeof(rs1.texIds)) || memcmp(rs1.samplerIds, rs2.samplerIds, sizeof(rs1.samplerIds))) return false;
+	if (memcmp(rs1.Color, rs2.Color, sizeof(rs1.Color))) return false;
+	if (rs1.Shade != rs2.Shade || rs1.NumShades != rs2.NumShades || rs1.ShadeDiv != rs2.ShadeDiv || rs1.VisFactor != rs2.VisFactor) return false;
+	if (rs1.NPOTEmulationFactor != rs2.NPOTEmulationFactor || rs1.NPOTEmulationXOffset != rs2.NPOTEmulationXOffset) return false;
+	if (rs1.Brightness != rs2.Brightness || rs1.AlphaTest != rs2.AlphaTest || (rs1.AlphaTest && rs1.AlphaThreshold != rs2.AlphaThreshold)) return false;
+	if (rs1.FogColor != rs2.FogColor || rs1.fullscreenTint != rs2.fullscreenTint) return false;
+	if (rs1.hictint != rs2.hictint || rs1.hictint_overlay != rs2.hictint_overlay || rs1.hictint_flags != rs2.hictint_flags) return false;
+	if (rs1.mBias.mFactor != rs2.mBias.mFactor || rs1.mBias.mUnits != rs2.mBias.mUnits) return false;
+
+	for (int i = 0; i < NUMMATRICES; i++)
+	{
+		if (!MatricesMatch(rs1.matrixIndex[i], rs2.matrixIndex[i])) return false;
+	}
+	return true;
+}
+
+//===========================================================================
+//
+// Consecutive triangle fans and lists sharing the same state are converted
+// to a single indexed triangle list. Commands are never reordered because
+// polymost relies on the submission order for translucency and depth.
+//
+//===========================================================================
+
 void GLInstance::DoDraw()
 {
-	for (auto& rs : rendercommands)
+	struct DrawRun
 	{
-		glVertexAttrib4fv(2, rs.Color);
+		unsigned command;
+		unsigned indexstart, indexcount;	// indexcount == 0 means the command gets drawn directly.
+	};
+
+	TArray<DrawRun> runs;
+	batchIndices.Clear();
+
+	for (unsigned i = 0; i < rendercommands.Size(); i++)
+	{
+		auto& rs = rendercommands[i];
 		if (rs.Color[3] != 1.f) rs.Flags &= ~RF_Brightmapping;	// The way the colormaps are set up means that brightmaps cannot be used on translucent content at all.
+
+		if (rs.indices)
+		{
+			unsigned start = batchIndices.Reserve(rs.vcount);
+			memcpy(&batchIndices[start], rs.indices, rs.vcount * sizeof(uint32_t));
+			runs.Push({ i, start, (unsigned)rs.vcount });
+		}
+		else if (hw_batchdraws && runs.Size() > 0 && CanBatch(rendercommands[runs.Last().command], rs))
+		{
+			auto& run = runs.Last();
+			if (run.indexcount == 0)
+			{
+				// Convert the command that started the run.
+				run.indexstart = batchIndices.Size();
+				AddBatchIndices(rendercommands[run.command]);
+			}
+			AddBatchIndices(rs);
+			run.indexcount = batchIndices.Size() - run.indexstart;
+		}
+		else
+		{
+			runs.Push({ i, 0, 0 });
+		}
+	}
+
+	auto vertexbuffer = screen->mVertexData->GetBufferObjects().first;
+	auto indexbuffer = screen->mVertexData->GetBufferObjects().second;
+	if (batchIndices.Size() > 0)
+	{
+		SetIndexBuffer(indexbuffer);
+		indexbuffer->SetData(batchIndices.Size() * sizeof(uint32_t), batchIndices.Data(), false);
+	}
+
+	for (auto& run : runs)
+	{
+		auto& rs = rendercommands[run.command];
+		glVertexAttrib4fv(2, rs.Color);
 		rs.Apply(polymostShader, lastState);
-		glDrawArrays(primtypes[rs.primtype], rs.vindex, rs.vcount);
+		if (run.indexcount == 0)
+		{
+			glDrawArrays(primtypes[rs.primtype], rs.vindex, rs.vcount);
+		}
+		else if (rs.indices)
+		{
+			// The frames are selected by offsetting the two vertex attribute bindings.
+			SetVertexBuffer(vertexbuffer, rs.vindex, rs.vindex2);
+			glDrawElements(GL_TRIANGLES, run.indexcount, GL_UNSIGNED_INT, (void*)(intptr_t)(run.indexstart * sizeof(uint32_t)));
+			SetVertexBuffer(vertexbuffer, 0, 0);
+		}
+		else
+		{
+			glDrawElements(GL_TRIANGLES, run.indexcount, GL_UNSIGNED_INT, (void*)(intptr_t)(run.indexstart * sizeof(uint32_t)));
+		}
+	}
+
+	if (batchIndices.Size() > 0)
+	{
+		SetIndexBuffer(nullptr);
 	}
 	rendercommands.Clear();
 	matrixArray.Resize(1);
 }
 
+void GLInstance::AddBatchIndices(const PolymostRenderState& rs)
+{
+	if (rs.primtype == DT_TRIANGLE_FAN)
+	{
+		for (int i = 2; i < rs.vcount; i++)
+		{
+			batchIndices.Push(rs.vindex);
+			batchIndices.Push(rs.vindex + i - 1);
+			batchIndices.Push(rs.vindex + i);
+		}
+	}
+	else
+	{
+		for (int i = 0; i < rs.vcount; i++)
+		{
+			batchIndices.Push(rs.vindex + i);
+		}
+	}
+}
+
 
 int GLInstance::SetMatrix(int num, const VSMatrix *mat)
 {
@@ -284,6 +444,120 @@ void GLInstance::ReadPixels(int xdim, int ydim, uint8_t* buffer)
 	glReadPixels(0, 0, xdim, ydim, GL_RGB, GL_UNSIGNED_BYTE, buffer);
 }
 
+//===========================================================================
+//
+// Returns the texture a camera tile gets rendered into by the hardware
+// renderer. As long as it exists it replaces the tile's pixel data.
+//
+//===========================================================================
+
+FHardwareTexture* GLInstance::GetRenderTarget(FTexture* tex)
+{
+	auto phwtex = tex->GetHardwareTexture(RENDERTARGET_PALID);
+	if (phwtex)
+	{
+		if ((*phwtex)->GetWidth() == tex->GetWidth() && (*phwtex)->GetHeight() == tex->GetHeight()) return *phwtex;
+		delete *phwtex;
+	}
+	auto hwtex = NewTexture();
+	hwtex->CreateTexture(tex->GetWidth(), tex->GetHeight(), FHardwareTexture::TrueColor, false);
+	tex->SetHardwareTexture(RENDERTARGET_PALID, hwtex);
+	return hwtex;
+}
+
+//===========================================================================
+//
+// Redirects all following render commands into the given texture, or back
+// to the screen if it is null. This is queued like any other state change
+// so it takes effect in the correct place when the scene gets drawn.
+//
+//===========================================================================
+
+void GLInstance::SetRenderTarget(FHardwareTexture* tex)
+{
+	if (tex)
+	{
+		memcpy(savedViewport, &renderState.vp_x, sizeof(savedViewport));
+		memcpy(savedScissor, &renderState.sc_x, sizeof(savedScissor));
+		renderState.RenderTarget = tex->GetTextureHandle();
+		renderState.rt_w = (short)tex->GetWidth();
+		renderState.rt_h = (short)tex->GetHeight();
+		SetViewport(0, 0, tex->GetWidth(), tex->GetHeight());
+		DisableScissor();
+		ClearScreen(0, true);
+	}
+	else
+	{
+		renderState.RenderTarget = 0;
+		SetViewport(savedViewport[0], savedViewport[1], savedViewport[2], savedViewport[3]);
+		memcpy(&renderState.sc_x, savedScissor, sizeof(savedScissor));
+		renderState.StateFlags |= STF_SCISSORSET;
+	}
+	renderState.StateFlags |= STF_RENDERTARGET;
+	// Queue an empty draw so that the switch happens even if nothing gets rendered into the texture.
+	Draw(DT_TRIANGLES, 0, 0);
+}
+
+//===========================================================================
+//
+// Executes a queued render target switch. When returning to the screen
+// the scratch framebuffer gets copied into the texture upside down because
+// tile textures are stored top to bottom.
+//
+//===========================================================================
+
+void GLInstance::BindRenderTarget(unsigned int texid, int width, int height)
+{
+	if (texid != 0)
+	{
+		if (activeTarget == 0) glGetIntegerv(GL_FRAMEBUFFER_BINDING, &screenFB);
+
+		if (targetFB == 0 || width != targetWidth || height != targetHeight)
+		{
+			DeleteRenderTarget();
+			// No alpha channel so that the copy in the texture is fully opaque, regardless of how translucent geometry got blended.
+			glGenRenderbuffers(1, &targetColor);
+			glBindRenderbuffer(GL_RENDERBUFFER, targetColor);
+			glRenderbufferStorage(GL_RENDERBUFFER, GL_RGB8, width, height);
+			glGenRenderbuffers(1, &targetDepth);
+			glBindRenderbuffer(GL_RENDERBUFFER, targetDepth);
+			glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+			glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+			glGenFramebuffers(1, &targetFB);
+			glBindFramebuffer(GL_FRAMEBUFFER, targetFB);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, targetColor);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, targetDepth);
+			targetWidth = width;
+			targetHeight = height;
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, targetFB);
+		activeTarget = texid;
+		// The queued clear comes before the scissor state gets updated.
+		glDisable(GL_SCISSOR_TEST);
+	}
+	else if (activeTarget != 0)
+	{
+		if (copyFB == 0) glGenFramebuffers(1, &copyFB);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, copyFB);
+		glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, activeTarget, 0);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, targetFB);
+		glBlitFramebuffer(0, 0, targetWidth, targetHeight, 0, targetHeight, targetWidth, 0, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+		glBindFramebuffer(GL_FRAMEBUFFER, screenFB);
+		activeTarget = 0;
+	}
+}
+
+void GLInstance::DeleteRenderTarget()
+{
+	if (targetFB != 0) glDeleteFramebuffers(1, &targetFB);
+	if (targetColor != 0) glDeleteRenderbuffers(1, &targetColor);
+	if (targetDepth != 0) glDeleteRenderbuffers(1, &targetDepth);
+	targetFB = targetColor = targetDepth = 0;
+	targetWidth = targetHeight = 0;
+}
+
 void GLInstance::SetPolymostShader()
 {
 	if (activeShader != polymostShader)
@@ -406,6 +680,10 @@ void PolymostRenderState::Apply(PolymostShader* shader, GLState &oldState)
 		{
 			glPolygonMode(GL_FRONT_AND_BACK, (StateFlags & STF_WIREFRAME) ? GL_LINE : GL_FILL);
 		}
+		if (StateFlags & STF_RENDERTARGET)
+		{
+			GLInterface.BindRenderTarget(RenderTarget, rt_w, rt_h);
+		}
 		if (StateFlags & (STF_CLEARCOLOR| STF_CLEARDEPTH))
 		{
 			glClearColor(ClearColor.r / 255.f, ClearColor.g / 255.f, ClearColor.b / 255.f, 1.f);
@@ -442,7 +720,7 @@ void PolymostRenderState::Apply(PolymostShader* shader, GLState &oldState)
 			mBias.mChanged = false;
 		}
 
-		StateFlags &= ~(STF_CLEARCOLOR | STF_CLEARDEPTH | STF_VIEWPORTSET | STF_SCISSORSET);
+		StateFlags &= ~(STF_CLEARCOLOR | STF_CLEARDEPTH | STF_VIEWPORTSET | STF_SCISSORSET | STF_RENDERTARGET);
 		oldState.Flags = StateFlags;
 	}
 	if (Style != oldState.Style)
@@ -474,6 +752,7 @@ void PolymostRenderState::Apply(PolymostShader* shader, GLState &oldState)
 	shader->TintModulate.Set(hictint);
 	shader->TintOverlay.Set(hictint_overlay);
 	shader->FullscreenTint.Set(fullscreenTint);
+	shader->InterpolationFactor.Set(InterpolationFactor);
 	if (matrixIndex[Matrix_View] != -1)
 		shader->RotMatrix.Set(matrixArray[matrixIndex[Matrix_View]].get());
 	if (matrixIndex[Matrix_Projection] != -1)
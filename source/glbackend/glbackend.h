@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <vector>
 #include <map>
+#include <functional>
 #include "gl_samplers.h"
 #include "gl_hwtexture.h"
 #include "gl_renderstate.h"
@@ -15,6 +16,7 @@ class FShader;
 class PolymostShader;
 class SurfaceShader;
 class FTexture;
+struct FTextureBuffer;
 class GLInstance;
 class F2DDrawer;
 struct palette_t;
@@ -39,7 +41,7 @@ struct PalswapData
 {
 	int32_t crc32;
 	bool isbright;
-	const uint8_t *lookup;	// points to the original data. This is static so no need to copy
+	TArray<uint8_t> lookup;	// a copy, because some games modify their shade tables after passing them in.
 	FHardwareTexture* swaptexture;
 	PalEntry fadeColor;
 	uint8_t brightcolors[255];
@@ -47,7 +49,8 @@ struct PalswapData
 
 enum
 {
-	PALSWAP_TEXTURE_SIZE = 2048
+	PALSWAP_TEXTURE_SIZE = 2048,
+	RENDERTARGET_PALID = -2,	// key of a tile's camera texture in its hardware texture list.
 };
 
 class PaletteManager
@@ -65,12 +68,16 @@ class PaletteManager
 	TArray<PaletteData> palettes;
 	TArray<PalswapData> palswaps;
 	TMap<int, int> swappedpalmap;
+	TMap<uint32_t, TArray<unsigned>> palettecrcs;	// entries with the same crc, for finding duplicates
+	TMap<uint32_t, TArray<unsigned>> palswapcrcs;
 	FHardwareTexture* palswapTexture = nullptr;
 	GLInstance* const inst;
 
 	//OpenGLRenderer::GLDataBuffer* palswapBuffer = nullptr;
 
 	unsigned FindPalswap(const uint8_t* paldata, palette_t& fadecolor);
+	bool UpdatePalswap(int index, const uint8_t* paldata, palette_t& fadecolor);
+	void SetupPalswap(PalswapData& pd, palette_t& fadecolor);
 
 public:
 	PaletteManager(GLInstance *inst_) : inst(inst_)
@@ -153,6 +160,7 @@ struct GLState
 class GLInstance
 {
 	TArray<PolymostRenderState> rendercommands;
+	TArray<uint32_t> batchIndices;
 	int maxTextureSize;
 	PaletteManager palmanager;
 	int lastPalswapIndex = -1;
@@ -166,6 +174,14 @@ class GLInstance
 
 	float mProjectionM5 = 1.0f; // needed by ssao
 	PolymostRenderState renderState;
+
+	// Camera textures are rendered into a scratch framebuffer and then copied into the tile's texture.
+	unsigned int targetFB = 0, targetColor = 0, targetDepth = 0, copyFB = 0;
+	int targetWidth = 0, targetHeight = 0;
+	int screenFB = 0;
+	unsigned int activeTarget = 0;
+	short savedViewport[4];
+	short savedScissor[4];
 	FShader* activeShader;
 	PolymostShader* polymostShader;
 	SurfaceShader* surfaceShader;
@@ -194,6 +210,8 @@ public:
 	GLInstance();
 	void Draw(EDrawType type, size_t start, size_t count);
 	void DoDraw();
+	void DrawModelFrames(size_t frame1, size_t frame2, float interpolation, const uint32_t* indices, size_t count);
+	void AddBatchIndices(const PolymostRenderState& rs);
 	void DrawElement(EDrawType type, size_t start, size_t count, PolymostRenderState& renderState);
 
 	FHardwareTexture* NewTexture();
@@ -225,6 +243,11 @@ public:
 	
 	void ReadPixels(int w, int h, uint8_t* buffer);
 
+	FHardwareTexture* GetRenderTarget(FTexture* tex);
+	void SetRenderTarget(FHardwareTexture* tex);
+	void BindRenderTarget(unsigned int texid, int width, int height);
+	void DeleteRenderTarget();
+
 	void SetDepthBias(float a, float b)
 	{
 		renderState.mBias.mFactor = a;
@@ -522,6 +545,8 @@ public:
 
 	FHardwareTexture* CreateIndexedTexture(FTexture* tex);
 	FHardwareTexture* CreateTrueColorTexture(FTexture* tex, int palid, bool checkfulltransparency = false, bool rgb8bit = false);
+	FHardwareTexture* UploadTrueColorTexture(const FTextureBuffer& texbuffer, bool rgb8bit);
+	void PrecacheHightiles(const TArray<FTexture*>& textures, const std::function<void(int)>& progress);
 	FHardwareTexture *LoadTexture(FTexture* tex, int texturetype, int palid);
 	bool SetTextureInternal(int globalpicnum, FTexture* tex, int palette, int method, int sampleroverride,  FTexture *det, float detscale, FTexture *glow);
 
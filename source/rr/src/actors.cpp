@@ -25,6 +25,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #define actors_c_
 
 #include "duke3d.h"
+#include "tracing.h"
 
 BEGIN_RR_NS
 
@@ -9689,6 +9690,7 @@ void G_RefreshLights(void)
 
 void G_MoveWorld(void)
 {
+    TRACE_ZONE("G_MoveWorld");
     extern double g_moveActorsTime, g_moveWorldTime;
     const double worldTime = timerGetHiTicks();
 
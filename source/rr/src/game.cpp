@@ -48,6 +48,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "c_dispatch.h"
 #include "mapinfo.h"
 #include "rendering/v_video.h"
+#include "tracing.h"
 
 // Uncomment to prevent anything except mirrors from drawing. It is sensible to
 // also uncomment ENGINE_CLEAR_SCREEN in build/src/engine_priv.h.
@@ -7369,6 +7370,7 @@ MAIN_LOOP_RESTART:
 
     do //main loop
     {
+        TRACE_ZONE("Frame");
 		handleevents();
 		if (g_player[myconnectindex].ps->gm == MODE_DEMO)
 		{
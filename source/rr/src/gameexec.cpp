@@ -33,6 +33,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "savegame.h"
 #include "gamecvars.h"
 #include "version.h"
+#include "tracing.h"
 
 #include "debugbreak.h"
 
@@ -166,6 +167,7 @@ static FORCE_INLINE int32_t VM_EventInlineInternal__(int const eventNum, int con
     insptr = apScript + apScriptEvents[eventNum];
     globalReturn = returnValue;
 
+    TRACE_ZONE("VM_ExecuteEvent");
     double const t = timerGetHiTicks();
 
     if ((unsigned)spriteNum >= MAXSPRITES)
@@ -663,6 +663,10 @@ void G_CacheMapData(void)
 #endif
     }
 
+#ifdef USE_OPENGL
+    FinishHardwareTexturePrecache([](int, int) { G_HandleAsync(); });
+#endif
+
     Bmemset(gotpic, 0, sizeof(gotpic));
 
     endtime = timerGetTicks();
@@ -505,7 +505,7 @@ static void G_SetupCamTile(int spriteNum, int tileNum, int smoothRatio)
     vec3_t const camera     = G_GetCameraPosition(spriteNum, smoothRatio);
     int const    saveMirror = display_mirror;
 
-    renderSetTarget(tileNum, tilesiz[tileNum].y, tilesiz[tileNum].x);
+    bool const hwTarget = renderSetCameraTarget(tileNum, tilesiz[tileNum].y, tilesiz[tileNum].x);
     screen->BeginScene();
 
     yax_preparedrawrooms();
@@ -519,8 +519,12 @@ static void G_SetupCamTile(int spriteNum, int tileNum, int smoothRatio)
     screen->FinishScene();
 
     renderRestoreTarget();
-    squarerotatetile(tileNum);
-    tileInvalidate(tileNum, -1, 255);
+
+    if (!hwTarget)
+    {
+        squarerotatetile(tileNum);
+        tileInvalidate(tileNum, -1, 255);
+    }
 }
 
 void G_AnimateCamSprite(int smoothRatio)
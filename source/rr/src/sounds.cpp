@@ -27,6 +27,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "z_music.h"
 #include "mapinfo.h"
 #include "sound/s_soundinternal.h"
+#include "tracing.h"
 
 BEGIN_RR_NS
 
@@ -310,6 +311,7 @@ void DukeSoundEngine::CalcPosVel(int type, const void* source, const float pt[3]
 
 void S_Update(void)
 {
+    TRACE_ZONE("S_Update");
     SoundListener listener;
     vec3_t* c;
     int32_t ca, cs;
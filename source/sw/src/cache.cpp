@@ -652,6 +652,15 @@ void DoTheCache(void)
         }
     }
 
+#ifdef USE_OPENGL
+    FinishHardwareTexturePrecache([](int, int)
+    {
+        AnimateCacheCursor();
+        handleevents();
+        getpackets();
+    });
+#endif
+
     memset(gotpic,0,sizeof(gotpic));
     strcpy(CacheLastLevel, LevelName);
 }
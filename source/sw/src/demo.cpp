@@ -38,6 +38,7 @@ Prepared for public release: 03/28/2005 - Charlie Wiederhold, 3D Realms
 
 #include "mytypes.h"
 #include "gamecontrol.h"
+#include "timedemo.h"
 #include "demo.h"
 
 #include "player.h"
@@ -53,7 +54,7 @@ SWBOOL DemoEdit = FALSE;
 SWBOOL DemoMode = FALSE;
 SWBOOL DemoModeMenuState = FALSE;
 SWBOOL DemoOverride = FALSE;
-char DemoFileName[16] = "demo.dmo";
+char DemoFileName[BMAX_PATH] = "demo.dmo";
 char DemoLevelName[16] = "";
 extern SWBOOL NewGame;
 
@@ -297,7 +298,7 @@ DemoBackupBuffer(void)
     FILE *OldDemoFile = DemoFileIn;
     int pos,i;
     char copy_buffer;
-    char NewDemoFileName[16] = "!";
+    char NewDemoFileName[BMAX_PATH + 1] = "!";
 
     // seek backwards to beginning of last buffer
     fseek(OldDemoFile, -sizeof(DemoBuffer), SEEK_CUR);
@@ -405,6 +406,10 @@ DemoPlayBack(void)
 
     while (TRUE)
     {
+        // timedemos run exactly one tick per frame, regardless of the real time that has passed
+        if (TimeDemo_Active())
+            totalclock = totalsynctics + 1;
+
         // makes code run at the same rate
         while (totalclock > totalsynctics)
         {
@@ -437,7 +442,9 @@ DemoPlayBack(void)
 
             CONTROL_GetInput(&info);
 
+            TimeDemo_TickBegin();
             domovethings();
+            TimeDemo_TickEnd();
 
             // fast forward and slow mo
             if (DemoEdit)
@@ -511,7 +518,14 @@ DemoPlayBack(void)
 
         // demo is over
         if (DemoDone)
+        {
+            if (TimeDemo_Active())
+            {
+                TimeDemo_Report(DemoFileName);
+                QuitFlag = TRUE;
+            }
             break;
+        }
 
         if (QuitFlag)
         {
@@ -531,7 +545,17 @@ DemoPlayBack(void)
             break;
         }
 
-        drawscreen(Player + screenpeek);
+        if (TimeDemo_Active())
+        {
+            if (TimeDemo_ShouldRender())
+            {
+                TimeDemo_FrameBegin();
+                drawscreen(Player + screenpeek);
+                TimeDemo_FrameEnd();
+            }
+        }
+        else
+            drawscreen(Player + screenpeek);
     }
 
     // only exit if conditions are write
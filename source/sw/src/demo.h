@@ -31,7 +31,7 @@ extern SWBOOL DemoRecording;
 extern SWBOOL DemoEdit;
 extern SWBOOL DemoMode;
 extern SWBOOL DemoOverride;
-extern char DemoFileName[16];
+extern char DemoFileName[BMAX_PATH];
 extern char DemoLevelName[16];
 
 extern FILE *DemoSyncFile;
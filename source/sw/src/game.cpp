@@ -68,6 +68,7 @@ Things required to make savegames work:
 #include "menus.h"
 
 #include "gamecontrol.h"
+#include "timedemo.h"
 #include "gamedefs.h"
 #include "config.h"
 
@@ -996,10 +997,17 @@ InitLevel(void)
         Level = 0;
         NewGame = TRUE;
         DemoInitOnce = FALSE;
-        strcpy(DemoFileName, DemoName[DemoNumber]);
-        DemoNumber++;
-        if (!DemoName[DemoNumber][0])
-            DemoNumber = 0;
+        if (TimeDemo_Active())
+        {
+            snprintf(DemoFileName, sizeof(DemoFileName), "%s", userConfig.CommandDemo.GetChars());
+        }
+        else
+        {
+            strcpy(DemoFileName, DemoName[DemoNumber]);
+            DemoNumber++;
+            if (!DemoName[DemoNumber][0])
+                DemoNumber = 0;
+        }
 
         // read header and such
         DemoPlaySetup();
@@ -2374,6 +2382,11 @@ void Control()
     MONO_PRINT("InitGame done");
     //MNU_InitMenus();
     InGame = TRUE;
+    if (TimeDemo_Active())
+    {
+        DemoMode = TRUE;
+        DemoPlaying = TRUE;
+    }
     GameIntro();
 
     while (!QuitFlag)
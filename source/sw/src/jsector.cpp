@@ -466,7 +466,7 @@ void drawroomstotile(int daposx, int daposy, int daposz,
 {
 	TileFiles.tileCreate(tilenume, tilesiz[tilenume].x, tilesiz[tilenume].y);
 
-    renderSetTarget(tilenume, tilesiz[tilenume].x, tilesiz[tilenume].y);
+    bool const hwtarget = renderSetCameraTarget(tilenume, tilesiz[tilenume].x, tilesiz[tilenume].y);
     screen->BeginScene();
 
     drawrooms(daposx, daposy, daposz, daang, dahoriz, dacursectnum);
@@ -476,9 +476,11 @@ void drawroomstotile(int daposx, int daposy, int daposz,
 
     renderRestoreTarget();
 
-    squarerotatetile(tilenume);
-
-    tileInvalidate(tilenume, -1, -1);
+    if (!hwtarget)
+    {
+        squarerotatetile(tilenume);
+        tileInvalidate(tilenume, -1, -1);
+    }
 }
 
 void
@@ -489,6 +489,9 @@ int DoSlidorMoveWalls(short SpriteNum, int amt)
     }
     while (w != startwall);
 
+    // white walls are moved directly
+    sectorGridInvalidate(sprite[SpriteNum].sectnum);
+
     return 0;
 }
 
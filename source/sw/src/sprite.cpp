@@ -1669,6 +1669,7 @@ void PreMapCombineFloors(void)
 
             startwall = sector[dasect].wallptr;
             endwall = startwall + sector[dasect].wallnum;
+            sectorGridInvalidate(dasect);
             for (j=startwall; j<endwall; j++)
             {
                 wall[j].x += dx;
@@ -1721,6 +1721,7 @@ MovePoints(SECTOR_OBJECTp sop, short delta_ang, int nx, int ny)
 
         startwall = (*sectp)->wallptr;
         endwall = startwall + (*sectp)->wallnum - 1;
+        sectorGridInvalidate(int(*sectp - sector));
 
         // move all walls in sectors
         for (wp = &wall[startwall], k = startwall; k <= endwall; wp++, k++)
@@ -1954,6 +1955,7 @@ void RefreshPoints(SECTOR_OBJECTp sop, int nx, int ny, SWBOOL dynamic)
         {
             startwall = (*sectp)->wallptr;
             endwall = startwall + (*sectp)->wallnum - 1;
+            sectorGridInvalidate(int(*sectp - sector));
 
             // move all walls in sectors back to the original position
             for (wp = &wall[startwall], k = startwall; k <= endwall; wp++, k++)
@@ -2144,6 +2146,7 @@ CollapseSectorObject(SECTOR_OBJECTp sop, int nx, int ny)
         {
             startwall = (*sectp)->wallptr;
             endwall = startwall + (*sectp)->wallnum - 1;
+            sectorGridInvalidate(int(*sectp - sector));
 
             // move all walls in sectors back to the original position
             for (wp = &wall[startwall], k = startwall; k <= endwall; wp++, k++)